@@ -7,10 +7,16 @@ C01Lighting::C01Lighting()
     MainCamera->setMoveSensitivity( 0.005f );
 
     const std::string shader_directory_path = std::string( CMAKE_SOURCE_DIR ) + "/01_lighting/shaders";
+    ObjectShader->addDefine( "MAX_LIGHTS", LightGL::MaxLightNum );
     ObjectShader->setShader(
         std::string( shader_directory_path + "/scene_shader.vert" ).c_str(),
         std::string( shader_directory_path + "/scene_shader.frag" ).c_str()
     );
+    LightUniformShader->addDefine( "MAX_LIGHTS", LightGL::MaxLightNum );
+    LightUniformShader->setShader(
+        std::string( shader_directory_path + "/scene_shader.vert" ).c_str(),
+        std::string( shader_directory_path + "/scene_shader_light_uniforms.frag" ).c_str()
+    );
     glClearColor( 0.35f, 0.0f, 0.53f, 1.0f );
 }
 
@@ -49,6 +55,9 @@ void C01Lighting::keyboard(GLFWwindow* window, int key, int scancode, int action
         case GLFW_KEY_SPACE:
             DrawMovingObject = !DrawMovingObject;
             break;
+        case GLFW_KEY_B:
+            benchmarkLights();
+            break;
         case GLFW_KEY_P: {
             const glm::vec3 pos = MainCamera->getCameraPosition();
             std::cout << "Camera Position: " << pos.x << ", " << pos.y << ", " << pos.z << "\n";
@@ -102,16 +111,32 @@ void C01Lighting::setObject() const
     Object->setDiffuseReflectionColor( diffuse_color );
 }
 
-void C01Lighting::drawObject(const float& scale_factor) const
+void C01Lighting::setLightUniforms(const LightGL& lights) const
 {
-    using l = ShaderGL::LIGHT_UNIFORM;
-    using m = ShaderGL::MATERIAL_UNIFORM;
+    using l = lighting::LIGHT_MEMBER;
 
-    MainCamera->update3DCamera( FrameWidth, FrameHeight );
+    LightUniformShader->uniform1i( lighting::LightNum, lights.getTotalLightNum() );
+    LightUniformShader->uniform4fv( lighting::GlobalAmbient, lights.getGlobalAmbientColor() );
+    for (int i = 0; i < lights.getTotalLightNum(); ++i) {
+        const int offset = lighting::Lights + l::LightMemberNum * i;
+        LightUniformShader->uniform1i( offset + l::LightSwitch, lights.isActivated( i ) ? 1 : 0 );
+        LightUniformShader->uniform4fv( offset + l::LightPosition, lights.getPosition( i ) );
+        LightUniformShader->uniform4fv( offset + l::LightAmbientColor, lights.getAmbientColors( i ) );
+        LightUniformShader->uniform4fv( offset + l::LightDiffuseColor, lights.getDiffuseColors( i ) );
+        LightUniformShader->uniform4fv( offset + l::LightSpecularColor, lights.getSpecularColors( i ) );
+        LightUniformShader->uniform3fv( offset + l::SpotlightDirection, lights.getSpotlightDirections( i ) );
+        LightUniformShader->uniform1f( offset + l::SpotlightCutoffAngle, lights.getSpotlightCutoffAngles( i ) );
+        LightUniformShader->uniform1f( offset + l::SpotlightFeather, lights.getSpotlightFeathers( i ) );
+        LightUniformShader->uniform1f( offset + l::FallOffRadius, lights.getFallOffRadii( i ) );
+    }
+}
+
+void C01Lighting::drawObject(const ShaderGL& shader, float scale_factor) const
+{
     glViewport( 0, 0, FrameWidth, FrameHeight );
 
     glBindFramebuffer( GL_FRAMEBUFFER, 0 );
-    glUseProgram( ObjectShader->getShaderProgram() );
+    glUseProgram( shader.getShaderProgram() );
 
     const glm::mat4 to_origin = translate( glm::mat4( 1.0f ), glm::vec3( -0.5f, -0.5f, 0.0f ) );
     const glm::mat4 scale_matrix = scale(
@@ -125,46 +150,102 @@ void C01Lighting::drawObject(const float& scale_factor) const
         ) * to_world;
     }
 
-    ObjectShader->uniformMat4fv( lighting::WorldMatrix, to_world );
-    ObjectShader->uniformMat4fv( lighting::ViewMatrix, MainCamera->getViewMatrix() );
-    ObjectShader->uniformMat4fv(
-        lighting::ModelViewProjectionMatrix,
-        MainCamera->getProjectionMatrix() * MainCamera->getViewMatrix() * to_world
+    const GLuint draw = DrawData->addDraw(
+        *Object, to_world, MainCamera->getViewMatrix(), MainCamera->getProjectionMatrix()
     );
-    ObjectShader->uniform1i( lighting::UseTexture, 1 );
-    ObjectShader->uniform4fv( lighting::Material + m::EmissionColor, Object->getEmissionColor() );
-    ObjectShader->uniform4fv( lighting::Material + m::AmbientColor, Object->getAmbientReflectionColor() );
-    ObjectShader->uniform4fv( lighting::Material + m::DiffuseColor, Object->getDiffuseReflectionColor() );
-    ObjectShader->uniform4fv( lighting::Material + m::SpecularColor, Object->getSpecularReflectionColor() );
-    ObjectShader->uniform1f( lighting::Material + m::SpecularExponent, Object->getSpecularReflectionExponent() );
-    ObjectShader->uniform1i( lighting::UseLight, Lights->isLightOn() ? 1 : 0 );
-    if (Lights->isLightOn()) {
-        ObjectShader->uniform1i( lighting::LightNum, Lights->getTotalLightNum() );
-        ObjectShader->uniform4fv( lighting::GlobalAmbient, Lights->getGlobalAmbientColor() );
-        for (int i = 0; i < Lights->getTotalLightNum(); ++i) {
-            const int offset = lighting::Lights + l::UniformNum * i;
-            ObjectShader->uniform1i( offset + l::LightSwitch, Lights->isActivated( i ) ? 1 : 0 );
-            ObjectShader->uniform4fv( offset + l::LightPosition, Lights->getPosition( i ) );
-            ObjectShader->uniform4fv( offset + l::LightAmbientColor, Lights->getAmbientColors( i ) );
-            ObjectShader->uniform4fv( offset + l::LightDiffuseColor, Lights->getDiffuseColors( i ) );
-            ObjectShader->uniform4fv( offset + l::LightSpecularColor, Lights->getSpecularColors( i ) );
-            ObjectShader->uniform3fv( offset + l::SpotlightDirection, Lights->getSpotlightDirections( i ) );
-            ObjectShader->uniform1f( offset + l::SpotlightCutoffAngle, Lights->getSpotlightCutoffAngles( i ) );
-            ObjectShader->uniform1f( offset + l::SpotlightFeather, Lights->getSpotlightFeathers( i ) );
-            ObjectShader->uniform1f( offset + l::FallOffRadius, Lights->getFallOffRadii( i ) );
-        }
-    }
+    shader.uniform1i( lighting::UseTexture, 1 );
+    shader.uniform1i( lighting::UseLight, Lights->isLightOn() ? 1 : 0 );
 
     glBindTextureUnit( 0, Object->getTextureID( 0 ) );
     glBindVertexArray( Object->getVAO() );
-    glDrawArrays( Object->getDrawMode(), 0, Object->getVertexNum() );
+    glDrawArraysInstancedBaseInstance( Object->getDrawMode(), 0, Object->getVertexNum(), 1, draw );
+}
+
+void C01Lighting::benchmarkLights() const
+{
+    // 32 spotlights on a ring around the object, all of which reach it, so that every fragment loops over them all.
+    LightGL lights;
+    for (int i = 0; i < LightGL::MaxLightNum; ++i) {
+        const float angle = glm::two_pi<float>() * static_cast<float>(i) / static_cast<float>(LightGL::MaxLightNum);
+        const glm::vec4 position( 30.0f * std::cos( angle ), 30.0f * std::sin( angle ), -20.0f, 1.0f );
+        lights.addLight(
+            position,
+            glm::vec4( 0.01f, 0.01f, 0.01f, 1.0f ),
+            glm::vec4( 0.05f, 0.05f, 0.05f, 1.0f ),
+            glm::vec4( 0.05f, 0.05f, 0.05f, 1.0f ),
+            glm::vec3( 0.0f, 0.0f, -50.0f ) - glm::vec3( position ),
+            60.0f,
+            0.1f,
+            1000.0f
+        );
+    }
+
+    // The lights are set by their uniforms for every draw as before, by the light buffer repacked every frame as if
+    // they all moved, and by the light buffer left as it is. The CPU time covers issuing the frames, and the GPU time
+    // is measured by a timer query around them.
+    constexpr int frame_num = 200;
+    GLuint query = 0;
+    glCreateQueries( GL_TIME_ELAPSED, 1, &query );
+    const auto getFrameTimes = [&](const std::function<void()>& draw)
+    {
+        glFinish();
+        const auto start = std::chrono::steady_clock::now();
+        glBeginQuery( GL_TIME_ELAPSED, query );
+        for (int i = 0; i < frame_num; ++i) {
+            glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+            DrawData->beginFrame();
+            draw();
+        }
+        glEndQuery( GL_TIME_ELAPSED );
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+        GLuint64 gpu_time = 0;
+        glGetQueryObjectui64v( query, GL_QUERY_RESULT, &gpu_time );
+        return glm::dvec2( elapsed.count() / frame_num, static_cast<double>(gpu_time) * 1e-6 / frame_num );
+    };
+    const glm::dvec2 uniform_times = getFrameTimes(
+        [&]()
+        {
+            setLightUniforms( lights );
+            drawObject( *LightUniformShader, 20.0f );
+        }
+    );
+    const glm::dvec2 repacked_times = getFrameTimes(
+        [&]()
+        {
+            lights.setLightPosition( lights.getPosition( 0 ), 0 );
+            lights.updateLightBuffer( MainCamera->getViewMatrix() );
+            drawObject( *ObjectShader, 20.0f );
+        }
+    );
+    const glm::dvec2 unchanged_times = getFrameTimes(
+        [&]()
+        {
+            lights.updateLightBuffer( MainCamera->getViewMatrix() );
+            drawObject( *ObjectShader, 20.0f );
+        }
+    );
+    glDeleteQueries( 1, &query );
+
+    // The buffer of the benchmark lights is gone, so the lights of the scene have to be bound again.
+    Lights->updateLightBuffer( MainCamera->getViewMatrix() );
+
+    std::ostringstream report;
+    report << ">> " << LightGL::MaxLightNum << " lights, CPU/GPU ms per frame: " << std::fixed
+        << std::setprecision( 3 ) << uniform_times.x << "/" << uniform_times.y << " by the uniforms, "
+        << repacked_times.x << "/" << repacked_times.y << " by the buffer repacked, "
+        << unchanged_times.x << "/" << unchanged_times.y << " by the buffer unchanged\n";
+    std::cout << report.str();
 }
 
 void C01Lighting::render() const
 {
     glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+    MainCamera->update3DCamera( FrameWidth, FrameHeight );
+    Lights->updateLightBuffer( MainCamera->getViewMatrix() );
+    DrawData->beginFrame();
 
-    drawObject( 20.0f );
+    drawObject( *ObjectShader, 20.0f );
 
     glBindVertexArray( 0 );
     glUseProgram( 0 );
@@ -184,6 +265,7 @@ void C01Lighting::play()
 
     setLights();
     setObject();
+    ShaderGL::reportProgramSetup();
 
     constexpr double update_time = 0.1;
     double last = glfwGetTime(), time_delta = 0.0;
@@ -5,17 +5,33 @@
 
 namespace lighting
 {
+    // The transforms and the material of a draw come from DrawDataGL.
     enum UNIFORM
     {
-        WorldMatrix = 0,
-        ViewMatrix,
-        ModelViewProjectionMatrix,
-        Lights,
-        Material = 291,
-        UseTexture = 296,
-        UseLight,
-        LightNum,
-        GlobalAmbient
+        UseTexture = 8,
+        UseLight
+    };
+
+    // The uniforms of scene_shader_light_uniforms.frag, where each light takes LightMemberNum locations from Lights.
+    enum LIGHT_UNIFORM
+    {
+        LightNum = 10,
+        GlobalAmbient,
+        Lights
+    };
+
+    enum LIGHT_MEMBER
+    {
+        LightSwitch = 0,
+        LightPosition,
+        LightAmbientColor,
+        LightDiffuseColor,
+        LightSpecularColor,
+        SpotlightDirection,
+        SpotlightCutoffAngle,
+        SpotlightFeather,
+        FallOffRadius,
+        LightMemberNum
     };
 }
 
@@ -36,13 +52,17 @@ private:
     bool DrawMovingObject = false;
     int ObjectRotationAngle = 0;
     std::unique_ptr<ShaderGL> ObjectShader = std::make_unique<ShaderGL>();
+    std::unique_ptr<ShaderGL> LightUniformShader = std::make_unique<ShaderGL>();
     std::unique_ptr<ObjectGL> Object = std::make_unique<ObjectGL>();
     std::unique_ptr<LightGL> Lights = std::make_unique<LightGL>();
+    std::unique_ptr<DrawDataGL> DrawData = std::make_unique<DrawDataGL>();
 
     void keyboard(GLFWwindow* window, int key, int scancode, int action, int mods) override;
     void setLights() const;
     void setObject() const;
-    void drawObject(const float& scale_factor = 1.0f) const;
+    void setLightUniforms(const LightGL& lights) const;
+    void drawObject(const ShaderGL& shader, float scale_factor) const;
+    void benchmarkLights() const;
     void render() const;
     void update();
 };
\ No newline at end of file
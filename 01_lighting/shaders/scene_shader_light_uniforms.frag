@@ -0,0 +1,86 @@
+#version 460
+
+// scene_shader.frag as it was before the light buffer, which sets each light by its own uniforms.
+// Only the light benchmark of 01_lighting uses it.
+
+struct LightInfo
+{
+    int LightSwitch;
+    vec4 Position;
+    vec4 AmbientColor;
+    vec4 DiffuseColor;
+    vec4 SpecularColor;
+    vec3 SpotlightDirection;
+    float SpotlightCutoffAngle;
+    float SpotlightFeather;
+    float FallOffRadius;
+};
+layout (location = 12) uniform LightInfo Lights[MAX_LIGHTS];
+
+#include "draw_data.glsl"
+
+layout (binding = 0) uniform sampler2D BaseTexture;
+
+layout (location = 8) uniform int UseTexture;
+layout (location = 9) uniform int UseLight;
+layout (location = 10) uniform int LightNum;
+layout (location = 11) uniform vec4 GlobalAmbient;
+
+in vec3 position_in_ec;
+in vec3 normal_in_ec;
+in vec2 tex_coord;
+flat in int draw_index;
+
+// Set from the entry of the draw at the start of main().
+MaterialInfo Material;
+mat4 ViewMatrix;
+
+layout (location = 0) out vec4 final_color;
+
+#include "blinn_phong.glsl"
+
+vec3 getSpotlightDirectionInEC(in int light_index)
+{
+    vec4 direction_in_ec = transpose( inverse( ViewMatrix ) ) * vec4(Lights[light_index].SpotlightDirection, zero);
+    return normalize( direction_in_ec.xyz );
+}
+
+vec4 calculateLightingEquation()
+{
+    vec4 color = Material.EmissionColor + GlobalAmbient * Material.AmbientColor;
+
+    for (int i = 0; i < LightNum; ++i) {
+        if (!bool(Lights[i].LightSwitch)) continue;
+
+        vec4 light_position_in_ec = ViewMatrix * Lights[i].Position;
+
+        float final_effect_factor = one;
+        vec3 light_vector = light_position_in_ec.xyz - position_in_ec;
+        if (IsPointLight( light_position_in_ec )) {
+            float attenuation = getAttenuation( light_vector, i );
+
+            light_vector = normalize( light_vector );
+            float spotlight_factor = getSpotlightFactor( light_vector, getSpotlightDirectionInEC( i ), i );
+            final_effect_factor = attenuation * spotlight_factor;
+        }
+        else light_vector = normalize( light_position_in_ec.xyz );
+
+        if (final_effect_factor <= zero) continue;
+
+        vec4 local_color = getBlinnPhongColor( light_vector, normal_in_ec, -normalize( position_in_ec ), i );
+        color += local_color * final_effect_factor;
+    }
+    return color;
+}
+
+void main()
+{
+    Material = Draws[draw_index].Material;
+    ViewMatrix = Draws[draw_index].ViewMatrix;
+
+    if (!bool(UseTexture)) final_color = vec4(one);
+    else final_color = texture( BaseTexture, tex_coord );
+
+    if (bool(UseLight)) final_color *= calculateLightingEquation();
+    else final_color *= Material.DiffuseColor;
+}
\ No newline at end of file
@@ -12,6 +12,7 @@ C02Projector::C02Projector()
     MainCamera->update3DCamera( FrameWidth, FrameHeight );
 
     const std::string shader_directory_path = std::string( CMAKE_SOURCE_DIR ) + "/02_projector/shaders";
+    ObjectShader->addDefine( "MAX_LIGHTS", LightGL::MaxLightNum );
     ObjectShader->setShader(
         std::string( shader_directory_path + "/projector.vert" ).c_str(),
         std::string( shader_directory_path + "/projector.frag" ).c_str()
@@ -247,6 +248,7 @@ void C02Projector::prepareSlide()
         if (!Video->read( SlideBuffer, VideoFrameIndex++ ))
             throw std::runtime_error( "Could not read a video frame!" );
         ScreenObject->setSquareObject( GL_TRIANGLES, SlideBuffer, screen_size.x, screen_size.y );
+        SlideRing = std::make_unique<RingBufferGL>( Video->getFrameBufferSize() );
         screen_size /= 100;
     }
     const float projector_depth = Projector->getNearPlane();
@@ -259,108 +261,48 @@ void C02Projector::prepareSlide()
 
 void C02Projector::drawWallObject() const
 {
-    using l = ShaderGL::LIGHT_UNIFORM;
-    using m = ShaderGL::MATERIAL_UNIFORM;
-
-    ObjectShader->uniformMat4fv( projector::WorldMatrix, glm::mat4( 1.0f ) );
-    ObjectShader->uniformMat4fv( projector::ViewMatrix, MainCamera->getViewMatrix() );
-    ObjectShader->uniformMat4fv(
-        projector::ModelViewProjectionMatrix,
-        MainCamera->getProjectionMatrix() * MainCamera->getViewMatrix()
+    const GLuint draw = DrawData->addDraw(
+        *WallObject, glm::mat4( 1.0f ), MainCamera->getViewMatrix(), MainCamera->getProjectionMatrix()
     );
     ObjectShader->uniformMat4fv( projector::ProjectorViewMatrix, Projector->getViewMatrix() );
     ObjectShader->uniformMat4fv( projector::ProjectorProjectionMatrix, Projector->getProjectionMatrix() );
     ObjectShader->uniform1i( projector::WhichObject, WALL );
-
-    ObjectShader->uniform4fv( projector::Material + m::EmissionColor, WallObject->getEmissionColor() );
-    ObjectShader->uniform4fv( projector::Material + m::AmbientColor, WallObject->getAmbientReflectionColor() );
-    ObjectShader->uniform4fv( projector::Material + m::DiffuseColor, WallObject->getDiffuseReflectionColor() );
-    ObjectShader->uniform4fv( projector::Material + m::SpecularColor, WallObject->getSpecularReflectionColor() );
-    ObjectShader->uniform1f( projector::Material + m::SpecularExponent, WallObject->getSpecularReflectionExponent() );
     ObjectShader->uniform1i( projector::UseLight, Lights->isLightOn() ? 1 : 0 );
-    if (Lights->isLightOn()) {
-        ObjectShader->uniform1i( projector::LightNum, Lights->getTotalLightNum() );
-        ObjectShader->uniform4fv( projector::GlobalAmbient, Lights->getGlobalAmbientColor() );
-        for (int i = 0; i < Lights->getTotalLightNum(); ++i) {
-            const int offset = projector::Lights + l::UniformNum * i;
-            ObjectShader->uniform1i( offset + l::LightSwitch, Lights->isActivated( i ) ? 1 : 0 );
-            ObjectShader->uniform4fv( offset + l::LightPosition, Lights->getPosition( i ) );
-            ObjectShader->uniform4fv( offset + l::LightAmbientColor, Lights->getAmbientColors( i ) );
-            ObjectShader->uniform4fv( offset + l::LightDiffuseColor, Lights->getDiffuseColors( i ) );
-            ObjectShader->uniform4fv( offset + l::LightSpecularColor, Lights->getSpecularColors( i ) );
-            ObjectShader->uniform3fv( offset + l::SpotlightDirection, Lights->getSpotlightDirections( i ) );
-            ObjectShader->uniform1f( offset + l::SpotlightCutoffAngle, Lights->getSpotlightCutoffAngles( i ) );
-            ObjectShader->uniform1f( offset + l::SpotlightFeather, Lights->getSpotlightFeathers( i ) );
-            ObjectShader->uniform1f( offset + l::FallOffRadius, Lights->getFallOffRadii( i ) );
-        }
-    }
 
     glBindTextureUnit( 0, ScreenObject->getTextureID( 0 ) );
     glBindVertexArray( WallObject->getVAO() );
-    glDrawArrays( WallObject->getDrawMode(), 0, WallObject->getVertexNum() );
+    glDrawArraysInstancedBaseInstance( WallObject->getDrawMode(), 0, WallObject->getVertexNum(), 1, draw );
 }
 
 void C02Projector::drawScreenObject() const
 {
-    using m = ShaderGL::MATERIAL_UNIFORM;
-
     const glm::mat4 to_world = inverse( Projector->getViewMatrix() ) *
         scale( glm::mat4( 1.0f ), glm::vec3( Projector->getWidth(), Projector->getHeight(), 1.0f ) ) *
         translate( glm::mat4( 1.0f ), glm::vec3( -0.5f, -0.5f, -Projector->getNearPlane() ) );
-    ObjectShader->uniformMat4fv( projector::WorldMatrix, to_world );
-    ObjectShader->uniformMat4fv( projector::ViewMatrix, MainCamera->getViewMatrix() );
-    ObjectShader->uniformMat4fv(
-        projector::ModelViewProjectionMatrix,
-        MainCamera->getProjectionMatrix() * MainCamera->getViewMatrix() * to_world
+    const GLuint draw = DrawData->addDraw(
+        *ScreenObject, to_world, MainCamera->getViewMatrix(), MainCamera->getProjectionMatrix()
     );
     ObjectShader->uniform1i( projector::WhichObject, SCREEN );
 
-    ObjectShader->uniform4fv( projector::Material + m::EmissionColor, ScreenObject->getEmissionColor() );
-    ObjectShader->uniform4fv( projector::Material + m::AmbientColor, ScreenObject->getAmbientReflectionColor() );
-    ObjectShader->uniform4fv( projector::Material + m::DiffuseColor, ScreenObject->getDiffuseReflectionColor() );
-    ObjectShader->uniform4fv( projector::Material + m::SpecularColor, ScreenObject->getSpecularReflectionColor() );
-    ObjectShader->uniform1f( projector::Material + m::SpecularExponent, ScreenObject->getSpecularReflectionExponent() );
-
     glBindTextureUnit( 0, ScreenObject->getTextureID( 0 ) );
     glBindVertexArray( ScreenObject->getVAO() );
-    glDrawArrays( ScreenObject->getDrawMode(), 0, ScreenObject->getVertexNum() );
+    glDrawArraysInstancedBaseInstance( ScreenObject->getDrawMode(), 0, ScreenObject->getVertexNum(), 1, draw );
 }
 
 void C02Projector::drawProjectorObject() const
 {
-    using m = ShaderGL::MATERIAL_UNIFORM;
-
     glLineWidth( 3.0f );
 
     const glm::mat4 to_world = inverse( Projector->getViewMatrix() );
-    ObjectShader->uniformMat4fv( projector::WorldMatrix, to_world );
-    ObjectShader->uniformMat4fv( projector::ViewMatrix, MainCamera->getViewMatrix() );
-    ObjectShader->uniformMat4fv(
-        projector::ModelViewProjectionMatrix,
-        MainCamera->getProjectionMatrix() * MainCamera->getViewMatrix() * to_world
+    const GLuint draw = DrawData->addDraw(
+        *ProjectorPyramidObject, to_world, MainCamera->getViewMatrix(), MainCamera->getProjectionMatrix()
     );
     ObjectShader->uniform1i( projector::WhichObject, PROJECTOR );
 
-    ObjectShader->uniform4fv( projector::Material + m::EmissionColor, ProjectorPyramidObject->getEmissionColor() );
-    ObjectShader->uniform4fv(
-        projector::Material + m::AmbientColor,
-        ProjectorPyramidObject->getAmbientReflectionColor()
-    );
-    ObjectShader->uniform4fv(
-        projector::Material + m::DiffuseColor,
-        ProjectorPyramidObject->getDiffuseReflectionColor()
-    );
-    ObjectShader->uniform4fv(
-        projector::Material + m::SpecularColor,
-        ProjectorPyramidObject->getSpecularReflectionColor()
-    );
-    ObjectShader->uniform1f(
-        projector::Material + m::SpecularExponent,
-        ProjectorPyramidObject->getSpecularReflectionExponent()
-    );
-
     glBindVertexArray( ProjectorPyramidObject->getVAO() );
-    glDrawArrays( ProjectorPyramidObject->getDrawMode(), 0, ProjectorPyramidObject->getVertexNum() );
+    glDrawArraysInstancedBaseInstance(
+        ProjectorPyramidObject->getDrawMode(), 0, ProjectorPyramidObject->getVertexNum(), 1, draw
+    );
     glLineWidth( 1.0f );
 }
 
@@ -370,6 +312,8 @@ void C02Projector::render() const
 
     MainCamera->update3DCamera( FrameWidth, FrameHeight );
     glViewport( 0, 0, FrameWidth, FrameHeight );
+    Lights->updateLightBuffer( MainCamera->getViewMatrix() );
+    DrawData->beginFrame();
 
     glBindFramebuffer( GL_FRAMEBUFFER, 0 );
     glUseProgram( ObjectShader->getShaderProgram() );
@@ -385,16 +329,21 @@ void C02Projector::play()
     setLights();
     setWallObject();
     prepareSlide();
+    ShaderGL::reportProgramSetup();
+
     while (!glfwWindowShouldClose( Window )) {
         render();
 
-        if (IsVideo && !Pause && Video->read( SlideBuffer, VideoFrameIndex++ )) {
-            ScreenObject->updateTexture( SlideBuffer, 0, Video->getFrameWidth(), Video->getFrameHeight(), GL_RGBA );
+        // The frames are decoded straight into the ring buffer, so the upload does not wait for the draws
+        // still reading the texture.
+        if (IsVideo && !Pause && Video->read( SlideRing->nextRegion(), VideoFrameIndex++ )) {
+            ScreenObject->updateTexture( *SlideRing, 0, Video->getFrameWidth(), Video->getFrameHeight(), GL_RGBA );
         }
 
         glfwSwapBuffers( Window );
         glfwPollEvents();
     }
+    if (SlideRing) SlideRing->printStatistics( "Video frames" );
     glfwDestroyWindow( Window );
 }
 
@@ -6,19 +6,13 @@
 
 namespace projector
 {
+    // The transforms and the material of a draw come from DrawDataGL.
     enum UNIFORM
     {
-        WorldMatrix = 0,
-        ViewMatrix,
-        ModelViewProjectionMatrix,
-        ProjectorViewMatrix,
+        ProjectorViewMatrix = 3,
         ProjectorProjectionMatrix,
-        Lights,
-        Material = 293,
-        WhichObject = 298,
-        UseLight,
-        LightNum,
-        GlobalAmbient
+        WhichObject = 10,
+        UseLight
     };
 }
 
@@ -53,7 +47,9 @@ private:
     std::unique_ptr<ObjectGL> ScreenObject;
     std::unique_ptr<ObjectGL> WallObject = std::make_unique<ObjectGL>();
     std::unique_ptr<LightGL> Lights = std::make_unique<LightGL>();
+    std::unique_ptr<DrawDataGL> DrawData = std::make_unique<DrawDataGL>();
     std::unique_ptr<VideoReader> Video;
+    std::unique_ptr<RingBufferGL> SlideRing;
 
     void keyboard(GLFWwindow* window, int key, int scancode, int action, int mods) override;
     void cursor(GLFWwindow* window, double xpos, double ypos) override;
@@ -1,8 +1,6 @@
 #version 460
 
-layout (location = 0) uniform mat4 WorldMatrix;
-layout (location = 1) uniform mat4 ViewMatrix;
-layout (location = 2) uniform mat4 ModelViewProjectionMatrix;
+#include "draw_data.glsl"
 
 layout (location = 3) uniform mat4 ProjectorViewMatrix;
 layout (location = 4) uniform mat4 ProjectorProjectionMatrix;
@@ -15,20 +13,24 @@ out vec3 position_in_ec;
 out vec3 normal_in_ec;
 out vec2 tex_coord;
 out vec3 projector_tex_coord;
+flat out int draw_index;
 
 void main()
 {
-    vec4 e_position = ViewMatrix * WorldMatrix * vec4(v_position, 1.0f);
-    vec4 e_normal = transpose( inverse( ViewMatrix * WorldMatrix ) ) * vec4(v_normal, 1.0f);
+    DrawInfo draw = Draws[gl_BaseInstance];
+    vec4 e_position = draw.ViewMatrix * draw.WorldMatrix * vec4(v_position, 1.0f);
+    vec4 e_normal = transpose( inverse( draw.ViewMatrix * draw.WorldMatrix ) ) * vec4(v_normal, 1.0f);
     position_in_ec = e_position.xyz;
     normal_in_ec = normalize( e_normal.xyz );
 
     tex_coord = v_tex_coord;
 
-    vec4 projector_point_in_cc = ProjectorProjectionMatrix * ProjectorViewMatrix * WorldMatrix * vec4(v_position, 1.0f);
+    vec4 projector_point_in_cc =
+        ProjectorProjectionMatrix * ProjectorViewMatrix * draw.WorldMatrix * vec4(v_position, 1.0f);
     projector_tex_coord.x = 0.5f * (projector_point_in_cc.x + projector_point_in_cc.w);
     projector_tex_coord.y = 0.5f * (projector_point_in_cc.y + projector_point_in_cc.w);
     projector_tex_coord.z = projector_point_in_cc.w;
 
-    gl_Position = ModelViewProjectionMatrix * vec4(v_position, 1.0f);
+    draw_index = gl_BaseInstance;
+    gl_Position = draw.ModelViewProjectionMatrix * vec4(v_position, 1.0f);
 }
\ No newline at end of file
@@ -10,6 +10,7 @@ C03GimbalLock::C03GimbalLock()
     MainCamera->update3DCamera( FrameWidth, FrameHeight );
 
     const std::string shader_directory_path = std::string( CMAKE_SOURCE_DIR ) + "/01_lighting/shaders";
+    ObjectShader->addDefine( "MAX_LIGHTS", LightGL::MaxLightNum );
     ObjectShader->setShader(
         std::string( shader_directory_path + "/scene_shader.vert" ).c_str(),
         std::string( shader_directory_path + "/scene_shader.frag" ).c_str()
@@ -104,102 +105,56 @@ void C03GimbalLock::setAxisObject() const
     AxisObject->setObject( GL_LINES, axis_vertices );
 }
 
-void C03GimbalLock::setTeapotObject() const
+void C03GimbalLock::setTeapotObject(AssetLoader& loader)
 {
-    std::vector<glm::vec3> teapot_vertices, teapot_normals;
-    std::vector<glm::vec2> teapot_textures;
     const std::string sample_directory_path = std::string( CMAKE_SOURCE_DIR ) + "/03_gimbal_lock";
-    if (ObjectGL::readObjectFile(
-        teapot_vertices,
-        teapot_normals,
-        teapot_textures,
-        std::string( sample_directory_path + "/teapot.obj" )
-    )) {
-        TeapotObject->setObject( GL_TRIANGLES, teapot_vertices, teapot_normals );
-    }
-    else throw std::runtime_error( "Could not read object file!" );
+    TeapotLoaded = loader.requestMesh( *TeapotObject, GL_TRIANGLES, sample_directory_path + "/teapot.obj" );
 }
 
 void C03GimbalLock::drawAxisObject(float scale_factor) const
 {
-    using m = ShaderGL::MATERIAL_UNIFORM;
-
     glUseProgram( ObjectShader->getShaderProgram() );
     glLineWidth( 5.0f );
 
-    ObjectShader->uniformMat4fv( lighting::ViewMatrix, MainCamera->getViewMatrix() );
     ObjectShader->uniform1i( lighting::UseTexture, 0 );
     ObjectShader->uniform1i( lighting::UseLight, 0 );
 
+    const glm::mat4& view_matrix = MainCamera->getViewMatrix();
+    const glm::mat4& projection_matrix = MainCamera->getProjectionMatrix();
     const glm::mat4 scale_matrix = scale( glm::mat4( 1.0f ), glm::vec3( scale_factor ) );
     glm::mat4 to_world = scale_matrix;
-    ObjectShader->uniformMat4fv( lighting::WorldMatrix, to_world );
-    ObjectShader->uniformMat4fv(
-        lighting::ModelViewProjectionMatrix,
-        MainCamera->getProjectionMatrix() * MainCamera->getViewMatrix() * to_world
-    );
-    ObjectShader->uniform4fv( lighting::Material + m::DiffuseColor, { 1.0f, 0.0f, 0.0f, 1.0f } );
+    AxisObject->setDiffuseReflectionColor( { 1.0f, 0.0f, 0.0f, 1.0f } );
+    GLuint draw = DrawData->addDraw( *AxisObject, to_world, view_matrix, projection_matrix );
     glBindVertexArray( AxisObject->getVAO() );
-    glDrawArrays( AxisObject->getDrawMode(), 0, AxisObject->getVertexNum() );
+    glDrawArraysInstancedBaseInstance( AxisObject->getDrawMode(), 0, AxisObject->getVertexNum(), 1, draw );
 
     to_world = scale_matrix * rotate( glm::mat4( 1.0f ), glm::radians( 90.0f ), glm::vec3( 0.0f, 0.0f, 1.0f ) );
-    ObjectShader->uniformMat4fv( lighting::WorldMatrix, to_world );
-    ObjectShader->uniformMat4fv(
-        lighting::ModelViewProjectionMatrix,
-        MainCamera->getProjectionMatrix() * MainCamera->getViewMatrix() * to_world
-    );
-    ObjectShader->uniform4fv( lighting::Material + m::DiffuseColor, { 0.0f, 1.0f, 0.0f, 1.0f } );
-    glDrawArrays( AxisObject->getDrawMode(), 0, AxisObject->getVertexNum() );
+    AxisObject->setDiffuseReflectionColor( { 0.0f, 1.0f, 0.0f, 1.0f } );
+    draw = DrawData->addDraw( *AxisObject, to_world, view_matrix, projection_matrix );
+    glDrawArraysInstancedBaseInstance( AxisObject->getDrawMode(), 0, AxisObject->getVertexNum(), 1, draw );
 
     to_world = scale_matrix * rotate( glm::mat4( 1.0f ), glm::radians( -90.0f ), glm::vec3( 0.0f, 1.0f, 0.0f ) );
-    ObjectShader->uniformMat4fv( lighting::WorldMatrix, to_world );
-    ObjectShader->uniformMat4fv(
-        lighting::ModelViewProjectionMatrix,
-        MainCamera->getProjectionMatrix() * MainCamera->getViewMatrix() * to_world
-    );
-    ObjectShader->uniform4fv( lighting::Material + m::DiffuseColor, { 0.0f, 0.0f, 1.0f, 1.0f } );
-    glDrawArrays( AxisObject->getDrawMode(), 0, AxisObject->getVertexNum() );
+    AxisObject->setDiffuseReflectionColor( { 0.0f, 0.0f, 1.0f, 1.0f } );
+    draw = DrawData->addDraw( *AxisObject, to_world, view_matrix, projection_matrix );
+    glDrawArraysInstancedBaseInstance( AxisObject->getDrawMode(), 0, AxisObject->getVertexNum(), 1, draw );
 
     glLineWidth( 1.0f );
 }
 
 void C03GimbalLock::drawTeapotObject(const glm::mat4& to_world) const
 {
-    using l = ShaderGL::LIGHT_UNIFORM;
-    using m = ShaderGL::MATERIAL_UNIFORM;
+    if (!AssetLoader::isReady( TeapotLoaded )) return;
 
     glUseProgram( ObjectShader->getShaderProgram() );
-    ObjectShader->uniformMat4fv( lighting::WorldMatrix, to_world );
-    ObjectShader->uniformMat4fv( lighting::ViewMatrix, MainCamera->getViewMatrix() );
-    ObjectShader->uniformMat4fv(
-        lighting::ModelViewProjectionMatrix,
-        MainCamera->getProjectionMatrix() * MainCamera->getViewMatrix() * to_world
+    const GLuint draw = DrawData->addDraw(
+        *TeapotObject, to_world, MainCamera->getViewMatrix(), MainCamera->getProjectionMatrix()
     );
     ObjectShader->uniform1i( lighting::UseTexture, 0 );
-    ObjectShader->uniform4fv( lighting::Material + m::EmissionColor, TeapotObject->getEmissionColor() );
-    ObjectShader->uniform4fv( lighting::Material + m::AmbientColor, TeapotObject->getAmbientReflectionColor() );
-    ObjectShader->uniform4fv( lighting::Material + m::DiffuseColor, TeapotObject->getDiffuseReflectionColor() );
-    ObjectShader->uniform4fv( lighting::Material + m::SpecularColor, TeapotObject->getSpecularReflectionColor() );
-    ObjectShader->uniform1f( lighting::Material + m::SpecularExponent, TeapotObject->getSpecularReflectionExponent() );
     ObjectShader->uniform1i( lighting::UseLight, Lights->isLightOn() ? 1 : 0 );
-    if (Lights->isLightOn()) {
-        ObjectShader->uniform1i( lighting::LightNum, Lights->getTotalLightNum() );
-        ObjectShader->uniform4fv( lighting::GlobalAmbient, Lights->getGlobalAmbientColor() );
-        for (int i = 0; i < Lights->getTotalLightNum(); ++i) {
-            const int offset = lighting::Lights + l::UniformNum * i;
-            ObjectShader->uniform1i( offset + l::LightSwitch, Lights->isActivated( i ) ? 1 : 0 );
-            ObjectShader->uniform4fv( offset + l::LightPosition, Lights->getPosition( i ) );
-            ObjectShader->uniform4fv( offset + l::LightAmbientColor, Lights->getAmbientColors( i ) );
-            ObjectShader->uniform4fv( offset + l::LightDiffuseColor, Lights->getDiffuseColors( i ) );
-            ObjectShader->uniform4fv( offset + l::LightSpecularColor, Lights->getSpecularColors( i ) );
-            ObjectShader->uniform3fv( offset + l::SpotlightDirection, Lights->getSpotlightDirections( i ) );
-            ObjectShader->uniform1f( offset + l::SpotlightCutoffAngle, Lights->getSpotlightCutoffAngles( i ) );
-            ObjectShader->uniform1f( offset + l::SpotlightFeather, Lights->getSpotlightFeathers( i ) );
-            ObjectShader->uniform1f( offset + l::FallOffRadius, Lights->getFallOffRadii( i ) );
-        }
-    }
     glBindVertexArray( TeapotObject->getVAO() );
-    glDrawArrays( TeapotObject->getDrawMode(), 0, TeapotObject->getVertexNum() );
+    glDrawElementsInstancedBaseInstance(
+        TeapotObject->getDrawMode(), TeapotObject->getIndexNum(), GL_UNSIGNED_INT, nullptr, 1, draw
+    );
 }
 
 void C03GimbalLock::displayEulerAngleMode()
@@ -269,6 +224,8 @@ void C03GimbalLock::render()
         Animator->CurrentFrameIndex = static_cast<int>(std::floor( Animator->ElapsedTime / Animator->TimePerSection ));
     }
 
+    Lights->updateLightBuffer( MainCamera->getViewMatrix() );
+    DrawData->beginFrame();
     displayEulerAngleMode();
     displayQuaternionMode();
     displayCapturedFrames();
@@ -278,12 +235,22 @@ void C03GimbalLock::play()
 {
     if (glfwWindowShouldClose( Window )) initialize();
 
+    // The axes show up right away, and the teapot joins them once its mesh is uploaded.
+    AssetLoader loader;
     setLights();
     setAxisObject();
-    setTeapotObject();
+    setTeapotObject( loader );
 
     Animator->TimePerSection = Animator->AnimationDuration / static_cast<double>(CapturedEulerAngles.size());
+    ShaderGL::reportProgramSetup();
+
     while (!glfwWindowShouldClose( Window )) {
+        if (!loader.isIdle()) {
+            loader.uploadPending();
+            if (loader.isIdle() && !AssetLoader::isReady( TeapotLoaded )) {
+                throw std::runtime_error( "Could not read object file!" );
+            }
+        }
         render();
         glfwSwapBuffers( Window );
         glfwPollEvents();
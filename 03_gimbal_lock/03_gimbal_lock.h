@@ -2,6 +2,7 @@
 
 #include "../01_lighting/01_lighting.h"
 #include "../common/include/shader.h"
+#include "../common/include/asset_loader.h"
 
 class C03GimbalLock final : public RendererGL
 {
@@ -33,18 +34,20 @@ private:
     glm::vec3 EulerAngle{};
     std::vector<glm::vec3> CapturedEulerAngles{ 5 };
     std::vector<glm::quat> CapturedQuaternions{ 5 };
+    std::shared_future<bool> TeapotLoaded;
     std::unique_ptr<Animation> Animator = std::make_unique<Animation>();
     std::unique_ptr<ShaderGL> ObjectShader = std::make_unique<ShaderGL>();
     std::unique_ptr<ObjectGL> AxisObject = std::make_unique<ObjectGL>();
     std::unique_ptr<ObjectGL> TeapotObject = std::make_unique<ObjectGL>();
     std::unique_ptr<LightGL> Lights = std::make_unique<LightGL>();
+    std::unique_ptr<DrawDataGL> DrawData = std::make_unique<DrawDataGL>();
 
     void cursor(GLFWwindow* window, double xpos, double ypos) override;
     void keyboard(GLFWwindow* window, int key, int scancode, int action, int mods) override;
     void captureFrame();
     void setLights() const;
     void setAxisObject() const;
-    void setTeapotObject() const;
+    void setTeapotObject(AssetLoader& loader);
     void drawAxisObject(float scale_factor = 1.0f) const;
     void drawTeapotObject(const glm::mat4& to_world) const;
     void displayEulerAngleMode();
@@ -136,6 +136,7 @@ void C04CubeMapping::setCubeObject(float length)
                 throw std::runtime_error( "Could not read a video frame!" );
         }
         CubeObject->addCubeTextures( FrameBuffers, w, h );
+        FrameRing = std::make_unique<RingBufferGL>( static_cast<GLsizeiptr>(w) * h * 4 * 6 );
         VideoFrameIndex++;
     }
     else {
@@ -178,21 +179,27 @@ void C04CubeMapping::play()
     if (glfwWindowShouldClose( Window )) initialize();
 
     setCubeObject( 5.0f );
+    ShaderGL::reportProgramSetup();
 
     while (!glfwWindowShouldClose( Window )) {
         render();
 
         if (IsVideo) {
+            // The faces are decoded straight into a region of the ring buffer, and the uploads from it do not wait
+            // for the draws still reading the cube map.
+            uint8_t* faces = FrameRing->nextRegion();
+            const int face_size = Videos[0]->getFrameBufferSize();
             for (int i = 0; i < 6; ++i) {
-                Videos[i]->read( FrameBuffers[i], VideoFrameIndex );
+                Videos[i]->read( faces + static_cast<ptrdiff_t>(face_size) * i, VideoFrameIndex );
             }
-            ObjectGL::updateCubeTextures( FrameBuffers, Videos[0]->getFrameWidth(), Videos[0]->getFrameHeight() );
+            ObjectGL::updateCubeTextures( *FrameRing, Videos[0]->getFrameWidth(), Videos[0]->getFrameHeight() );
             VideoFrameIndex++;
         }
 
         glfwSwapBuffers( Window );
         glfwPollEvents();
     }
+    if (FrameRing) FrameRing->printStatistics( "Cube map video frames" );
     glfwDestroyWindow( Window );
 }
 
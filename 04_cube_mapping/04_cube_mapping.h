@@ -26,6 +26,7 @@ private:
     std::unique_ptr<ShaderGL> ObjectShader = std::make_unique<ShaderGL>();
     std::unique_ptr<ObjectGL> CubeObject;
     std::array<std::unique_ptr<VideoReader>, 6> Videos;
+    std::unique_ptr<RingBufferGL> FrameRing;
 
     void keyboard(GLFWwindow* window, int key, int scancode, int action, int mods) override;
     void setCubeObject(float length);
@@ -257,6 +257,7 @@ void C05MovingPointOnBezierCurve::setCurveObjects() const
     VelocityCurveObject->setDiffuseReflectionColor( { 0.9f, 0.1f, 0.1f, 1.0f } );
 
     MovingObject->setObject( GL_POINTS, 1 );
+    MovingObject->setVertexStreaming();
     MovingObject->setDiffuseReflectionColor( { 1.0f, 0.0f, 0.0f, 1.0f } );
 }
 
@@ -322,11 +323,11 @@ void C05MovingPointOnBezierCurve::drawMovingPoint()
     switch (MoveType) {
         case MOVE_TYPE::UNIFORM:
             if (FrameIndex >= TotalPositionCurvePointNum) FrameIndex = TotalPositionCurvePointNum - 1;
-            MovingObject->updateDataBuffer( { UniformVelocityCurve[FrameIndex] } );
+            MovingObject->updateVertices<PositionLayout>( 1, &UniformVelocityCurve[FrameIndex] );
             break;
         case MOVE_TYPE::VARIABLE:
             if (FrameIndex >= TotalVelocityCurvePointNum) FrameIndex = TotalVelocityCurvePointNum - 1;
-            MovingObject->updateDataBuffer( { VariableVelocityCurve[FrameIndex] } );
+            MovingObject->updateVertices<PositionLayout>( 1, &VariableVelocityCurve[FrameIndex] );
             break;
         case MOVE_TYPE::NONE:
         default:
@@ -409,6 +410,7 @@ void C05MovingPointOnBezierCurve::play()
 
     setAxisObject();
     setCurveObjects();
+    ShaderGL::reportProgramSetup();
 
     while (!glfwWindowShouldClose( Window )) {
         drawMainCurve();
@@ -418,6 +420,7 @@ void C05MovingPointOnBezierCurve::play()
         glfwPollEvents();
         glfwSwapBuffers( Window );
     }
+    if (const auto* ring = MovingObject->getVertexRingBuffer()) ring->printStatistics( "Moving point" );
     glfwDestroyWindow( Window );
 }
 
@@ -11,15 +11,26 @@ C06BumpMapping::C06BumpMapping()
     MainCamera->update3DCamera( FrameWidth, FrameHeight );
 
     const std::string shader_directory_path = std::string( CMAKE_SOURCE_DIR ) + "/06_bump_mapping/shaders";
+    ObjectShader->addDefine( "MAX_LIGHTS", LightGL::MaxLightNum );
     ObjectShader->setShader(
         std::string( shader_directory_path + "/bump_mapping.vert" ).c_str(),
         std::string( shader_directory_path + "/bump_mapping.frag" ).c_str()
     );
+    BoxBlurShader->addDefine( "THREAD_GROUP_SIZE", ThreadGroupSize );
     BoxBlurShader->setComputeShader( std::string( shader_directory_path + "/box_blur.comp" ).c_str() );
+    NormalMapShader->addDefine( "THREAD_GROUP_SIZE", ThreadGroupSize );
     NormalMapShader->setComputeShader( std::string( shader_directory_path + "/normal_map.comp" ).c_str() );
     glClearColor( 0.1f, 0.1f, 0.1f, 1.0f );
 }
 
+C06BumpMapping::~C06BumpMapping()
+{
+    if (NoMipmapSampler != 0)
+        glDeleteSamplers( 1, &NoMipmapSampler );
+    if (TimeQueries[0] != 0)
+        glDeleteQueries( static_cast<GLsizei>(TimeQueries.size()), TimeQueries.data() );
+}
+
 void C06BumpMapping::keyboard(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
     if (action != GLFW_PRESS && action != GLFW_REPEAT) return;
@@ -50,6 +61,16 @@ void C06BumpMapping::keyboard(GLFWwindow* window, int key, int scancode, int act
             UseBumpMapping = !UseBumpMapping;
             std::cout << "Bump Mapping Turned " << (UseBumpMapping ? "On!\n" : "Off!\n");
             break;
+        case GLFW_KEY_M:
+            UseMipmaps = !UseMipmaps;
+            resetFrameTime();
+            std::cout << "Mipmaps Turned " << (UseMipmaps ? "On!\n" : "Off!\n");
+            break;
+        case GLFW_KEY_N:
+            UseInstancing = !UseInstancing;
+            resetFrameTime();
+            std::cout << "Instancing Turned " << (UseInstancing ? "On!\n" : "Off!\n");
+            break;
         case GLFW_KEY_P: {
             const glm::vec3 pos = MainCamera->getCameraPosition();
             std::cout << "Camera Position: " << pos.x << ", " << pos.y << ", " << pos.z << "\n";
@@ -90,126 +111,177 @@ void C06BumpMapping::setLights() const
     );
 }
 
-void C06BumpMapping::createNormalMap(ObjectGL* object)
+void C06BumpMapping::createNormalMaps()
 {
-    GLuint texture_id = object->getTextureID( 0 );
-    const glm::ivec2 size = object->getTextureSize( texture_id );
-    object->addTexture( size.x, size.y );
-    object->addTexture( size.x, size.y );
-
-    int t = 0;
-    const std::array<GLuint, 2> textures{ object->getTextureID( 1 ), object->getTextureID( 2 ) };
-    glUseProgram( BoxBlurShader->getShaderProgram() );
-    BoxBlurShader->uniform1f( box_blur::BlurRadius, 3.0f );
-    for (int i = 0; i < 3; ++i) {
-        BoxBlurShader->uniform1i( box_blur::IsHorizontal, 1 );
-        glBindImageTexture( 0, texture_id, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA8 );
-        glBindImageTexture( 1, textures[t], 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8 );
-        glDispatchCompute( getGroupSize( size.y ), 1, 1 );
-        glMemoryBarrier( GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
-        texture_id = textures[t];
-        t ^= 1;
+    const GLuint base_array = WallObject->getTextureID( BaseTextureIndex );
+    const glm::ivec2 size = WallObject->getTextureSize( base_array );
+    NormalTextureIndex = WallObject->addTextureArray( size.x, size.y, WallNum );
+    const GLuint normal_array = WallObject->getTextureID( NormalTextureIndex );
+
+    // The blur passes of a layer ping-pong between these, and the last pass writes into the layer of the normal maps.
+    // The layer given to glBindImageTexture picks the layer of an array and is ignored for these.
+    std::array<GLuint, 2> textures{};
+    glCreateTextures( GL_TEXTURE_2D, static_cast<GLsizei>(textures.size()), textures.data() );
+    for (const auto& texture : textures) glTextureStorage2D( texture, 1, GL_RGBA8, size.x, size.y );
 
-        BoxBlurShader->uniform1i( box_blur::IsHorizontal, 0 );
+    for (int layer = 0; layer < WallNum; ++layer) {
+        int t = 0;
+        GLuint texture_id = base_array;
+        glUseProgram( BoxBlurShader->getShaderProgram() );
+        BoxBlurShader->uniform1f( box_blur::BlurRadius, 3.0f );
+        for (int i = 0; i < 3; ++i) {
+            BoxBlurShader->uniform1i( box_blur::IsHorizontal, 1 );
+            glBindImageTexture( 0, texture_id, 0, GL_FALSE, layer, GL_READ_ONLY, GL_RGBA8 );
+            glBindImageTexture( 1, textures[t], 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8 );
+            glDispatchCompute( getGroupSize( size.y ), 1, 1 );
+            glMemoryBarrier( GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
+            texture_id = textures[t];
+            t ^= 1;
+
+            BoxBlurShader->uniform1i( box_blur::IsHorizontal, 0 );
+            glBindImageTexture( 0, texture_id, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA8 );
+            glBindImageTexture( 1, textures[t], 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8 );
+            glDispatchCompute( getGroupSize( size.x ), 1, 1 );
+            glMemoryBarrier( GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
+            texture_id = textures[t];
+            t ^= 1;
+        }
+
+        glUseProgram( NormalMapShader->getShaderProgram() );
         glBindImageTexture( 0, texture_id, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA8 );
-        glBindImageTexture( 1, textures[t], 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8 );
-        glDispatchCompute( getGroupSize( size.x ), 1, 1 );
+        glBindImageTexture( 1, normal_array, 0, GL_FALSE, layer, GL_WRITE_ONLY, GL_RGBA8 );
+        glDispatchCompute( getGroupSize( size.x ), getGroupSize( size.y ), 1 );
         glMemoryBarrier( GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
-        texture_id = textures[t];
-        t ^= 1;
     }
+    glMemoryBarrier( GL_TEXTURE_UPDATE_BARRIER_BIT | GL_TEXTURE_FETCH_BARRIER_BIT );
+    glDeleteTextures( static_cast<GLsizei>(textures.size()), textures.data() );
 
-    glUseProgram( NormalMapShader->getShaderProgram() );
-    glBindImageTexture( 0, texture_id, 0, GL_FALSE, 0, GL_READ_ONLY, GL_RGBA8 );
-    glBindImageTexture( 1, textures[t], 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8 );
-    glDispatchCompute( getGroupSize( size.x ), getGroupSize( size.y ), 1 );
-    glMemoryBarrier( GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
-    NormalTextureIndex = t + 1;
+    // The compute shaders write the base level only, so the lower levels are filtered from it afterward.
+    glGenerateTextureMipmap( normal_array );
 }
 
-void C06BumpMapping::setWallObjects()
+void C06BumpMapping::setWallObject()
 {
+    // The walls come in different sizes, so they are rescaled to the size of the largest ones to share an array.
+    constexpr int wall_texture_size = 1024;
     const std::string sample_directory_path = std::string( CMAKE_SOURCE_DIR ) + "/06_bump_mapping/samples/";
-    for (size_t i = 0; i < WallObjects.size(); ++i) {
-        WallObjects[i] = std::make_unique<ObjectGL>();
-        const std::string texture_path = sample_directory_path + std::to_string( i ) + ".jpg";
-        WallObjects[i]->setSquareObject( GL_TRIANGLES, texture_path );
-        WallObjects[i]->setDiffuseReflectionColor( { 1.0f, 1.0f, 1.0f, 1.0f } );
-        createNormalMap( WallObjects[i].get() );
+    std::vector<std::string> texture_paths;
+    for (int i = 0; i < WallNum; ++i) {
+        texture_paths.emplace_back( sample_directory_path + std::to_string( i ) + ".jpg" );
+    }
+
+    WallObject = std::make_unique<ObjectGL>();
+    WallObject->setSquareObject( GL_TRIANGLES );
+    BaseTextureIndex = WallObject->addTextureArray(
+        texture_paths, wall_texture_size, wall_texture_size, MipmapGenerator::Kaiser
+    );
+    WallObject->setDiffuseReflectionColor( { 1.0f, 1.0f, 1.0f, 1.0f } );
+    createNormalMaps();
+
+    // The walls stand in a 3x3 grid, from the bottom to the top in each column and from the left to the right.
+    std::array<WallInstance, WallNum> instances{};
+    for (int i = 0; i < WallNum; ++i) {
+        const auto x = static_cast<float>(i / 3);
+        const auto y = static_cast<float>(i % 3);
+        instances[i].WorldMatrix = translate( glm::mat4( 1.0f ), glm::vec3( x, y, 0.0f ) );
+        instances[i].Layer = glm::ivec4( i, 0, 0, 0 );
     }
+    InstanceBuffer = WallObject->addCustomBufferObject<WallInstance>( WallNum );
+    ObjectGL::upload<WallInstance>( InstanceBuffer, 0, WallNum, instances.data() );
 }
 
-void C06BumpMapping::drawWallObject(const ObjectGL* object, const glm::mat4& to_world) const
+void C06BumpMapping::setMipmapBenchmark()
+{
+    // Binding this sampler samples the base level only, which shows what the walls cost without the mipmaps.
+    glCreateSamplers( 1, &NoMipmapSampler );
+    glSamplerParameteri( NoMipmapSampler, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+    glSamplerParameteri( NoMipmapSampler, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+    glSamplerParameteri( NoMipmapSampler, GL_TEXTURE_WRAP_S, GL_REPEAT );
+    glSamplerParameteri( NoMipmapSampler, GL_TEXTURE_WRAP_T, GL_REPEAT );
+    glCreateQueries( GL_TIME_ELAPSED, static_cast<GLsizei>(TimeQueries.size()), TimeQueries.data() );
+}
+
+void C06BumpMapping::drawWalls(int first_wall, int wall_num) const
 {
-    using l = ShaderGL::LIGHT_UNIFORM;
     using m = ShaderGL::MATERIAL_UNIFORM;
 
     glUseProgram( ObjectShader->getShaderProgram() );
-    ObjectShader->uniformMat4fv( bump_mapping::WorldMatrix, to_world );
     ObjectShader->uniformMat4fv( bump_mapping::ViewMatrix, MainCamera->getViewMatrix() );
     ObjectShader->uniformMat4fv(
-        bump_mapping::ModelViewProjectionMatrix,
-        MainCamera->getProjectionMatrix() * MainCamera->getViewMatrix() * to_world
+        bump_mapping::ViewProjectionMatrix,
+        MainCamera->getProjectionMatrix() * MainCamera->getViewMatrix()
     );
     ObjectShader->uniform1i( bump_mapping::UseBumpMapping, UseBumpMapping ? 1 : 0 );
-    ObjectShader->uniform4fv( bump_mapping::Material + m::EmissionColor, object->getEmissionColor() );
-    ObjectShader->uniform4fv( bump_mapping::Material + m::AmbientColor, object->getAmbientReflectionColor() );
-    ObjectShader->uniform4fv( bump_mapping::Material + m::DiffuseColor, object->getDiffuseReflectionColor() );
-    ObjectShader->uniform4fv( bump_mapping::Material + m::SpecularColor, object->getSpecularReflectionColor() );
-    ObjectShader->uniform1f( bump_mapping::Material + m::SpecularExponent, object->getSpecularReflectionExponent() );
-    ObjectShader->uniform1i( bump_mapping::LightNum, Lights->getTotalLightNum() );
-    ObjectShader->uniform4fv( bump_mapping::GlobalAmbient, Lights->getGlobalAmbientColor() );
-    for (int i = 0; i < Lights->getTotalLightNum(); ++i) {
-        const int offset = bump_mapping::Lights + l::UniformNum * i;
-        ObjectShader->uniform1i( offset + l::LightSwitch, Lights->isActivated( i ) ? 1 : 0 );
-        ObjectShader->uniform4fv( offset + l::LightPosition, Lights->getPosition( i ) );
-        ObjectShader->uniform4fv( offset + l::LightAmbientColor, Lights->getAmbientColors( i ) );
-        ObjectShader->uniform4fv( offset + l::LightDiffuseColor, Lights->getDiffuseColors( i ) );
-        ObjectShader->uniform4fv( offset + l::LightSpecularColor, Lights->getSpecularColors( i ) );
-        ObjectShader->uniform3fv( offset + l::SpotlightDirection, Lights->getSpotlightDirections( i ) );
-        ObjectShader->uniform1f( offset + l::SpotlightCutoffAngle, Lights->getSpotlightCutoffAngles( i ) );
-        ObjectShader->uniform1f( offset + l::SpotlightFeather, Lights->getSpotlightFeathers( i ) );
-        ObjectShader->uniform1f( offset + l::FallOffRadius, Lights->getFallOffRadii( i ) );
-    }
-    glBindTextureUnit( 0, object->getTextureID( 0 ) );
-    glBindTextureUnit( 1, object->getTextureID( NormalTextureIndex ) );
-    glBindVertexArray( object->getVAO() );
-    glDrawArrays( object->getDrawMode(), 0, object->getVertexNum() );
+    ObjectShader->uniform4fv( bump_mapping::Material + m::EmissionColor, WallObject->getEmissionColor() );
+    ObjectShader->uniform4fv( bump_mapping::Material + m::AmbientColor, WallObject->getAmbientReflectionColor() );
+    ObjectShader->uniform4fv( bump_mapping::Material + m::DiffuseColor, WallObject->getDiffuseReflectionColor() );
+    ObjectShader->uniform4fv( bump_mapping::Material + m::SpecularColor, WallObject->getSpecularReflectionColor() );
+    ObjectShader->uniform1f(
+        bump_mapping::Material + m::SpecularExponent,
+        WallObject->getSpecularReflectionExponent()
+    );
+    glBindTextureUnit( 0, WallObject->getTextureID( BaseTextureIndex ) );
+    glBindTextureUnit( 1, WallObject->getTextureID( NormalTextureIndex ) );
+    glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 0, InstanceBuffer );
+    glBindVertexArray( WallObject->getVAO() );
+
+    // The shader finds the instance at gl_BaseInstance + gl_InstanceID, so a single wall is drawn from its own base.
+    glDrawArraysInstancedBaseInstance(
+        WallObject->getDrawMode(),
+        0,
+        WallObject->getVertexNum(),
+        wall_num,
+        static_cast<GLuint>(first_wall)
+    );
 }
 
 void C06BumpMapping::render() const
 {
     glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+    glBindSampler( 0, UseMipmaps ? 0 : NoMipmapSampler );
+    glBindSampler( 1, UseMipmaps ? 0 : NoMipmapSampler );
 
     const float light_x = 1.25f * std::cos( LightTheta ) + 1.5f;
     const float light_y = 1.25f * std::sin( LightTheta ) + 1.5f;
     Lights->setLightPosition( glm::vec4( light_x, light_y, 0.2f, 1.0f ), 0 );
+    Lights->updateLightBuffer( MainCamera->getViewMatrix() );
 
-    const glm::mat4 to_up = translate( glm::mat4( 1.0f ), glm::vec3( 0.0f, 1.0f, 0.0f ) );
-    glm::mat4 to_world_3rd_row( 1.0f );
-    glm::mat4 to_world_2nd_row = to_up;
-    glm::mat4 to_world_1st_row = to_world_2nd_row * to_up;
-
-    drawWallObject( WallObjects[0].get(), to_world_3rd_row );
-    drawWallObject( WallObjects[1].get(), to_world_2nd_row );
-    drawWallObject( WallObjects[2].get(), to_world_1st_row );
-
-    const glm::mat4 to_right = translate( glm::mat4( 1.0f ), glm::vec3( 1.0f, 0.0f, 0.0f ) );
-    to_world_3rd_row *= to_right;
-    to_world_2nd_row *= to_right;
-    to_world_1st_row *= to_right;
+    // Without instancing, every wall pays for its own uniforms, binds and draw call as separate objects would.
+    if (UseInstancing) drawWalls( 0, WallNum );
+    else {
+        for (int i = 0; i < WallNum; ++i) drawWalls( i, 1 );
+    }
+}
 
-    drawWallObject( WallObjects[3].get(), to_world_3rd_row );
-    drawWallObject( WallObjects[4].get(), to_world_2nd_row );
-    drawWallObject( WallObjects[5].get(), to_world_1st_row );
+void C06BumpMapping::resetFrameTime()
+{
+    TimedFrameNum = 0;
+    CPUTimeInMs = 0.0;
+    GPUTimeInMs = 0.0;
+}
 
-    to_world_3rd_row *= to_right;
-    to_world_2nd_row *= to_right;
-    to_world_1st_row *= to_right;
+void C06BumpMapping::reportFrameTime(double cpu_time_in_ms)
+{
+    // The query of the previous frame is read, which has finished by now without stalling the pipeline.
+    if (FrameIndex > 0) {
+        GLuint64 elapsed_time = 0;
+        glGetQueryObjectui64v( TimeQueries[(FrameIndex - 1) & 1], GL_QUERY_RESULT, &elapsed_time );
+        GPUTimeInMs += static_cast<double>(elapsed_time) * 1e-6;
+        CPUTimeInMs += cpu_time_in_ms;
+        ++TimedFrameNum;
+    }
+    ++FrameIndex;
 
-    drawWallObject( WallObjects[6].get(), to_world_3rd_row );
-    drawWallObject( WallObjects[7].get(), to_world_2nd_row );
-    drawWallObject( WallObjects[8].get(), to_world_1st_row );
+    constexpr int report_interval = 300;
+    if (TimedFrameNum == report_interval) {
+        std::ostringstream report;
+        report << ">> Walls " << (UseMipmaps ? "with" : "without") << " mipmaps in "
+            << (UseInstancing ? 1 : WallNum) << (UseInstancing ? " draw call: " : " draw calls: ") << std::fixed
+            << std::setprecision( 3 ) << CPUTimeInMs / report_interval << " ms of CPU time and "
+            << GPUTimeInMs / report_interval << " ms of GPU time per frame\n";
+        std::cout << report.str();
+        resetFrameTime();
+    }
 }
 
 void C06BumpMapping::play()
@@ -217,10 +289,18 @@ void C06BumpMapping::play()
     if (glfwWindowShouldClose( Window )) initialize();
 
     setLights();
-    setWallObjects();
+    setWallObject();
+    setMipmapBenchmark();
+    ShaderGL::reportProgramSetup();
 
     while (!glfwWindowShouldClose( Window )) {
+        // The CPU time is what the driver takes to record the draws, which is what instancing saves.
+        glBeginQuery( GL_TIME_ELAPSED, TimeQueries[FrameIndex & 1] );
+        const auto start = std::chrono::steady_clock::now();
         render();
+        const std::chrono::duration<double, std::milli> cpu_time = std::chrono::steady_clock::now() - start;
+        glEndQuery( GL_TIME_ELAPSED );
+        reportFrameTime( cpu_time.count() );
 
         LightTheta += 0.05f;
         if (LightTheta >= 360.0f) LightTheta -= 360.0f;
@@ -7,14 +7,10 @@ namespace bump_mapping
 {
     enum UNIFORM
     {
-        WorldMatrix = 0,
-        ViewMatrix,
-        ModelViewProjectionMatrix,
-        Lights,
-        Material = 291,
-        UseBumpMapping = 296,
-        LightNum,
-        GlobalAmbient
+        ViewMatrix = 0,
+        ViewProjectionMatrix,
+        Material,
+        UseBumpMapping = 7
     };
 }
 
@@ -27,7 +23,7 @@ class C06BumpMapping final : public RendererGL
 {
 public:
     C06BumpMapping();
-    ~C06BumpMapping() override = default;
+    ~C06BumpMapping() override;
 
     C06BumpMapping(C06BumpMapping&&) = delete;
     C06BumpMapping(const C06BumpMapping&) = delete;
@@ -37,19 +33,41 @@ public:
     void play();
 
 private:
+    // Matches the std430 layout of the instances in bump_mapping.vert.
+    struct WallInstance
+    {
+        glm::mat4 WorldMatrix;
+        glm::ivec4 Layer;
+    };
+
+    static constexpr int WallNum = 9;
+
     bool UseBumpMapping = true;
+    bool UseMipmaps = true;
+    bool UseInstancing = true;
+    int BaseTextureIndex = -1;
     int NormalTextureIndex = -1;
+    int FrameIndex = 0;
+    int TimedFrameNum = 0;
+    double CPUTimeInMs = 0.0;
+    double GPUTimeInMs = 0.0;
+    GLuint InstanceBuffer = 0;
+    GLuint NoMipmapSampler = 0;
+    std::array<GLuint, 2> TimeQueries{};
     float LightTheta = 0.0f;
     std::unique_ptr<LightGL> Lights = std::make_unique<LightGL>();
     std::unique_ptr<ShaderGL> ObjectShader = std::make_unique<ShaderGL>();
     std::unique_ptr<ShaderGL> BoxBlurShader = std::make_unique<ShaderGL>();
     std::unique_ptr<ShaderGL> NormalMapShader = std::make_unique<ShaderGL>();
-    std::array<std::unique_ptr<ObjectGL>, 9> WallObjects;
+    std::unique_ptr<ObjectGL> WallObject;
 
     void keyboard(GLFWwindow* window, int key, int scancode, int action, int mods) override;
     void setLights() const;
-    void createNormalMap(ObjectGL* object);
-    void setWallObjects();
-    void drawWallObject(const ObjectGL* object, const glm::mat4& to_world) const;
+    void createNormalMaps();
+    void setWallObject();
+    void setMipmapBenchmark();
+    void drawWalls(int first_wall, int wall_num) const;
     void render() const;
+    void resetFrameTime();
+    void reportFrameTime(double cpu_time_in_ms);
 };
\ No newline at end of file
@@ -1,7 +1,14 @@
 #version 460
 
-layout (location = 0) uniform mat4 WorldMatrix;
-layout (location = 2) uniform mat4 ModelViewProjectionMatrix;
+struct InstanceInfo
+{
+    mat4 WorldMatrix;
+    ivec4 Layer;
+};
+layout (binding = 0, std430) readonly buffer Instances { InstanceInfo Instance[]; };
+
+layout (location = 0) uniform mat4 ViewMatrix;
+layout (location = 1) uniform mat4 ViewProjectionMatrix;
 
 layout (location = 0) in vec3 v_position;
 layout (location = 1) in vec3 v_normal;
@@ -12,14 +19,19 @@ out vec2 tex_coord;
 out vec3 normal_in_mc;
 out vec3 tangent_in_mc;
 out vec3 binormal_in_mc;
+flat out vec3 eye_position_in_mc;
+flat out int layer;
 
 void main()
 {   
-    position_in_mc = (WorldMatrix * vec4(v_position, 1.0f)).xyz;
+    InstanceInfo instance = Instance[gl_BaseInstance + gl_InstanceID];
+    position_in_mc = (instance.WorldMatrix * vec4(v_position, 1.0f)).xyz;
     tex_coord = v_tex_coord;
     normal_in_mc = normalize( v_normal );
     tangent_in_mc = vec3(1.0f, 0.0f, 0.0f);
     binormal_in_mc = cross( v_normal, tangent_in_mc );
+    eye_position_in_mc = (inverse( ViewMatrix * instance.WorldMatrix ) * vec4(0.0f, 0.0f, 0.0f, 1.0f)).xyz;
+    layer = instance.Layer.x;
    
-    gl_Position = ModelViewProjectionMatrix * vec4(v_position, 1.0f);
+    gl_Position = ViewProjectionMatrix * vec4(position_in_mc, 1.0f);
 }
\ No newline at end of file
@@ -10,12 +10,15 @@ C07WaveSimulation::C07WaveSimulation()
     MainCamera->update3DCamera( FrameWidth, FrameHeight );
 
     std::string shader_directory_path = std::string( CMAKE_SOURCE_DIR ) + "/01_lighting/shaders";
+    ObjectShader->addDefine( "MAX_LIGHTS", LightGL::MaxLightNum );
     ObjectShader->setShader(
         std::string( shader_directory_path + "/scene_shader.vert" ).c_str(),
         std::string( shader_directory_path + "/scene_shader.frag" ).c_str()
     );
     shader_directory_path = std::string( CMAKE_SOURCE_DIR ) + "/07_wave_simulation/shaders";
+    WaveShader->addDefine( "THREAD_GROUP_SIZE", ThreadGroupSize );
     WaveShader->setComputeShader( std::string( shader_directory_path + "/wave.comp" ).c_str() );
+    WaveNormalShader->addDefine( "THREAD_GROUP_SIZE", ThreadGroupSize );
     WaveNormalShader->setComputeShader( std::string( shader_directory_path + "/wave_normal.comp" ).c_str() );
     glClearColor( 1.0f, 1.0f, 1.0f, 1.0f );
 }
@@ -29,6 +32,9 @@ void C07WaveSimulation::keyboard(GLFWwindow* window, int key, int scancode, int
             Lights->toggleLightSwitch();
             std::cout << "Light Turned " << (Lights->isLightOn() ? "On!\n" : "Off!\n");
             break;
+        case GLFW_KEY_B:
+            benchmarkGridSubmission();
+            break;
         case GLFW_KEY_Q:
         case GLFW_KEY_ESCAPE:
             cleanup( window );
@@ -78,13 +84,7 @@ void C07WaveSimulation::setWaveObject()
         }
     }
 
-    std::vector<GLuint> wave_indices;
-    for (int j = 0; j < WavePointNum.y - 1; ++j) {
-        for (int i = 0; i < WavePointNum.x; ++i) {
-            wave_indices.emplace_back( (j + 1) * WavePointNum.x + i );
-            wave_indices.emplace_back( j * WavePointNum.x + i );
-        }
-    }
+    const std::vector<GLuint> wave_indices = ObjectGL::getGridStripIndices( WavePointNum );
 
     const std::string sample_directory_path = std::string( CMAKE_SOURCE_DIR ) + "/07_wave_simulation";
     WaveObject->setObject(
@@ -107,6 +107,78 @@ void C07WaveSimulation::setWaveObject()
     WaveFactor = WaveFactor * WaveFactor * delta_time * delta_time / dx;
 }
 
+void C07WaveSimulation::benchmarkGridSubmission() const
+{
+    // The grids are drawn one row per call as before, by one glMultiDrawElements over the rows, and as one strip
+    // restarted at the end of each row. Only the time to issue the draws is measured, so the GPU is drained before
+    // and after, and the rasterizer is turned off to keep the large grids from backing up the command queue.
+    constexpr int repeat_num = 20;
+    glEnable( GL_RASTERIZER_DISCARD );
+    for (const int point_num : { 100, 200, 400, 800, 1600 }) {
+        std::vector<glm::vec3> vertices, normals;
+        for (int j = 0; j < point_num; ++j) {
+            for (int i = 0; i < point_num; ++i) {
+                vertices.emplace_back( static_cast<float>(i), 0.0f, static_cast<float>(j) );
+                normals.emplace_back( 0.0f, 1.0f, 0.0f );
+            }
+        }
+        ObjectGL grid;
+        grid.setObject(
+            GL_TRIANGLE_STRIP,
+            vertices,
+            normals,
+            ObjectGL::getGridStripIndices( glm::ivec2( point_num ) )
+        );
+
+        const int row_num = point_num - 1;
+        const int row_index_num = point_num * 2;
+        const std::vector<GLsizei> counts( row_num, row_index_num );
+        std::vector<const void*> offsets;
+        for (int j = 0; j < row_num; ++j) {
+            const auto offset = static_cast<uintptr_t>(j) * (row_index_num + 1) * sizeof( GLuint );
+            offsets.emplace_back( reinterpret_cast<const void*>(offset) );
+        }
+
+        glBindVertexArray( grid.getVAO() );
+        const auto getSubmissionTime = [](const std::function<void()>& submit)
+        {
+            glFinish();
+            const auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < repeat_num; ++i) submit();
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            glFinish();
+            return elapsed.count() / repeat_num;
+        };
+        const double per_row_time = getSubmissionTime(
+            [&]()
+            {
+                for (int j = 0; j < row_num; ++j) {
+                    glDrawElements( GL_TRIANGLE_STRIP, row_index_num, GL_UNSIGNED_INT, offsets[j] );
+                }
+            }
+        );
+        const double multi_draw_time = getSubmissionTime(
+            [&]()
+            {
+                glMultiDrawElements( GL_TRIANGLE_STRIP, counts.data(), GL_UNSIGNED_INT, offsets.data(), row_num );
+            }
+        );
+        const double restart_time = getSubmissionTime(
+            [&]()
+            {
+                glDrawElements( GL_TRIANGLE_STRIP, grid.getIndexNum(), GL_UNSIGNED_INT, nullptr );
+            }
+        );
+
+        std::ostringstream report;
+        report << ">> " << point_num << "x" << point_num << " grid: " << std::fixed << std::setprecision( 3 )
+            << per_row_time << " ms in " << row_num << " calls, " << multi_draw_time << " ms by a multi-draw, "
+            << restart_time << " ms by a restarted strip\n";
+        std::cout << report.str();
+    }
+    glDisable( GL_RASTERIZER_DISCARD );
+}
+
 void C07WaveSimulation::render()
 {
     glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
@@ -127,49 +199,19 @@ void C07WaveSimulation::render()
 
     WaveTargetIndex = (WaveTargetIndex + 1) % 3;
 
-    using l = ShaderGL::LIGHT_UNIFORM;
-    using m = ShaderGL::MATERIAL_UNIFORM;
-
-    glUseProgram( ObjectShader->getShaderProgram() );
-    ObjectShader->uniformMat4fv( lighting::WorldMatrix, glm::mat4( 1.0f ) );
-    ObjectShader->uniformMat4fv( lighting::ViewMatrix, MainCamera->getViewMatrix() );
-    ObjectShader->uniformMat4fv(
-        lighting::ModelViewProjectionMatrix,
-        MainCamera->getProjectionMatrix() * MainCamera->getViewMatrix()
+    Lights->updateLightBuffer( MainCamera->getViewMatrix() );
+    DrawData->beginFrame();
+    const GLuint draw = DrawData->addDraw(
+        *WaveObject, glm::mat4( 1.0f ), MainCamera->getViewMatrix(), MainCamera->getProjectionMatrix()
     );
+    glUseProgram( ObjectShader->getShaderProgram() );
     ObjectShader->uniform1i( lighting::UseTexture, 1 );
-    ObjectShader->uniform4fv( lighting::Material + m::EmissionColor, WaveObject->getEmissionColor() );
-    ObjectShader->uniform4fv( lighting::Material + m::AmbientColor, WaveObject->getAmbientReflectionColor() );
-    ObjectShader->uniform4fv( lighting::Material + m::DiffuseColor, WaveObject->getDiffuseReflectionColor() );
-    ObjectShader->uniform4fv( lighting::Material + m::SpecularColor, WaveObject->getSpecularReflectionColor() );
-    ObjectShader->uniform1f( lighting::Material + m::SpecularExponent, WaveObject->getSpecularReflectionExponent() );
     ObjectShader->uniform1i( lighting::UseLight, Lights->isLightOn() ? 1 : 0 );
-    if (Lights->isLightOn()) {
-        ObjectShader->uniform1i( lighting::LightNum, Lights->getTotalLightNum() );
-        ObjectShader->uniform4fv( lighting::GlobalAmbient, Lights->getGlobalAmbientColor() );
-        for (int i = 0; i < Lights->getTotalLightNum(); ++i) {
-            const int offset = lighting::Lights + l::UniformNum * i;
-            ObjectShader->uniform1i( offset + l::LightSwitch, Lights->isActivated( i ) ? 1 : 0 );
-            ObjectShader->uniform4fv( offset + l::LightPosition, Lights->getPosition( i ) );
-            ObjectShader->uniform4fv( offset + l::LightAmbientColor, Lights->getAmbientColors( i ) );
-            ObjectShader->uniform4fv( offset + l::LightDiffuseColor, Lights->getDiffuseColors( i ) );
-            ObjectShader->uniform4fv( offset + l::LightSpecularColor, Lights->getSpecularColors( i ) );
-            ObjectShader->uniform3fv( offset + l::SpotlightDirection, Lights->getSpotlightDirections( i ) );
-            ObjectShader->uniform1f( offset + l::SpotlightCutoffAngle, Lights->getSpotlightCutoffAngles( i ) );
-            ObjectShader->uniform1f( offset + l::SpotlightFeather, Lights->getSpotlightFeathers( i ) );
-            ObjectShader->uniform1f( offset + l::FallOffRadius, Lights->getFallOffRadii( i ) );
-        }
-    }
     glBindTextureUnit( 0, WaveObject->getTextureID( 0 ) );
     glBindVertexArray( WaveObject->getVAO() );
-    for (int j = 0; j < WavePointNum.y - 1; ++j) {
-        glDrawElements(
-            WaveObject->getDrawMode(),
-            WavePointNum.x * 2,
-            GL_UNSIGNED_INT,
-            reinterpret_cast<GLvoid*>(j * WavePointNum.x * 2 * sizeof( GLuint ))
-        );
-    }
+    glDrawElementsInstancedBaseInstance(
+        WaveObject->getDrawMode(), WaveObject->getIndexNum(), GL_UNSIGNED_INT, nullptr, 1, draw
+    );
 }
 
 void C07WaveSimulation::play()
@@ -178,6 +220,8 @@ void C07WaveSimulation::play()
 
     setLights();
     setWaveObject();
+    glEnable( GL_PRIMITIVE_RESTART_FIXED_INDEX );
+    ShaderGL::reportProgramSetup();
 
     while (!glfwWindowShouldClose( Window )) {
         render();
@@ -29,9 +29,11 @@ private:
     std::unique_ptr<ShaderGL> WaveNormalShader = std::make_unique<ShaderGL>();
     std::unique_ptr<ObjectGL> WaveObject = std::make_unique<ObjectGL>();
     std::unique_ptr<LightGL> Lights = std::make_unique<LightGL>();
+    std::unique_ptr<DrawDataGL> DrawData = std::make_unique<DrawDataGL>();
 
     void keyboard(GLFWwindow* window, int key, int scancode, int action, int mods) override;
     void setLights() const;
     void setWaveObject();
+    void benchmarkGridSubmission() const;
     void render();
 };
\ No newline at end of file
@@ -10,11 +10,13 @@ C08ClothSimulation::C08ClothSimulation()
     MainCamera->update3DCamera( FrameWidth, FrameHeight );
 
     std::string shader_directory_path = std::string( CMAKE_SOURCE_DIR ) + "/01_lighting/shaders";
+    ObjectShader->addDefine( "MAX_LIGHTS", LightGL::MaxLightNum );
     ObjectShader->setShader(
         std::string( shader_directory_path + "/scene_shader.vert" ).c_str(),
         std::string( shader_directory_path + "/scene_shader.frag" ).c_str()
     );
     shader_directory_path = std::string( CMAKE_SOURCE_DIR ) + "/08_cloth_simulation/shaders";
+    ClothShader->addDefine( "THREAD_GROUP_SIZE", ThreadGroupSize );
     ClothShader->setComputeShader( std::string( shader_directory_path + "/cloth.comp" ).c_str() );
     glClearColor( 0.3f, 0.3f, 0.3f, 1.0f );
 }
@@ -95,13 +97,7 @@ void C08ClothSimulation::setClothObject()
         }
     }
 
-    std::vector<GLuint> cloth_indices;
-    for (int j = 0; j < ClothPointNumSize.y - 1; ++j) {
-        for (int i = 0; i < ClothPointNumSize.x; ++i) {
-            cloth_indices.emplace_back( (j + 1) * ClothPointNumSize.x + i );
-            cloth_indices.emplace_back( j * ClothPointNumSize.x + i );
-        }
-    }
+    const std::vector<GLuint> cloth_indices = ObjectGL::getGridStripIndices( ClothPointNumSize );
 
     const std::string sample_directory_path = std::string( CMAKE_SOURCE_DIR ) + "/08_cloth_simulation/samples";
     ClothObject->setObject(
@@ -174,88 +170,29 @@ void C08ClothSimulation::applyForces()
 
 void C08ClothSimulation::drawClothObject() const
 {
-    using l = ShaderGL::LIGHT_UNIFORM;
-    using m = ShaderGL::MATERIAL_UNIFORM;
-
-    ObjectShader->uniformMat4fv( lighting::WorldMatrix, ClothWorldMatrix );
-    ObjectShader->uniformMat4fv( lighting::ViewMatrix, MainCamera->getViewMatrix() );
-    ObjectShader->uniformMat4fv(
-        lighting::ModelViewProjectionMatrix,
-        MainCamera->getProjectionMatrix() * MainCamera->getViewMatrix() * ClothWorldMatrix
+    const GLuint draw = DrawData->addDraw(
+        *ClothObject, ClothWorldMatrix, MainCamera->getViewMatrix(), MainCamera->getProjectionMatrix()
     );
     ObjectShader->uniform1i( lighting::UseTexture, 1 );
-    ObjectShader->uniform4fv( lighting::Material + m::EmissionColor, ClothObject->getEmissionColor() );
-    ObjectShader->uniform4fv( lighting::Material + m::AmbientColor, ClothObject->getAmbientReflectionColor() );
-    ObjectShader->uniform4fv( lighting::Material + m::DiffuseColor, ClothObject->getDiffuseReflectionColor() );
-    ObjectShader->uniform4fv( lighting::Material + m::SpecularColor, ClothObject->getSpecularReflectionColor() );
-    ObjectShader->uniform1f( lighting::Material + m::SpecularExponent, ClothObject->getSpecularReflectionExponent() );
     ObjectShader->uniform1i( lighting::UseLight, Lights->isLightOn() ? 1 : 0 );
-    if (Lights->isLightOn()) {
-        ObjectShader->uniform1i( lighting::LightNum, Lights->getTotalLightNum() );
-        ObjectShader->uniform4fv( lighting::GlobalAmbient, Lights->getGlobalAmbientColor() );
-        for (int i = 0; i < Lights->getTotalLightNum(); ++i) {
-            const int offset = lighting::Lights + l::UniformNum * i;
-            ObjectShader->uniform1i( offset + l::LightSwitch, Lights->isActivated( i ) ? 1 : 0 );
-            ObjectShader->uniform4fv( offset + l::LightPosition, Lights->getPosition( i ) );
-            ObjectShader->uniform4fv( offset + l::LightAmbientColor, Lights->getAmbientColors( i ) );
-            ObjectShader->uniform4fv( offset + l::LightDiffuseColor, Lights->getDiffuseColors( i ) );
-            ObjectShader->uniform4fv( offset + l::LightSpecularColor, Lights->getSpecularColors( i ) );
-            ObjectShader->uniform3fv( offset + l::SpotlightDirection, Lights->getSpotlightDirections( i ) );
-            ObjectShader->uniform1f( offset + l::SpotlightCutoffAngle, Lights->getSpotlightCutoffAngles( i ) );
-            ObjectShader->uniform1f( offset + l::SpotlightFeather, Lights->getSpotlightFeathers( i ) );
-            ObjectShader->uniform1f( offset + l::FallOffRadius, Lights->getFallOffRadii( i ) );
-        }
-    }
     glBindTextureUnit( 0, ClothObject->getTextureID( 0 ) );
     glBindVertexArray( ClothObject->getVAO() );
-    for (int j = 0; j < ClothPointNumSize.y - 1; ++j) {
-        glDrawElements(
-            ClothObject->getDrawMode(),
-            ClothPointNumSize.x * 2,
-            GL_UNSIGNED_INT,
-            reinterpret_cast<GLvoid*>(j * ClothPointNumSize.x * 2 * sizeof( GLuint ))
-        );
-    }
+    glDrawElementsInstancedBaseInstance(
+        ClothObject->getDrawMode(), ClothObject->getIndexNum(), GL_UNSIGNED_INT, nullptr, 1, draw
+    );
 }
 
 void C08ClothSimulation::drawSphereObject() const
 {
-    using l = ShaderGL::LIGHT_UNIFORM;
-    using m = ShaderGL::MATERIAL_UNIFORM;
-
     const glm::mat4 to_world = SphereWorldMatrix * translate( glm::mat4( 1.0f ), SpherePosition );
-    ObjectShader->uniformMat4fv( lighting::WorldMatrix, to_world );
-    ObjectShader->uniformMat4fv( lighting::ViewMatrix, MainCamera->getViewMatrix() );
-    ObjectShader->uniformMat4fv(
-        lighting::ModelViewProjectionMatrix,
-        MainCamera->getProjectionMatrix() * MainCamera->getViewMatrix() * to_world
+    const GLuint draw = DrawData->addDraw(
+        *SphereObject, to_world, MainCamera->getViewMatrix(), MainCamera->getProjectionMatrix()
     );
     ObjectShader->uniform1i( lighting::UseTexture, 1 );
-    ObjectShader->uniform4fv( lighting::Material + m::EmissionColor, SphereObject->getEmissionColor() );
-    ObjectShader->uniform4fv( lighting::Material + m::AmbientColor, SphereObject->getAmbientReflectionColor() );
-    ObjectShader->uniform4fv( lighting::Material + m::DiffuseColor, SphereObject->getDiffuseReflectionColor() );
-    ObjectShader->uniform4fv( lighting::Material + m::SpecularColor, SphereObject->getSpecularReflectionColor() );
-    ObjectShader->uniform1f( lighting::Material + m::SpecularExponent, SphereObject->getSpecularReflectionExponent() );
     ObjectShader->uniform1i( lighting::UseLight, Lights->isLightOn() ? 1 : 0 );
-    if (Lights->isLightOn()) {
-        ObjectShader->uniform1i( lighting::LightNum, Lights->getTotalLightNum() );
-        ObjectShader->uniform4fv( lighting::GlobalAmbient, Lights->getGlobalAmbientColor() );
-        for (int i = 0; i < Lights->getTotalLightNum(); ++i) {
-            const int offset = lighting::Lights + l::UniformNum * i;
-            ObjectShader->uniform1i( offset + l::LightSwitch, Lights->isActivated( i ) ? 1 : 0 );
-            ObjectShader->uniform4fv( offset + l::LightPosition, Lights->getPosition( i ) );
-            ObjectShader->uniform4fv( offset + l::LightAmbientColor, Lights->getAmbientColors( i ) );
-            ObjectShader->uniform4fv( offset + l::LightDiffuseColor, Lights->getDiffuseColors( i ) );
-            ObjectShader->uniform4fv( offset + l::LightSpecularColor, Lights->getSpecularColors( i ) );
-            ObjectShader->uniform3fv( offset + l::SpotlightDirection, Lights->getSpotlightDirections( i ) );
-            ObjectShader->uniform1f( offset + l::SpotlightCutoffAngle, Lights->getSpotlightCutoffAngles( i ) );
-            ObjectShader->uniform1f( offset + l::SpotlightFeather, Lights->getSpotlightFeathers( i ) );
-            ObjectShader->uniform1f( offset + l::FallOffRadius, Lights->getFallOffRadii( i ) );
-        }
-    }
     glBindTextureUnit( 0, SphereObject->getTextureID( 0 ) );
     glBindVertexArray( SphereObject->getVAO() );
-    glDrawArrays( SphereObject->getDrawMode(), 0, SphereObject->getVertexNum() );
+    glDrawArraysInstancedBaseInstance( SphereObject->getDrawMode(), 0, SphereObject->getVertexNum(), 1, draw );
 }
 
 void C08ClothSimulation::render()
@@ -265,6 +202,8 @@ void C08ClothSimulation::render()
     applyForces();
 
     glViewport( 0, 0, FrameWidth, FrameHeight );
+    Lights->updateLightBuffer( MainCamera->getViewMatrix() );
+    DrawData->beginFrame();
     glUseProgram( ObjectShader->getShaderProgram() );
     drawClothObject();
     drawSphereObject();
@@ -277,6 +216,8 @@ void C08ClothSimulation::play()
     setLights();
     setClothObject();
     setSphereObject();
+    glEnable( GL_PRIMITIVE_RESTART_FIXED_INDEX );
+    ShaderGL::reportProgramSetup();
 
     while (!glfwWindowShouldClose( Window )) {
         render();
@@ -55,6 +55,7 @@ private:
     std::unique_ptr<ObjectGL> ClothObject = std::make_unique<ObjectGL>();
     std::unique_ptr<ObjectGL> SphereObject = std::make_unique<ObjectGL>();
     std::unique_ptr<LightGL> Lights = std::make_unique<LightGL>();
+    std::unique_ptr<DrawDataGL> DrawData = std::make_unique<DrawDataGL>();
 
     void keyboard(GLFWwindow* window, int key, int scancode, int action, int mods) override;
     void cursor(GLFWwindow* window, double xpos, double ypos) override;
@@ -13,9 +13,16 @@ C09DistanceTransform::C09DistanceTransform()
         std::string( shader_directory_path + "/field.vert" ).c_str(),
         std::string( shader_directory_path + "/field.frag" ).c_str()
     );
-    TransformShader->setComputeShader(
-        std::string( shader_directory_path + "/distance_transform.comp" ).c_str()
-    );
+    for (size_t i = 0; i < TransformShaders.size(); ++i) {
+        TransformShaders[i] = std::make_unique<ShaderGL>();
+        TransformShaders[i]->addDefine( "THREAD_GROUP_SIZE", ThreadGroupSize );
+        TransformShaders[i]->addDefine( "IMAGE_WIDTH", FrameWidth );
+        TransformShaders[i]->addDefine( "IMAGE_HEIGHT", FrameHeight );
+        TransformShaders[i]->addDefine( "DISTANCE_TYPE", static_cast<int>(i) + 1 );
+        TransformShaders[i]->setComputeShader(
+            std::string( shader_directory_path + "/distance_transform.comp" ).c_str()
+        );
+    }
     glClearColor( 0.97f, 0.93f, 0.89f, 1.0f );
     glDisable( GL_DEPTH_TEST );
 }
@@ -85,8 +92,10 @@ void C09DistanceTransform::drawImage() const
 
 void C09DistanceTransform::drawDistanceField()
 {
-    glUseProgram( TransformShader->getShaderProgram() );
-    TransformShader->uniform1i( distance_transform::Phase, 1 );
+    // The phase one does not depend on the type of distance, so the program of the type does it as well.
+    const ShaderGL* transform_shader = TransformShaders[static_cast<int>(DistanceType) - 1].get();
+    glUseProgram( transform_shader->getShaderProgram() );
+    transform_shader->uniform1i( distance_transform::Phase, 1 );
     glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 0, InsideColumnScannerBuffer );
     glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 1, OutsideColumnScannerBuffer );
     glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 2, InsideDistanceFieldBuffer );
@@ -95,8 +104,7 @@ void C09DistanceTransform::drawDistanceField()
     glDispatchCompute( getGroupSize( FrameHeight ), 1, 1 );
     glMemoryBarrier( GL_SHADER_STORAGE_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
 
-    TransformShader->uniform1i( distance_transform::Phase, 2 );
-    TransformShader->uniform1i( distance_transform::DistanceType, static_cast<int>(DistanceType) );
+    transform_shader->uniform1i( distance_transform::Phase, 2 );
     glDispatchCompute( getGroupSize( FrameWidth ), 1, 1 );
     glMemoryBarrier( GL_SHADER_STORAGE_BARRIER_BIT | GL_SHADER_IMAGE_ACCESS_BARRIER_BIT );
 
@@ -125,6 +133,7 @@ void C09DistanceTransform::play()
     if (glfwWindowShouldClose( Window )) initialize();
 
     setObjects();
+    ShaderGL::reportProgramSetup();
 
     while (!glfwWindowShouldClose( Window )) {
         render();
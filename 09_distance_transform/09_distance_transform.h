@@ -10,7 +10,7 @@ namespace mvp
 
 namespace distance_transform
 {
-    enum UNIFORM { Phase = 0, DistanceType };
+    enum UNIFORM { Phase = 0 };
 }
 
 class C09DistanceTransform final : public RendererGL
@@ -36,7 +36,8 @@ protected:
     GLuint OutsideDistanceFieldBuffer = 0;
     std::unique_ptr<ShaderGL> ObjectShader = std::make_unique<ShaderGL>();
     std::unique_ptr<ShaderGL> FieldShader = std::make_unique<ShaderGL>();
-    std::unique_ptr<ShaderGL> TransformShader = std::make_unique<ShaderGL>();
+    // A program for each type of distance, which the shader knows at compile time.
+    std::array<std::unique_ptr<ShaderGL>, 3> TransformShaders;
     std::unique_ptr<ObjectGL> ImageObject = std::make_unique<ObjectGL>();
     std::unique_ptr<ObjectGL> DistanceObject = std::make_unique<ObjectGL>();
     std::unique_ptr<CanvasGL> Canvas = std::make_unique<CanvasGL>();
@@ -18,6 +18,7 @@ C10ShadowMapping::C10ShadowMapping()
         std::string( shader_directory_path + "/simple.vert" ).c_str(),
         std::string( shader_directory_path + "/simple.frag" ).c_str()
     );
+    ShadowShader->addDefine( "MAX_LIGHTS", LightGL::MaxLightNum );
     ShadowShader->setShader(
         std::string( shader_directory_path + "/shadow.vert" ).c_str(),
         std::string( shader_directory_path + "/shadow.frag" ).c_str()
@@ -60,63 +61,48 @@ void C10ShadowMapping::setLights() const
     Lights->addLight( light_position, ambient_color, diffuse_color, specular_color );
 }
 
-void C10ShadowMapping::setGroundObject() const
+void C10ShadowMapping::setGroundObject(AssetLoader& loader)
 {
-    GroundObject->setSquareObject(
-        GL_TRIANGLES,
-        std::string( CMAKE_SOURCE_DIR ) + "/10_shadow_mapping/samples/sand.jpg"
+    GroundObject->setSquareObject( GL_TRIANGLES );
+    AssetsLoaded.emplace_back(
+        loader.requestTexture(
+            *GroundObject,
+            std::string( CMAKE_SOURCE_DIR ) + "/10_shadow_mapping/samples/sand.jpg",
+            BlockCompressor::BC1
+        )
     );
     GroundObject->setDiffuseReflectionColor( { 1.0f, 1.0f, 1.0f, 1.0f } );
 }
 
-void C10ShadowMapping::setTigerObject() const
+void C10ShadowMapping::setTigerObject(AssetLoader& loader)
 {
-    std::vector<glm::vec3> tiger_vertices, tiger_normals;
-    std::vector<glm::vec2> tiger_textures;
     const std::string sample_directory_path = std::string( CMAKE_SOURCE_DIR ) + "/10_shadow_mapping/samples";
-    if (ObjectGL::readTextFile(
-        tiger_vertices,
-        tiger_normals,
-        tiger_textures,
-        std::string( sample_directory_path + "/tiger.txt" )
-    )) {
-        TigerObject->setObject(
-            GL_TRIANGLES,
-            tiger_vertices,
-            tiger_normals,
-            tiger_textures,
-            std::string( sample_directory_path + "/tiger.jpg" )
-        );
-    }
-    else throw std::runtime_error( "Could not read text file!" );
-
+    AssetsLoaded.emplace_back( loader.requestMesh( *TigerObject, GL_TRIANGLES, sample_directory_path + "/tiger.txt" ) );
+    AssetsLoaded.emplace_back(
+        loader.requestTexture( *TigerObject, sample_directory_path + "/tiger.jpg", BlockCompressor::BC1 )
+    );
     TigerObject->setDiffuseReflectionColor( { 1.0f, 1.0f, 1.0f, 1.0f } );
 }
 
-void C10ShadowMapping::setPandaObject() const
+void C10ShadowMapping::setPandaObject(AssetLoader& loader)
 {
-    std::vector<glm::vec3> panda_vertices, panda_normals;
-    std::vector<glm::vec2> panda_textures;
     const std::string sample_directory_path = std::string( CMAKE_SOURCE_DIR ) + "/10_shadow_mapping/samples";
-    if (ObjectGL::readObjectFile(
-        panda_vertices,
-        panda_normals,
-        panda_textures,
-        std::string( sample_directory_path + "/panda.obj" )
-    )) {
-        PandaObject->setObject(
-            GL_TRIANGLES,
-            panda_vertices,
-            panda_normals,
-            panda_textures,
-            std::string( sample_directory_path + "/panda.png" )
-        );
-    }
-    else throw std::runtime_error( "Could not read object file!" );
-
+    PandaObject->setVertexFormat( ObjectGL::Compact2101010 );
+    AssetsLoaded.emplace_back( loader.requestMesh( *PandaObject, GL_TRIANGLES, sample_directory_path + "/panda.obj" ) );
+    AssetsLoaded.emplace_back(
+        loader.requestTexture( *PandaObject, sample_directory_path + "/panda.png", BlockCompressor::BC3 )
+    );
     PandaObject->setDiffuseReflectionColor( { 1.0f, 1.0f, 1.0f, 1.0f } );
 }
 
+bool C10ShadowMapping::isEverythingLoaded() const
+{
+    return std::all_of(
+        AssetsLoaded.begin(), AssetsLoaded.end(),
+        [](const std::shared_future<bool>& loaded) { return AssetLoader::isReady( loaded ); }
+    );
+}
+
 void C10ShadowMapping::setDepthFrameBuffer()
 {
     glCreateTextures( GL_TEXTURE_2D, 1, &DepthTextureID );
@@ -130,6 +116,15 @@ void C10ShadowMapping::setDepthFrameBuffer()
     glNamedFramebufferTexture( FBO, GL_DEPTH_ATTACHMENT, DepthTextureID, 0 );
 }
 
+void C10ShadowMapping::setGeometryArena()
+{
+    // The arena grows when the meshes do not fit, so this is only a first guess.
+    GeometryArena = std::make_unique<GeometryArenaGL>( 16 << 20, 4 << 20 );
+    GroundMesh = GeometryArena->addMesh( *GroundObject );
+    TigerMesh = GeometryArena->addMesh( *TigerObject );
+    PandaMesh = GeometryArena->addMesh( *PandaObject );
+}
+
 void C10ShadowMapping::drawDepthMapFromLightView(int light_index) const
 {
     glBindFramebuffer( GL_FRAMEBUFFER, FBO );
@@ -144,46 +139,46 @@ void C10ShadowMapping::drawDepthMapFromLightView(int light_index) const
         glm::vec3( 0.0f, 1.0f, 0.0f )
     );
 
-    glm::mat4 to_world =
+    const glm::mat4 tiger_to_world =
         translate( glm::mat4( 1.0f ), glm::vec3( 250.0f, 0.0f, 330.0f ) ) *
         rotate( glm::mat4( 1.0f ), glm::radians( 180.0f ), glm::vec3( 0.0f, 1.0f, 0.0f ) ) *
         rotate( glm::mat4( 1.0f ), glm::radians( -90.0f ), glm::vec3( 1.0f, 0.0f, 0.0f ) ) *
         scale( glm::mat4( 1.0f ), glm::vec3( 0.3f ) );
-    ObjectShader->uniformMat4fv(
-        simple::ModelViewProjectionMatrix,
-        LightCamera->getProjectionMatrix() * LightCamera->getViewMatrix() * to_world
-    );
-    glBindVertexArray( TigerObject->getVAO() );
-    glDrawArrays( TigerObject->getDrawMode(), 0, TigerObject->getVertexNum() );
-
-    to_world =
+    const glm::mat4 panda_to_world =
         translate( glm::mat4( 1.0f ), glm::vec3( 250.0f, -5.0f, 180.0f ) ) *
-        scale( glm::mat4( 1.0f ), glm::vec3( 20.0f ) );
-    ObjectShader->uniformMat4fv(
-        simple::ModelViewProjectionMatrix,
-        LightCamera->getProjectionMatrix() * LightCamera->getViewMatrix() * to_world
-    );
-    glBindVertexArray( PandaObject->getVAO() );
-    glDrawArrays( PandaObject->getDrawMode(), 0, PandaObject->getVertexNum() );
-
-    to_world =
+        scale( glm::mat4( 1.0f ), glm::vec3( 20.0f ) ) *
+        PandaObject->getDequantizationMatrix();
+    const glm::mat4 ground_to_world =
         translate( glm::mat4( 1.0f ), glm::vec3( 0.0f, 0.0f, 512.0f ) ) *
         rotate( glm::mat4( 1.0f ), glm::radians( -90.0f ), glm::vec3( 1.0f, 0.0f, 0.0f ) ) *
         scale( glm::mat4( 1.0f ), glm::vec3( 512.0f ) );
-    ObjectShader->uniformMat4fv(
-        simple::ModelViewProjectionMatrix,
-        LightCamera->getProjectionMatrix() * LightCamera->getViewMatrix() * to_world
+    const glm::mat4& view_matrix = LightCamera->getViewMatrix();
+    const glm::mat4& projection_matrix = LightCamera->getProjectionMatrix();
+    const GLuint tiger_draw = DrawData->addDraw( *TigerObject, tiger_to_world, view_matrix, projection_matrix );
+    const GLuint panda_draw = DrawData->addDraw( *PandaObject, panda_to_world, view_matrix, projection_matrix );
+    const GLuint ground_draw = DrawData->addDraw( *GroundObject, ground_to_world, view_matrix, projection_matrix );
+
+    // The depth pass only needs the silhouettes, so the levels of detail are selected in the shadow map texels.
+    // All the draws share the shader, so they go out in one multi-draw per vertex format.
+    const int tiger_level = TigerObject->selectLevelOfDetail( *LightCamera, tiger_to_world );
+    const int panda_level = PandaObject->selectLevelOfDetail( *LightCamera, panda_to_world );
+    GeometryArena->addDraw(
+        TigerMesh, tiger_draw,
+        TigerObject->getIndexNum( tiger_level ),
+        TigerObject->getFirstIndex( tiger_level )
     );
-    glBindVertexArray( GroundObject->getVAO() );
-    glDrawArrays( GroundObject->getDrawMode(), 0, GroundObject->getVertexNum() );
+    GeometryArena->addDraw(
+        PandaMesh, panda_draw,
+        PandaObject->getIndexNum( panda_level ),
+        PandaObject->getFirstIndex( panda_level )
+    );
+    GeometryArena->addDraw( GroundMesh, ground_draw );
+    GeometryArena->submitDraws();
     glColorMask( GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE );
 }
 
 void C10ShadowMapping::drawShadow(int light_index) const
 {
-    using l = ShaderGL::LIGHT_UNIFORM;
-    using m = ShaderGL::MATERIAL_UNIFORM;
-
     glBindFramebuffer( GL_FRAMEBUFFER, 0 );
     glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
     glUseProgram( ShadowShader->getShaderProgram() );
@@ -195,78 +190,37 @@ void C10ShadowMapping::drawShadow(int light_index) const
     ShadowShader->uniform1i( shadow::UseTexture, 1 );
     ShadowShader->uniform1i( shadow::UseLight, Lights->isLightOn() ? 1 : 0 );
     ShadowShader->uniform1i( shadow::LightIndex, light_index );
-    if (Lights->isLightOn()) {
-        const int offset = shadow::Lights + l::UniformNum * light_index;
-        ShadowShader->uniform1i( offset + l::LightSwitch, Lights->isActivated( light_index ) ? 1 : 0 );
-        ShadowShader->uniform4fv( offset + l::LightPosition, Lights->getPosition( light_index ) );
-        ShadowShader->uniform4fv( offset + l::LightAmbientColor, Lights->getAmbientColors( light_index ) );
-        ShadowShader->uniform4fv( offset + l::LightDiffuseColor, Lights->getDiffuseColors( light_index ) );
-        ShadowShader->uniform4fv( offset + l::LightSpecularColor, Lights->getSpecularColors( light_index ) );
-        ShadowShader->uniform3fv( offset + l::SpotlightDirection, Lights->getSpotlightDirections( light_index ) );
-        ShadowShader->uniform1f( offset + l::SpotlightCutoffAngle, Lights->getSpotlightCutoffAngles( light_index ) );
-        ShadowShader->uniform1f( offset + l::SpotlightFeather, Lights->getSpotlightFeathers( light_index ) );
-        ShadowShader->uniform1f( offset + l::FallOffRadius, Lights->getFallOffRadii( light_index ) );
-        ShadowShader->uniform4fv( shadow::GlobalAmbient, Lights->getGlobalAmbientColor() );
-    }
 
     glBindTextureUnit( 1, DepthTextureID );
 
+    // The objects differ in their textures, so they go out one by one, but with no uniforms between them and with no
+    // indirect buffer to rewrite between the draws.
+    const glm::mat4& view_matrix = MainCamera->getViewMatrix();
+    const glm::mat4& projection_matrix = MainCamera->getProjectionMatrix();
     glm::mat4 to_world =
         translate( glm::mat4( 1.0f ), glm::vec3( 250.0f, 0.0f, 330.0f ) ) *
         rotate( glm::mat4( 1.0f ), glm::radians( 180.0f ), glm::vec3( 0.0f, 1.0f, 0.0f ) ) *
         rotate( glm::mat4( 1.0f ), glm::radians( -90.0f ), glm::vec3( 1.0f, 0.0f, 0.0f ) ) *
         scale( glm::mat4( 1.0f ), glm::vec3( 0.3f ) );
-    ShadowShader->uniformMat4fv( shadow::WorldMatrix, to_world );
-    ShadowShader->uniformMat4fv( shadow::ViewMatrix, MainCamera->getViewMatrix() );
-    ShadowShader->uniformMat4fv(
-        shadow::ModelViewProjectionMatrix,
-        MainCamera->getProjectionMatrix() * MainCamera->getViewMatrix() * to_world
-    );
-    ShadowShader->uniform4fv( shadow::Material + m::EmissionColor, TigerObject->getEmissionColor() );
-    ShadowShader->uniform4fv( shadow::Material + m::AmbientColor, TigerObject->getAmbientReflectionColor() );
-    ShadowShader->uniform4fv( shadow::Material + m::DiffuseColor, TigerObject->getDiffuseReflectionColor() );
-    ShadowShader->uniform4fv( shadow::Material + m::SpecularColor, TigerObject->getSpecularReflectionColor() );
-    ShadowShader->uniform1f( shadow::Material + m::SpecularExponent, TigerObject->getSpecularReflectionExponent() );
+    GLuint draw = DrawData->addDraw( *TigerObject, to_world, view_matrix, projection_matrix );
     glBindTextureUnit( 0, TigerObject->getTextureID( 0 ) );
-    glBindVertexArray( TigerObject->getVAO() );
-    glDrawArrays( TigerObject->getDrawMode(), 0, TigerObject->getVertexNum() );
+    GeometryArena->drawMesh( TigerMesh, draw );
 
     to_world =
         translate( glm::mat4( 1.0f ), glm::vec3( 250.0f, -5.0f, 180.0f ) ) *
-        scale( glm::mat4( 1.0f ), glm::vec3( 20.0f ) );
-    ShadowShader->uniformMat4fv( shadow::WorldMatrix, to_world );
-    ShadowShader->uniformMat4fv( shadow::ViewMatrix, MainCamera->getViewMatrix() );
-    ShadowShader->uniformMat4fv(
-        shadow::ModelViewProjectionMatrix,
-        MainCamera->getProjectionMatrix() * MainCamera->getViewMatrix() * to_world
-    );
-    ShadowShader->uniform4fv( shadow::Material + m::EmissionColor, PandaObject->getEmissionColor() );
-    ShadowShader->uniform4fv( shadow::Material + m::AmbientColor, PandaObject->getAmbientReflectionColor() );
-    ShadowShader->uniform4fv( shadow::Material + m::DiffuseColor, PandaObject->getDiffuseReflectionColor() );
-    ShadowShader->uniform4fv( shadow::Material + m::SpecularColor, PandaObject->getSpecularReflectionColor() );
-    ShadowShader->uniform1f( shadow::Material + m::SpecularExponent, PandaObject->getSpecularReflectionExponent() );
+        scale( glm::mat4( 1.0f ), glm::vec3( 20.0f ) ) *
+        PandaObject->getDequantizationMatrix();
+    draw = DrawData->addDraw( *PandaObject, to_world, view_matrix, projection_matrix );
     glBindTextureUnit( 0, PandaObject->getTextureID( 0 ) );
-    glBindVertexArray( PandaObject->getVAO() );
-    glDrawArrays( PandaObject->getDrawMode(), 0, PandaObject->getVertexNum() );
+    GeometryArena->drawMesh( PandaMesh, draw );
 
     to_world =
         translate( glm::mat4( 1.0f ), glm::vec3( 0.0f, 0.0f, 512.0f ) ) *
         rotate( glm::mat4( 1.0f ), glm::radians( -90.0f ), glm::vec3( 1.0f, 0.0f, 0.0f ) ) *
         scale( glm::mat4( 1.0f ), glm::vec3( 512.0f ) );
-    ShadowShader->uniformMat4fv( shadow::WorldMatrix, to_world );
-    ShadowShader->uniformMat4fv( shadow::ViewMatrix, MainCamera->getViewMatrix() );
-    ShadowShader->uniformMat4fv(
-        shadow::ModelViewProjectionMatrix,
-        MainCamera->getProjectionMatrix() * MainCamera->getViewMatrix() * to_world
-    );
-    ShadowShader->uniform4fv( shadow::Material + m::EmissionColor, GroundObject->getEmissionColor() );
-    ShadowShader->uniform4fv( shadow::Material + m::AmbientColor, GroundObject->getAmbientReflectionColor() );
-    ShadowShader->uniform4fv( shadow::Material + m::DiffuseColor, GroundObject->getDiffuseReflectionColor() );
-    ShadowShader->uniform4fv( shadow::Material + m::SpecularColor, GroundObject->getSpecularReflectionColor() );
-    ShadowShader->uniform1f( shadow::Material + m::SpecularExponent, GroundObject->getSpecularReflectionExponent() );
+    draw = DrawData->addDraw( *GroundObject, to_world, view_matrix, projection_matrix );
     glBindTextureUnit( 0, GroundObject->getTextureID( 0 ) );
-    glBindVertexArray( GroundObject->getVAO() );
-    glDrawArrays( GroundObject->getDrawMode(), 0, GroundObject->getVertexNum() );
+    GeometryArena->drawMesh( GroundMesh, draw );
 }
 
 void C10ShadowMapping::render() const
@@ -274,6 +228,14 @@ void C10ShadowMapping::render() const
     const float light_x = 1024.0f * std::cos( LightTheta ) + 256.0f;
     const float light_z = 1024.0f * std::sin( LightTheta ) + 256.0f;
     Lights->setLightPosition( glm::vec4( light_x, 200.0f, light_z, 1.0f ), 0 );
+    Lights->updateLightBuffer( MainCamera->getViewMatrix() );
+    DrawData->beginFrame();
+
+    // The arena copies the meshes from their buffers, so nothing is drawn until all the assets are uploaded.
+    if (!GeometryArena) {
+        glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+        return;
+    }
 
     drawDepthMapFromLightView( 0 );
     drawShadow( 0 );
@@ -283,13 +245,25 @@ void C10ShadowMapping::play()
 {
     if (glfwWindowShouldClose( Window )) initialize();
 
+    // The window shows up right away, and the meshes and textures stream in while the scene waits for them.
+    AssetLoader loader;
+    AssetsLoaded.clear();
+    GeometryArena.reset();
     setLights();
-    setGroundObject();
-    setTigerObject();
-    setPandaObject();
+    setGroundObject( loader );
+    setTigerObject( loader );
+    setPandaObject( loader );
     setDepthFrameBuffer();
+    ShaderGL::reportProgramSetup();
 
     while (!glfwWindowShouldClose( Window )) {
+        if (!loader.isIdle()) {
+            loader.uploadPending();
+            if (loader.isIdle()) {
+                if (!isEverythingLoaded()) throw std::runtime_error( "Could not load the assets!" );
+                setGeometryArena();
+            }
+        }
         render();
 
         LightTheta += 0.01f;
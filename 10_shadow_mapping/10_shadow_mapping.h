@@ -2,29 +2,21 @@
 
 #include "../common/include/renderer.h"
 #include "../common/include/shader.h"
+#include "../common/include/geometry_arena.h"
+#include "../common/include/asset_loader.h"
 
 namespace shadow
 {
+    // The transforms and the material of a draw come from DrawDataGL.
     enum UNIFORM
     {
-        WorldMatrix = 0,
-        ViewMatrix,
-        ModelViewProjectionMatrix,
-        LightViewProjectionMatrix,
-        Lights,
-        Material = 292,
-        UseTexture = 297,
+        LightViewProjectionMatrix = 3,
+        UseTexture = 9,
         UseLight,
-        LightIndex,
-        GlobalAmbient
+        LightIndex
     };
 }
 
-namespace simple
-{
-    enum UNIFORM { ModelViewProjectionMatrix = 0 };
-}
-
 class C10ShadowMapping final : public RendererGL
 {
 public:
@@ -40,8 +32,12 @@ public:
 
 private:
     float LightTheta = 0.0f;
+    int GroundMesh = -1;
+    int TigerMesh = -1;
+    int PandaMesh = -1;
     GLuint FBO = 0;
     GLuint DepthTextureID = 0;
+    std::vector<std::shared_future<bool>> AssetsLoaded;
     std::unique_ptr<CameraGL> LightCamera = std::make_unique<CameraGL>();
     std::unique_ptr<ShaderGL> ObjectShader = std::make_unique<ShaderGL>();
     std::unique_ptr<ShaderGL> ShadowShader = std::make_unique<ShaderGL>();
@@ -49,13 +45,17 @@ private:
     std::unique_ptr<ObjectGL> TigerObject = std::make_unique<ObjectGL>();
     std::unique_ptr<ObjectGL> PandaObject = std::make_unique<ObjectGL>();
     std::unique_ptr<LightGL> Lights = std::make_unique<LightGL>();
+    std::unique_ptr<DrawDataGL> DrawData = std::make_unique<DrawDataGL>();
+    std::unique_ptr<GeometryArenaGL> GeometryArena;
 
     void keyboard(GLFWwindow* window, int key, int scancode, int action, int mods) override;
     void setLights() const;
-    void setGroundObject() const;
-    void setTigerObject() const;
-    void setPandaObject() const;
+    void setGroundObject(AssetLoader& loader);
+    void setTigerObject(AssetLoader& loader);
+    void setPandaObject(AssetLoader& loader);
+    [[nodiscard]] bool isEverythingLoaded() const;
     void setDepthFrameBuffer();
+    void setGeometryArena();
     void drawDepthMapFromLightView(int light_index) const;
     void drawShadow(int light_index) const;
     void render() const;
@@ -1,10 +1,10 @@
 #version 460
 
-uniform mat4 ModelViewProjectionMatrix;
+#include "draw_data.glsl"
 
 layout (location = 0) in vec3 v_position;
 
 void main()
 {
-    gl_Position = ModelViewProjectionMatrix * vec4(v_position, 1.0f);
+    gl_Position = Draws[gl_BaseInstance].ModelViewProjectionMatrix * vec4(v_position, 1.0f);
 }
\ No newline at end of file
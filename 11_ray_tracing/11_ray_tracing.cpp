@@ -5,6 +5,7 @@ C11RayTracing::C11RayTracing()
     MainCamera = std::make_unique<CameraGL>( FrameWidth, FrameHeight );
 
     const std::string shader_directory_path = std::string( CMAKE_SOURCE_DIR ) + "/11_ray_tracing/shaders";
+    RayTracingShader->addDefine( "THREAD_GROUP_SIZE", ThreadGroupSize );
     RayTracingShader->setComputeShader( std::string( shader_directory_path + "/raytracer.comp" ).c_str() );
     ScreenShader->setShader(
         std::string( shader_directory_path + "/screen.vert" ).c_str(),
@@ -80,6 +81,7 @@ void C11RayTracing::play()
         { Sphere::TYPE::METAL, 0.5f, glm::vec3( -1.0f, 0.0f, -1.0f ), glm::vec3( 0.8f, 0.8f, 0.8f ) }
     };
     ScreenObject->setSquareObject( GL_TRIANGLES, true );
+    ShaderGL::reportProgramSetup();
 
     constexpr double update_time = 0.1;
     double last = glfwGetTime(), time_delta = 0.0;
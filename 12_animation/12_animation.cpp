@@ -12,6 +12,12 @@ C12Animation::C12Animation()
     glClearColor( 1.0f, 1.0f, 1.0f, 1.0f );
 }
 
+C12Animation::~C12Animation()
+{
+    if (DrawBuffer != 0)
+        glDeleteBuffers( 1, &DrawBuffer );
+}
+
 void C12Animation::keyboard(GLFWwindow* window, int key, int scancode, int action, int mods)
 {
     if (action != GLFW_PRESS) return;
@@ -80,34 +86,51 @@ void C12Animation::setObjects()
     Animator->addKeyframe( getEndKeyframe() );
 
     Objects.clear();
+    Meshes.clear();
+    GeometryArena = std::make_unique<GeometryArenaGL>( 1 << 16, 1 << 12 );
     const int key_frame_num = Animator->getTotalKeyframesNum();
     for (int i = 0; i < key_frame_num; ++i) {
         Objects.emplace_back( std::make_unique<ObjectGL>() );
         Objects[i]->setSquareObject( GL_TRIANGLES );
+        Meshes.emplace_back( GeometryArena->addMesh( *Objects[i] ) );
     }
+
+    if (DrawBuffer != 0)
+        glDeleteBuffers( 1, &DrawBuffer );
+    glCreateBuffers( 1, &DrawBuffer );
+    glNamedBufferStorage( DrawBuffer, sizeof( DrawData ) * key_frame_num, nullptr, GL_DYNAMIC_STORAGE_BIT );
+    Draws.resize( key_frame_num );
 }
 
-void C12Animation::render() const
+void C12Animation::render()
 {
     glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
     glUseProgram( ObjectShader->getShaderProgram() );
     const auto current_time = static_cast<float>(glfwGetTime() * 1000.0 - StartTiming);
-    for (int i = 0; i < Animator->getTotalKeyframesNum(); ++i) {
-        const GLenum fill_type = Animator->getFillType( i );
-        glPolygonMode( GL_FRONT_AND_BACK, fill_type );
-
+    const int key_frame_num = Animator->getTotalKeyframesNum();
+    for (int i = 0; i < key_frame_num; ++i) {
         Animator2D::Animation animation;
         Animator->getAnimationNow( animation, i, current_time );
 
         const glm::mat4 to_world = Animator->getWorldMatrix( animation, FrameHeight, i );
-        ObjectShader->uniformMat4fv(
-            ModelViewProjectionMatrix,
-            MainCamera->getProjectionMatrix() * MainCamera->getViewMatrix() * to_world
-        );
-        ObjectShader->uniform3fv( Color, animation.Color );
-        glBindVertexArray( Objects[i]->getVAO() );
-        glDrawArrays( Objects[i]->getDrawMode(), 0, Objects[i]->getVertexNum() );
+        Draws[i].ModelViewProjectionMatrix =
+            MainCamera->getProjectionMatrix() * MainCamera->getViewMatrix() * to_world;
+        Draws[i].Color = glm::vec4( animation.Color, 1.0f );
+    }
+    glNamedBufferSubData( DrawBuffer, 0, static_cast<GLsizeiptr>(sizeof( DrawData ) * Draws.size()), Draws.data() );
+    glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 0, DrawBuffer );
+
+    // The polygon mode cannot change within a draw call, so the keyframes of the same fill type in a row are drawn
+    // together, which is all of them in one call when they fill alike.
+    for (int i = 0; i < key_frame_num; ++i) {
+        const GLenum fill_type = Animator->getFillType( i );
+        if (i == 0 || fill_type != Animator->getFillType( i - 1 )) {
+            GeometryArena->submitDraws();
+            glPolygonMode( GL_FRONT_AND_BACK, fill_type );
+        }
+        GeometryArena->addDraw( Meshes[i], static_cast<GLuint>(i) );
     }
+    GeometryArena->submitDraws();
 }
 
 void C12Animation::play()
@@ -115,6 +138,7 @@ void C12Animation::play()
     if (glfwWindowShouldClose( Window )) initialize();
 
     setObjects();
+    ShaderGL::reportProgramSetup();
 
     StartTiming = glfwGetTime() * 1000.0;
     while (!glfwWindowShouldClose( Window )) {
@@ -2,13 +2,14 @@
 
 #include "../common/include/renderer.h"
 #include "../common/include/shader.h"
+#include "../common/include/geometry_arena.h"
 #include "animator.h"
 
 class C12Animation final : public RendererGL
 {
 public:
     C12Animation();
-    ~C12Animation() override = default;
+    ~C12Animation() override;
 
     C12Animation(C12Animation&&) = delete;
     C12Animation(const C12Animation&) = delete;
@@ -18,19 +19,28 @@ public:
     void play();
 
 private:
-    enum UNIFORM { ModelViewProjectionMatrix = 0, Color };
+    // Matches the std430 layout of the draws in shader.vert.
+    struct DrawData
+    {
+        glm::mat4 ModelViewProjectionMatrix;
+        glm::vec4 Color;
+    };
 
     double StartTiming = 0.0;
+    GLuint DrawBuffer = 0;
+    std::vector<int> Meshes;
+    std::vector<DrawData> Draws;
     std::unique_ptr<ShaderGL> ObjectShader = std::make_unique<ShaderGL>();
     std::vector<std::unique_ptr<ObjectGL>> Objects;
     std::unique_ptr<Animator2D> Animator = std::make_unique<Animator2D>();
+    std::unique_ptr<GeometryArenaGL> GeometryArena;
 
     void cursor(GLFWwindow* window, double xpos, double ypos) override {}
     void mouse(GLFWwindow* window, int button, int action, int mods) override {}
     void mousewheel(GLFWwindow* window, double xoffset, double yoffset) const override {}
     void keyboard(GLFWwindow* window, int key, int scancode, int action, int mods) override;
     void setObjects();
-    void render() const;
+    void render();
     [[nodiscard]] static Animator2D::Keyframe getStartKeyframe();
     [[nodiscard]] static Animator2D::Keyframe getEndKeyframe();
 };
\ No newline at end of file
@@ -1,10 +1,10 @@
 #version 460
 
-layout (location = 1) uniform vec3 Color;
+flat in vec3 color;
 
 layout (location = 0) out vec4 final_color;
 
 void main()
 {
-    final_color = vec4(Color, 1.0f);
+    final_color = vec4(color, 1.0f);
 }
\ No newline at end of file
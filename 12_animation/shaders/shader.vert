@@ -1,10 +1,18 @@
 #version 460
 
-layout (location = 0) uniform mat4 ModelViewProjectionMatrix;
+struct DrawInfo
+{
+    mat4 ModelViewProjectionMatrix;
+    vec4 Color;
+};
+layout (binding = 0, std430) readonly buffer Draws { DrawInfo Draw[]; };
 
 layout (location = 0) in vec3 v_position;
 
+flat out vec3 color;
+
 void main()
 {
-    gl_Position = ModelViewProjectionMatrix * vec4(v_position, 1.0f);
+    color = Draw[gl_BaseInstance].Color.rgb;
+    gl_Position = Draw[gl_BaseInstance].ModelViewProjectionMatrix * vec4(v_position, 1.0f);
 }
\ No newline at end of file
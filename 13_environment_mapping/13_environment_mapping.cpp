@@ -11,10 +11,16 @@ C13EnvironmentMapping::C13EnvironmentMapping()
     MainCamera->update3DCamera( FrameWidth, FrameHeight );
 
     const std::string shader_directory_path = std::string( CMAKE_SOURCE_DIR ) + "/13_environment_mapping/shaders";
+    ObjectShader->addDefine( "MAX_LIGHTS", LightGL::MaxLightNum );
     ObjectShader->setShader(
         std::string( shader_directory_path + "/lighting.vert" ).c_str(),
         std::string( shader_directory_path + "/lighting.frag" ).c_str()
     );
+    MorphShader->addDefine( "MAX_LIGHTS", LightGL::MaxLightNum );
+    MorphShader->setShader(
+        std::string( shader_directory_path + "/morph_lighting.vert" ).c_str(),
+        std::string( shader_directory_path + "/lighting.frag" ).c_str()
+    );
     EnvironmentShader->setShader(
         std::string( shader_directory_path + "/environment_map.vert" ).c_str(),
         std::string( shader_directory_path + "/environment_map.frag" ).c_str()
@@ -61,7 +67,7 @@ void C13EnvironmentMapping::keyboard(GLFWwindow* window, int key, int scancode,
             std::cout << "Light Turned " << (Lights->isLightOn() ? "On!\n" : "Off!\n");
             break;
         case GLFW_KEY_ENTER:
-            if (Lights->isLightOn()) {
+            if (Lights->isLightOn() && Lights->getTotalLightNum() > 0) {
                 ActivatedLightIndex++;
                 if (ActivatedLightIndex == Lights->getTotalLightNum()) ActivatedLightIndex = 0;
                 std::cout << "Activate Light " << ActivatedLightIndex << "\n";
@@ -292,12 +298,8 @@ std::vector<glm::ivec2> C13EnvironmentMapping::estimateLightPoints()
     return light_points;
 }
 
-void C13EnvironmentMapping::findLightsFromImage()
+void C13EnvironmentMapping::findLightsFromImage(const std::vector<glm::ivec2>& light_points) const
 {
-    convertFisheye( std::string( CMAKE_SOURCE_DIR ) + "/13_environment_mapping/samples/fisheye/sky.jpg" );
-
-    std::vector<glm::ivec2> light_points = estimateLightPoints();
-
     constexpr float color_scale = 1.0f / 255.0f;
     const float width_scale = glm::two_pi<float>() / static_cast<float>(EnvironmentWidth - 1);
     const float height_scale = glm::pi<float>() / static_cast<float>(EnvironmentHeight - 1);
@@ -323,178 +325,138 @@ void C13EnvironmentMapping::findLightsFromImage()
     }
 }
 
-void C13EnvironmentMapping::setEnvironmentObject() const
+void C13EnvironmentMapping::setEnvironment(AssetLoader& loader)
+{
+    // The image is converted and cut on a worker thread, and it is not touched here until the request is uploaded.
+    auto light_points = std::make_shared<std::vector<glm::ivec2>>();
+    EnvironmentLoaded = loader.request(
+        [this, light_points]()
+        {
+            convertFisheye( std::string( CMAKE_SOURCE_DIR ) + "/13_environment_mapping/samples/fisheye/sky.jpg" );
+            *light_points = estimateLightPoints();
+            return true;
+        },
+        [this, light_points]()
+        {
+            findLightsFromImage( *light_points );
+            for (auto* object : { EnvironmentObject.get(), CowObject.get(), MovingTigerObject.get() }) {
+                object->addSharedTexture( ImageBuffer, EnvironmentWidth, EnvironmentHeight );
+                object->setDiffuseReflectionColor( { 1.0f, 1.0f, 1.0f, 1.0f } );
+            }
+            return true;
+        }
+    );
+}
+
+void C13EnvironmentMapping::setEnvironmentObject(AssetLoader& loader)
 {
-    std::vector<glm::vec3> hemisphere_vertices;
     const std::string sample_directory_path = std::string( CMAKE_SOURCE_DIR ) + "/13_environment_mapping/samples";
-    if (ObjectGL::readObjectFile(
-        hemisphere_vertices,
-        std::string( sample_directory_path + "/objects/hemisphere.obj" )
-    )) {
-        EnvironmentObject->setObject( GL_TRIANGLES, hemisphere_vertices );
-        EnvironmentObject->addTexture( ImageBuffer, EnvironmentWidth, EnvironmentHeight );
-        EnvironmentObject->setDiffuseReflectionColor( { 1.0f, 1.0f, 1.0f, 1.0f } );
-    }
-    else throw std::runtime_error( "Could not read text file!" );
+    EnvironmentObjectLoaded = loader.requestMesh(
+        *EnvironmentObject,
+        GL_TRIANGLES,
+        sample_directory_path + "/objects/hemisphere.obj"
+    );
 }
 
-void C13EnvironmentMapping::setMovingTigerObjects()
+void C13EnvironmentMapping::setMovingTigerObject(AssetLoader& loader)
 {
-    MovingTigerObjects.clear();
+    // The frames share the polygons, so they are kept as one base mesh and the deltas of the other frames,
+    // which the vertex shader blends to give the poses in between.
     const std::string sample_directory_path = std::string( CMAKE_SOURCE_DIR ) + "/13_environment_mapping/samples";
-    for (int t = 0; t < 12; ++t) {
-        std::vector<glm::vec3> tiger_vertices, tiger_normals;
-        std::vector<glm::vec2> tiger_textures;
-        if (ObjectGL::readTextFile(
-            tiger_vertices,
-            tiger_normals,
-            tiger_textures,
-            sample_directory_path + "/objects/tiger" + std::to_string( t ) + ".txt"
-        )) {
-            MovingTigerObjects.emplace_back( std::make_unique<ObjectGL>() );
-            MovingTigerObjects[t]->setObject( GL_TRIANGLES, tiger_vertices, tiger_normals );
-            MovingTigerObjects[t]->addTexture( ImageBuffer, EnvironmentWidth, EnvironmentHeight );
-            MovingTigerObjects[t]->setDiffuseReflectionColor( { 1.0f, 1.0f, 1.0f, 1.0f } );
-        }
-        else throw std::runtime_error( "Could not read text file!" );
+    std::vector<std::string> frame_paths;
+    for (int t = 0; t < TigerFrameNum; ++t) {
+        frame_paths.emplace_back( sample_directory_path + "/objects/tiger" + std::to_string( t ) + ".txt" );
     }
+    MovingTigerLoaded = loader.requestMorphObject( *MovingTigerObject, GL_TRIANGLES, frame_paths );
 }
 
-void C13EnvironmentMapping::setCowObject() const
+void C13EnvironmentMapping::setCowObject(AssetLoader& loader)
 {
-    std::vector<glm::vec3> cow_vertices, cow_normals;
     const std::string sample_directory_path = std::string( CMAKE_SOURCE_DIR ) + "/13_environment_mapping/samples";
-    if (ObjectGL::readTextFile(
-        cow_vertices,
-        cow_normals,
-        sample_directory_path + "/objects/cow.txt"
-    )) {
-        CowObject->setObject( GL_TRIANGLES, cow_vertices, cow_normals );
-        CowObject->addTexture( ImageBuffer, EnvironmentWidth, EnvironmentHeight );
-        CowObject->setDiffuseReflectionColor( { 1.0f, 1.0f, 1.0f, 1.0f } );
-    }
-    else throw std::runtime_error( "Could not read text file!" );
+    CowLoaded = loader.requestMesh( *CowObject, GL_TRIANGLES, sample_directory_path + "/objects/cow.txt" );
 }
 
-void C13EnvironmentMapping::drawMovingTiger(float scale_factor) const
+bool C13EnvironmentMapping::isEverythingLoaded() const
 {
-    using l = ShaderGL::LIGHT_UNIFORM;
-    using m = ShaderGL::MATERIAL_UNIFORM;
+    const std::array<std::shared_future<bool>, 4> all = {
+        EnvironmentLoaded, EnvironmentObjectLoaded, CowLoaded, MovingTigerLoaded
+    };
+    return std::all_of(
+        all.begin(), all.end(),
+        [](const std::shared_future<bool>& loaded) { return AssetLoader::isReady( loaded ); }
+    );
+}
 
-    glUseProgram( ObjectShader->getShaderProgram() );
-    const auto theta = static_cast<float>(TigerRotationAngle);
+void C13EnvironmentMapping::drawMovingTiger(float scale_factor) const
+{
+    glUseProgram( MorphShader->getShaderProgram() );
+    const float theta = TigerRotationAngle;
     const glm::mat4 to_world =
         translate( glm::mat4( 1.0f ), glm::vec3( 20.0f, 20.0f, -20.0f ) ) *
         rotate( glm::mat4( 1.0f ), glm::radians( theta ), glm::vec3( 0.0f, 1.0f, 0.0f ) ) *
         rotate( glm::mat4( 1.0f ), glm::radians( -90.0f ), glm::vec3( 1.0f, 0.0f, 0.0f ) ) *
         scale( glm::mat4( 1.0f ), glm::vec3( scale_factor, scale_factor, scale_factor ) );
-    ObjectShader->uniformMat4fv( lighting::WorldMatrix, to_world );
-    ObjectShader->uniformMat4fv( lighting::ViewMatrix, MainCamera->getViewMatrix() );
-    ObjectShader->uniformMat4fv(
-        lighting::ModelViewProjectionMatrix,
-        MainCamera->getProjectionMatrix() * MainCamera->getViewMatrix() * to_world
-    );
-    ObjectShader->uniform3fv( lighting::ActivatedLightPosition, Lights->getPosition( ActivatedLightIndex ) );
-    ObjectShader->uniform1i( lighting::UseLight, Lights->isLightOn() ? 1 : 0 );
-    ObjectShader->uniform1i( lighting::LightIndex, ActivatedLightIndex );
-    if (Lights->isLightOn()) {
-        const int offset = lighting::Lights + l::UniformNum * ActivatedLightIndex;
-        ObjectShader->uniform1i( offset + l::LightSwitch, Lights->isActivated( ActivatedLightIndex ) ? 1 : 0 );
-        ObjectShader->uniform4fv( offset + l::LightPosition, Lights->getPosition( ActivatedLightIndex ) );
-        ObjectShader->uniform4fv( offset + l::LightAmbientColor, Lights->getAmbientColors( ActivatedLightIndex ) );
-        ObjectShader->uniform4fv( offset + l::LightDiffuseColor, Lights->getDiffuseColors( ActivatedLightIndex ) );
-        ObjectShader->uniform4fv( offset + l::LightSpecularColor, Lights->getSpecularColors( ActivatedLightIndex ) );
-        ObjectShader->uniform3fv(
-            offset + l::SpotlightDirection,
-            Lights->getSpotlightDirections( ActivatedLightIndex )
-        );
-        ObjectShader->uniform1f(
-            offset + l::SpotlightCutoffAngle,
-            Lights->getSpotlightCutoffAngles( ActivatedLightIndex )
-        );
-        ObjectShader->uniform1f( offset + l::SpotlightFeather, Lights->getSpotlightFeathers( ActivatedLightIndex ) );
-        ObjectShader->uniform1f( offset + l::FallOffRadius, Lights->getFallOffRadii( ActivatedLightIndex ) );
-        ObjectShader->uniform4fv( lighting::GlobalAmbient, Lights->getGlobalAmbientColor() );
-    }
-    ObjectShader->uniform4fv(
-        lighting::Material + m::EmissionColor,
-        MovingTigerObjects[TigerIndex]->getEmissionColor()
-    );
-    ObjectShader->uniform4fv(
-        lighting::Material + m::AmbientColor,
-        MovingTigerObjects[TigerIndex]->getAmbientReflectionColor()
+    const GLuint draw = DrawData->addDraw(
+        *MovingTigerObject, to_world, MainCamera->getViewMatrix(), MainCamera->getProjectionMatrix()
     );
-    ObjectShader->uniform4fv(
-        lighting::Material + m::DiffuseColor,
-        MovingTigerObjects[TigerIndex]->getDiffuseReflectionColor()
+    MorphShader->uniform3fv( lighting::ActivatedLightPosition, Lights->getPosition( ActivatedLightIndex ) );
+    MorphShader->uniform1i( lighting::UseLight, Lights->isLightOn() ? 1 : 0 );
+    MorphShader->uniform1i( lighting::LightIndex, ActivatedLightIndex );
+    MorphShader->uniform1f( lighting::EnvironmentRadius, EnvironmentRadius );
+
+    const int frame_num = MovingTigerObject->getMorphFrameNum();
+    const auto frame = static_cast<int>(TigerFrame) % frame_num;
+    MorphShader->uniform1i( lighting::MorphVertexNum, MovingTigerObject->getVertexNum() );
+    MorphShader->uniform2iv( lighting::MorphFrames, glm::ivec2( frame, (frame + 1) % frame_num ) );
+    MorphShader->uniform1f( lighting::MorphWeight, TigerFrame - std::floor( TigerFrame ) );
+    glBindBufferBase( GL_SHADER_STORAGE_BUFFER, 0, MovingTigerObject->getMorphTargetBuffer() );
+    glBindTextureUnit( 0, MovingTigerObject->getTextureID( 0 ) );
+    glBindVertexArray( MovingTigerObject->getVAO() );
+    glDrawElementsInstancedBaseInstance(
+        MovingTigerObject->getDrawMode(), MovingTigerObject->getIndexNum(), GL_UNSIGNED_INT, nullptr, 1, draw
     );
-    ObjectShader->uniform4fv(
-        lighting::Material + m::SpecularColor,
-        MovingTigerObjects[TigerIndex]->getSpecularReflectionColor()
-    );
-    ObjectShader->uniform1f(
-        lighting::Material + m::SpecularExponent,
-        MovingTigerObjects[TigerIndex]->getSpecularReflectionExponent()
-    );
-    ObjectShader->uniform1f( lighting::EnvironmentRadius, EnvironmentRadius );
-    glBindTextureUnit( 0, MovingTigerObjects[TigerIndex]->getTextureID( 0 ) );
-    glBindVertexArray( MovingTigerObjects[TigerIndex]->getVAO() );
-    glDrawArrays( MovingTigerObjects[TigerIndex]->getDrawMode(), 0, MovingTigerObjects[TigerIndex]->getVertexNum() );
 }
 
 void C13EnvironmentMapping::drawCow(float scale_factor) const
 {
-    using l = ShaderGL::LIGHT_UNIFORM;
-    using m = ShaderGL::MATERIAL_UNIFORM;
-
     glUseProgram( ObjectShader->getShaderProgram() );
     const glm::mat4 to_world =
         translate( glm::mat4( 1.0f ), glm::vec3( 0.0f, 15.0f, 0.0f ) ) *
         rotate( glm::mat4( 1.0f ), glm::radians( 90.0f ), glm::vec3( 0.0f, 1.0f, 0.0f ) ) *
         scale( glm::mat4( 1.0f ), glm::vec3( scale_factor, scale_factor, scale_factor ) );
-    ObjectShader->uniformMat4fv( lighting::WorldMatrix, to_world );
-    ObjectShader->uniformMat4fv( lighting::ViewMatrix, MainCamera->getViewMatrix() );
-    ObjectShader->uniformMat4fv(
-        lighting::ModelViewProjectionMatrix,
-        MainCamera->getProjectionMatrix() * MainCamera->getViewMatrix() * to_world
+    const GLuint draw = DrawData->addDraw(
+        *CowObject, to_world, MainCamera->getViewMatrix(), MainCamera->getProjectionMatrix()
     );
     ObjectShader->uniform3fv( lighting::ActivatedLightPosition, Lights->getPosition( ActivatedLightIndex ) );
     ObjectShader->uniform1i( lighting::UseLight, Lights->isLightOn() ? 1 : 0 );
     ObjectShader->uniform1i( lighting::LightIndex, ActivatedLightIndex );
-    if (Lights->isLightOn()) {
-        const int offset = lighting::Lights + l::UniformNum * ActivatedLightIndex;
-        ObjectShader->uniform1i( offset + l::LightSwitch, Lights->isActivated( ActivatedLightIndex ) ? 1 : 0 );
-        ObjectShader->uniform4fv( offset + l::LightPosition, Lights->getPosition( ActivatedLightIndex ) );
-        ObjectShader->uniform4fv( offset + l::LightAmbientColor, Lights->getAmbientColors( ActivatedLightIndex ) );
-        ObjectShader->uniform4fv( offset + l::LightDiffuseColor, Lights->getDiffuseColors( ActivatedLightIndex ) );
-        ObjectShader->uniform4fv( offset + l::LightSpecularColor, Lights->getSpecularColors( ActivatedLightIndex ) );
-        ObjectShader->uniform3fv(
-            offset + l::SpotlightDirection,
-            Lights->getSpotlightDirections( ActivatedLightIndex )
-        );
-        ObjectShader->uniform1f(
-            offset + l::SpotlightCutoffAngle,
-            Lights->getSpotlightCutoffAngles( ActivatedLightIndex )
-        );
-        ObjectShader->uniform1f( offset + l::SpotlightFeather, Lights->getSpotlightFeathers( ActivatedLightIndex ) );
-        ObjectShader->uniform1f( offset + l::FallOffRadius, Lights->getFallOffRadii( ActivatedLightIndex ) );
-        ObjectShader->uniform4fv( lighting::GlobalAmbient, Lights->getGlobalAmbientColor() );
-    }
-    ObjectShader->uniform4fv( lighting::Material + m::EmissionColor, CowObject->getEmissionColor() );
-    ObjectShader->uniform4fv( lighting::Material + m::AmbientColor, CowObject->getAmbientReflectionColor() );
-    ObjectShader->uniform4fv( lighting::Material + m::DiffuseColor, CowObject->getDiffuseReflectionColor() );
-    ObjectShader->uniform4fv( lighting::Material + m::SpecularColor, CowObject->getSpecularReflectionColor() );
-    ObjectShader->uniform1f( lighting::Material + m::SpecularExponent, CowObject->getSpecularReflectionExponent() );
     ObjectShader->uniform1f( lighting::EnvironmentRadius, EnvironmentRadius );
     glBindTextureUnit( 0, CowObject->getTextureID( 0 ) );
     glBindVertexArray( CowObject->getVAO() );
-    glDrawArrays( CowObject->getDrawMode(), 0, CowObject->getVertexNum() );
+    glDrawElementsInstancedBaseInstance(
+        CowObject->getDrawMode(), CowObject->getIndexNum(), GL_UNSIGNED_INT, nullptr, 1, draw
+    );
 }
 
 void C13EnvironmentMapping::render() const
 {
     glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
 
+    // Nothing has its texture or lights until the environment is uploaded.
+    if (!AssetLoader::isReady( EnvironmentLoaded )) return;
+
+    Lights->updateLightBuffer( MainCamera->getViewMatrix() );
+    DrawData->beginFrame();
+
+    if (AssetLoader::isReady( EnvironmentObjectLoaded )) drawEnvironment();
+    if (DrawMovingObject) {
+        if (AssetLoader::isReady( MovingTigerLoaded )) drawMovingTiger( 0.05f );
+    }
+    else if (AssetLoader::isReady( CowLoaded )) drawCow( 7.0f );
+}
+
+void C13EnvironmentMapping::drawEnvironment() const
+{
     glUseProgram( EnvironmentShader->getShaderProgram() );
     const glm::mat4 to_world =
         rotate( glm::mat4( 1.0f ), glm::radians( -90.0f ), glm::vec3( 1.0f, 0.0f, 0.0f ) ) *
@@ -507,19 +469,16 @@ void C13EnvironmentMapping::render() const
     EnvironmentShader->uniform1f( environment_mappint::EnvironmentRadius, EnvironmentRadius );
     glBindTextureUnit( 0, EnvironmentObject->getTextureID( 0 ) );
     glBindVertexArray( EnvironmentObject->getVAO() );
-    glDrawArrays( EnvironmentObject->getDrawMode(), 0, EnvironmentObject->getVertexNum() );
-
-    if (DrawMovingObject) drawMovingTiger( 0.05f );
-    else drawCow( 7.0f );
+    glDrawElements( EnvironmentObject->getDrawMode(), EnvironmentObject->getIndexNum(), GL_UNSIGNED_INT, nullptr );
 }
 
-void C13EnvironmentMapping::update()
+void C13EnvironmentMapping::update(double elapsed_time)
 {
     if (DrawMovingObject) {
-        TigerIndex++;
-        if (TigerIndex == 12) TigerIndex = 0;
-        TigerRotationAngle += 3;
-        if (TigerRotationAngle == 360) TigerRotationAngle = 0;
+        // A frame of the tiger lasts TigerFrameTime, and the poses in between are blended by the fraction.
+        const auto frames = static_cast<float>(elapsed_time / TigerFrameTime);
+        TigerFrame = std::fmod( TigerFrame + frames, static_cast<float>(TigerFrameNum) );
+        TigerRotationAngle = std::fmod( TigerRotationAngle + 3.0f * frames, 360.0f );
     }
 }
 
@@ -527,25 +486,37 @@ void C13EnvironmentMapping::play()
 {
     if (glfwWindowShouldClose( Window )) initialize();
 
-    findLightsFromImage();
-    setEnvironmentObject();
-    setMovingTigerObjects();
-    setCowObject();
-
-    constexpr double update_time = 0.2;
-    double last = glfwGetTime(), time_delta = 0.0;
+    const double start_time = glfwGetTime();
+    // The window shows up right away, and the assets stream in as the loader uploads a few of them every frame.
+    AssetLoader loader;
+    setMovingTigerObject( loader );
+    setEnvironment( loader );
+    setEnvironmentObject( loader );
+    setCowObject( loader );
+    ShaderGL::reportProgramSetup();
+
+    double last = glfwGetTime();
+    bool first_frame = true;
     while (!glfwWindowShouldClose( Window )) {
         const double now = glfwGetTime();
-        time_delta += now - last;
+        update( now - last );
         last = now;
-        if (time_delta >= update_time) {
-            update();
-            time_delta -= update_time;
-        }
 
+        if (!loader.isIdle()) {
+            loader.uploadPending();
+            if (loader.isIdle()) {
+                if (!isEverythingLoaded()) throw std::runtime_error( "Could not load the assets!" );
+                std::cout << ">> Time to all assets: " << (glfwGetTime() - start_time) * 1000.0 << " ms\n";
+                TextureCache::getInstance().printStatistics();
+            }
+        }
         render();
 
         glfwSwapBuffers( Window );
+        if (first_frame) {
+            std::cout << ">> Time to first frame: " << (glfwGetTime() - start_time) * 1000.0 << " ms\n";
+            first_frame = false;
+        }
         glfwPollEvents();
     }
     glfwDestroyWindow( Window );
@@ -2,6 +2,7 @@
 
 #include "../common/include/renderer.h"
 #include "../common/include/shader.h"
+#include "../common/include/asset_loader.h"
 
 namespace environment_mappint
 {
@@ -10,18 +11,16 @@ namespace environment_mappint
 
 namespace lighting
 {
+    // The transforms and the material of a draw come from DrawDataGL.
     enum UNIFORM
     {
-        WorldMatrix = 0,
-        ViewMatrix,
-        ModelViewProjectionMatrix,
-        ActivatedLightPosition,
-        Lights,
-        Material = 292,
-        UseLight = 297,
+        ActivatedLightPosition = 3,
+        UseLight = 9,
         LightIndex,
         EnvironmentRadius,
-        GlobalAmbient
+        MorphVertexNum,
+        MorphFrames,
+        MorphWeight
     };
 }
 
@@ -48,10 +47,13 @@ private:
         Rect(int x, int y, int w, int h) : TopLeft( x, y ), Size( w, h ) {}
     };
 
+    static constexpr int TigerFrameNum = 12;
+    static constexpr double TigerFrameTime = 0.2;
+
     bool DrawMovingObject = false;
     int ActivatedLightIndex = 0;
-    int TigerIndex = 0;
-    int TigerRotationAngle = 180;
+    float TigerFrame = 0.0f;
+    float TigerRotationAngle = 180.0f;
     int EnvironmentWidth = 0;
     int EnvironmentHeight = 0;
     float EnvironmentRadius = 50.0f;
@@ -59,11 +61,17 @@ private:
     uint8_t* ImageBuffer = nullptr;
     uint8_t* LatitudeLongitude = nullptr;
     std::unique_ptr<ShaderGL> ObjectShader = std::make_unique<ShaderGL>();
+    std::unique_ptr<ShaderGL> MorphShader = std::make_unique<ShaderGL>();
     std::unique_ptr<ShaderGL> EnvironmentShader = std::make_unique<ShaderGL>();
     std::unique_ptr<ObjectGL> EnvironmentObject = std::make_unique<ObjectGL>();
     std::unique_ptr<ObjectGL> CowObject = std::make_unique<ObjectGL>();
-    std::vector<std::unique_ptr<ObjectGL>> MovingTigerObjects;
+    std::unique_ptr<ObjectGL> MovingTigerObject = std::make_unique<ObjectGL>();
     std::unique_ptr<LightGL> Lights = std::make_unique<LightGL>();
+    std::unique_ptr<DrawDataGL> DrawData = std::make_unique<DrawDataGL>();
+    std::shared_future<bool> EnvironmentLoaded;
+    std::shared_future<bool> EnvironmentObjectLoaded;
+    std::shared_future<bool> CowLoaded;
+    std::shared_future<bool> MovingTigerLoaded;
 
     // https://graphics.stanford.edu/%7Eseander/bithacks.html#RoundUpPowerOf2
     static constexpr uint getNextHighestPowerOf2(uint v)
@@ -98,12 +106,15 @@ private:
     ) const;
     void medianCut(std::map<float, glm::ivec2>& light_infos, const Rect& block, int iteration) const;
     [[nodiscard]] std::vector<glm::ivec2> estimateLightPoints();
-    void findLightsFromImage();
-    void setEnvironmentObject() const;
-    void setMovingTigerObjects();
-    void setCowObject() const;
+    void findLightsFromImage(const std::vector<glm::ivec2>& light_points) const;
+    void setEnvironment(AssetLoader& loader);
+    void setEnvironmentObject(AssetLoader& loader);
+    void setMovingTigerObject(AssetLoader& loader);
+    void setCowObject(AssetLoader& loader);
+    [[nodiscard]] bool isEverythingLoaded() const;
+    void drawEnvironment() const;
     void drawMovingTiger(float scale_factor) const;
     void drawCow(float scale_factor) const;
     void render() const;
-    void update();
+    void update(double elapsed_time);
 };
\ No newline at end of file
@@ -1,8 +1,7 @@
 #version 460
 
-layout (location = 0) uniform mat4 WorldMatrix;
-layout (location = 1) uniform mat4 ViewMatrix;
-layout (location = 2) uniform mat4 ModelViewProjectionMatrix;
+#include "draw_data.glsl"
+
 layout (location = 3) uniform vec3 ActivatedLightPosition;
 
 layout (location = 0) in vec3 v_position;
@@ -18,24 +17,27 @@ out vec3 normal_in_ec;
 out vec3 light_position_in_ec;
 
 out vec2 tex_coord;
+flat out int draw_index;
 
 void main()
 {
-    vec4 w_position = WorldMatrix * vec4(v_position, 1.0f);
-    vec4 w_normal = transpose( inverse( WorldMatrix ) ) * vec4(v_normal, 1.0f);
+    DrawInfo draw = Draws[gl_BaseInstance];
+    vec4 w_position = draw.WorldMatrix * vec4(v_position, 1.0f);
+    vec4 w_normal = transpose( inverse( draw.WorldMatrix ) ) * vec4(v_normal, 1.0f);
     position_in_wc = w_position.xyz;
     normal_in_wc = w_normal.xyz;
-    eye_position_in_wc = inverse( ViewMatrix )[3].xyz;
+    eye_position_in_wc = inverse( draw.ViewMatrix )[3].xyz;
 
-    vec4 e_position = ViewMatrix * w_position;
-    vec4 e_normal = transpose( inverse( ViewMatrix ) ) * w_normal;
+    vec4 e_position = draw.ViewMatrix * w_position;
+    vec4 e_normal = transpose( inverse( draw.ViewMatrix ) ) * w_normal;
     position_in_ec = e_position.xyz;
     normal_in_ec = e_normal.xyz;
 
     tex_coord = v_tex_coord;
 
     const float light_distance = 20.0f;
-    light_position_in_ec = vec3(ViewMatrix * vec4(light_distance * ActivatedLightPosition, 1.0));
+    light_position_in_ec = vec3(draw.ViewMatrix * vec4(light_distance * ActivatedLightPosition, 1.0));
 
-    gl_Position = ModelViewProjectionMatrix * vec4(v_position, 1.0f);
+    draw_index = gl_BaseInstance;
+    gl_Position = draw.ModelViewProjectionMatrix * vec4(v_position, 1.0f);
 }
\ No newline at end of file
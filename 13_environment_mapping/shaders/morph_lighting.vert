@@ -0,0 +1,59 @@
+#version 460
+
+#include "draw_data.glsl"
+
+layout (location = 3) uniform vec3 ActivatedLightPosition;
+layout (location = 12) uniform int MorphVertexNum;
+layout (location = 13) uniform ivec2 MorphFrames;
+layout (location = 14) uniform float MorphWeight;
+
+// (position, normal) deltas of every vertex from the base mesh, for the frames after the first one.
+layout (binding = 0, std430) readonly buffer MorphTargets { vec4 Deltas[]; };
+
+layout (location = 0) in vec3 v_position;
+layout (location = 1) in vec3 v_normal;
+layout (location = 2) in vec2 v_tex_coord;
+
+out vec3 position_in_wc;
+out vec3 normal_in_wc;
+out vec3 eye_position_in_wc;
+
+out vec3 position_in_ec;
+out vec3 normal_in_ec;
+out vec3 light_position_in_ec;
+
+out vec2 tex_coord;
+flat out int draw_index;
+
+vec3 getDelta(int frame, int attribute)
+{
+    if (frame == 0) return vec3(0.0f);
+    return Deltas[((frame - 1) * MorphVertexNum + gl_VertexID) * 2 + attribute].xyz;
+}
+
+void main()
+{
+    DrawInfo draw = Draws[gl_BaseInstance];
+    vec3 position = v_position + mix( getDelta( MorphFrames.x, 0 ), getDelta( MorphFrames.y, 0 ), MorphWeight );
+    vec3 normal = v_normal + mix( getDelta( MorphFrames.x, 1 ), getDelta( MorphFrames.y, 1 ), MorphWeight );
+    normal = normalize( normal );
+
+    vec4 w_position = draw.WorldMatrix * vec4(position, 1.0f);
+    vec4 w_normal = transpose( inverse( draw.WorldMatrix ) ) * vec4(normal, 1.0f);
+    position_in_wc = w_position.xyz;
+    normal_in_wc = w_normal.xyz;
+    eye_position_in_wc = inverse( draw.ViewMatrix )[3].xyz;
+
+    vec4 e_position = draw.ViewMatrix * w_position;
+    vec4 e_normal = transpose( inverse( draw.ViewMatrix ) ) * w_normal;
+    position_in_ec = e_position.xyz;
+    normal_in_ec = e_normal.xyz;
+
+    tex_coord = v_tex_coord;
+
+    const float light_distance = 20.0f;
+    light_position_in_ec = vec3(draw.ViewMatrix * vec4(light_distance * ActivatedLightPosition, 1.0));
+
+    draw_index = gl_BaseInstance;
+    gl_Position = draw.ModelViewProjectionMatrix * vec4(position, 1.0f);
+}
\ No newline at end of file
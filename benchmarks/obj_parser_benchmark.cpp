@@ -0,0 +1,156 @@
+#include "object_reader.h"
+#include "thread_pool.h"
+
+// Compares the regex-per-face parser which ObjectGL::readObjectFile used to have with ObjectReader on one thread and
+// on the thread pool. Both give the expanded corners, so the new one pays for the expansion as the old one did.
+// The sample meshes are timed by default, and other .obj files can be given as the arguments.
+namespace
+{
+    constexpr int RepeatNum = 5;
+
+    struct Mesh
+    {
+        std::vector<glm::vec3> Vertices;
+        std::vector<glm::vec3> Normals;
+        std::vector<glm::vec2> Textures;
+    };
+
+    // The former parser, kept as it was apart from returning a Mesh and failing on what it used to assert.
+    // It only takes triangles of v/vt/vn corners.
+    [[nodiscard]] bool readWithRegex(Mesh& mesh, const std::string& file_path)
+    {
+        std::ifstream file( file_path );
+        if (!file.is_open()) return false;
+
+        std::vector<glm::vec3> vertex_buffer, normal_buffer;
+        std::vector<glm::vec2> texture_buffer;
+        std::vector<int> vertex_indices, normal_indices, texture_indices;
+        while (!file.eof()) {
+            std::string word;
+            file >> word;
+
+            if (word == "v") {
+                glm::vec3 vertex;
+                file >> vertex.x >> vertex.y >> vertex.z;
+                vertex_buffer.emplace_back( vertex );
+            }
+            else if (word == "vt") {
+                glm::vec2 uv;
+                file >> uv.x >> uv.y;
+                texture_buffer.emplace_back( uv );
+            }
+            else if (word == "vn") {
+                glm::vec3 normal;
+                file >> normal.x >> normal.y >> normal.z;
+                normal_buffer.emplace_back( normal );
+            }
+            else if (word == "f") {
+                std::string line;
+                std::getline( file, line );
+
+                const std::regex delimiter( "[ /]" );
+                const std::sregex_token_iterator it( line.begin() + 1, line.end(), delimiter, -1 );
+                const std::vector<std::string> n( it, std::sregex_token_iterator() );
+                if (n.size() != 9) return false;
+
+                vertex_indices.emplace_back( std::stof( n[0] ) );
+                texture_indices.emplace_back( std::stof( n[1] ) );
+                normal_indices.emplace_back( std::stof( n[2] ) );
+                vertex_indices.emplace_back( std::stof( n[3] ) );
+                texture_indices.emplace_back( std::stof( n[4] ) );
+                normal_indices.emplace_back( std::stof( n[5] ) );
+                vertex_indices.emplace_back( std::stof( n[6] ) );
+                texture_indices.emplace_back( std::stof( n[7] ) );
+                normal_indices.emplace_back( std::stof( n[8] ) );
+            }
+            else std::getline( file, word );
+        }
+
+        for (uint i = 0; i < vertex_indices.size(); ++i) {
+            mesh.Vertices.emplace_back( vertex_buffer[vertex_indices[i] - 1] );
+            mesh.Normals.emplace_back( normal_buffer[normal_indices[i] - 1] );
+            mesh.Textures.emplace_back( texture_buffer[texture_indices[i] - 1] );
+        }
+        return true;
+    }
+
+    [[nodiscard]] bool readWithObjectReader(Mesh& mesh, const std::string& file_path, int thread_num)
+    {
+        ObjectReader::ObjectData data;
+        if (!ObjectReader::readObjectFile( data, file_path, thread_num )) return false;
+
+        mesh.Vertices.reserve( data.Corners.size() );
+        mesh.Normals.reserve( data.Corners.size() );
+        mesh.Textures.reserve( data.Corners.size() );
+        for (const auto& corner : data.Corners) {
+            mesh.Vertices.emplace_back( data.Vertices[corner.x] );
+            mesh.Textures.emplace_back( corner.y < 0 ? glm::vec2( 0.0f ) : data.Textures[corner.y] );
+            mesh.Normals.emplace_back( corner.z < 0 ? glm::vec3( 0.0f ) : data.Normals[corner.z] );
+        }
+        return true;
+    }
+
+    // Runs the parser RepeatNum times and keeps the fastest run, which is the least disturbed by the rest of the
+    // system.
+    template<typename Parser>
+    [[nodiscard]] double measure(Mesh& mesh, Parser parse)
+    {
+        double best = std::numeric_limits<double>::max();
+        for (int i = 0; i < RepeatNum; ++i) {
+            mesh = Mesh{};
+            const auto start = std::chrono::steady_clock::now();
+            if (!parse( mesh )) return -1.0;
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            best = std::min( best, elapsed.count() );
+        }
+        return best;
+    }
+
+    [[nodiscard]] bool benchmark(const std::string& file_path, int thread_num)
+    {
+        Mesh expected, single, chunked;
+        const double regex_time = measure( expected, [&](Mesh& mesh) { return readWithRegex( mesh, file_path ); } );
+        const double single_time =
+            measure( single, [&](Mesh& mesh) { return readWithObjectReader( mesh, file_path, 1 ); } );
+        const double chunked_time =
+            measure( chunked, [&](Mesh& mesh) { return readWithObjectReader( mesh, file_path, thread_num ); } );
+        if (regex_time < 0.0 || single_time < 0.0 || chunked_time < 0.0) {
+            std::cerr << ">> " << file_path << ": could not be parsed\n";
+            return false;
+        }
+
+        const auto isSame = [&expected](const Mesh& mesh) {
+            return mesh.Vertices == expected.Vertices && mesh.Normals == expected.Normals &&
+                mesh.Textures == expected.Textures;
+        };
+        if (!isSame( single ) || !isSame( chunked )) {
+            std::cerr << ">> " << file_path << ": the parsers do not agree\n";
+            return false;
+        }
+
+        std::cout << std::fixed << std::setprecision( 2 )
+            << ">> " << std::filesystem::path( file_path ).filename().string() << " ("
+            << expected.Vertices.size() / 3 << " triangles)\n"
+            << "   regex           : " << regex_time << " ms\n"
+            << "   1 thread        : " << single_time << " ms (x" << regex_time / single_time << ")\n"
+            << "   " << std::left << std::setw( 16 ) << std::to_string( thread_num ) + " threads" << std::right
+            << ": " << chunked_time << " ms (x" << regex_time / chunked_time << ")\n";
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::vector<std::string> file_paths;
+    for (int i = 1; i < argc; ++i) file_paths.emplace_back( argv[i] );
+    if (file_paths.empty()) {
+        file_paths.emplace_back( std::string( CMAKE_SOURCE_DIR ) + "/10_shadow_mapping/samples/panda.obj" );
+        file_paths.emplace_back( std::string( CMAKE_SOURCE_DIR ) + "/03_gimbal_lock/teapot.obj" );
+    }
+
+    // Files smaller than a chunk, such as the samples, are parsed on one thread whatever the thread number is.
+    const int thread_num = std::max( ThreadPool::getHardwareThreadNum(), 2 );
+    bool passed = true;
+    for (const auto& file_path : file_paths) passed = benchmark( file_path, thread_num ) && passed;
+    return passed ? 0 : 1;
+}
\ No newline at end of file
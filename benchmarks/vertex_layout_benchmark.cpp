@@ -0,0 +1,154 @@
+#include "vertex_layout.h"
+
+// Compares the staging path which ObjectGL::updateDataBuffer used to take, pushing the floats into DataBuffer and
+// copying it into the buffer, with VertexLayout writing the vertices straight into it. A host allocation stands in
+// for the mapped buffer, so that only the CPU side is timed. It also counts the heap allocations of each path.
+namespace
+{
+    constexpr int RepeatNum = 5;
+    constexpr int MovingPointUpdateNum = 1'000'000;
+    constexpr int MeshUpdateNum = 20;
+    constexpr size_t MeshVertexNum = 100'000;
+
+    size_t AllocationNum = 0;
+
+    struct Result
+    {
+        double Time; // in milliseconds of the fastest run
+        size_t AllocationNum; // of the fastest run
+    };
+
+    // The staged vertices are copied into the buffer as glNamedBufferSubData would.
+    void uploadStaged(std::vector<GLfloat>& data_buffer, void* destination)
+    {
+        std::memcpy( destination, data_buffer.data(), sizeof( GLfloat ) * data_buffer.size() );
+        data_buffer.clear();
+    }
+
+    // The former updateDataBuffer for positions, which 05_moving_point_on_bezier_curve called every frame.
+    void updateStaged(std::vector<GLfloat>& data_buffer, void* destination, const std::vector<glm::vec3>& vertices)
+    {
+        for (const auto& vertex : vertices) {
+            data_buffer.push_back( vertex.x );
+            data_buffer.push_back( vertex.y );
+            data_buffer.push_back( vertex.z );
+        }
+        uploadStaged( data_buffer, destination );
+    }
+
+    void updateStaged(
+        std::vector<GLfloat>& data_buffer,
+        void* destination,
+        const std::vector<glm::vec3>& vertices,
+        const std::vector<glm::vec3>& normals,
+        const std::vector<glm::vec2>& textures
+    )
+    {
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            data_buffer.push_back( vertices[i].x );
+            data_buffer.push_back( vertices[i].y );
+            data_buffer.push_back( vertices[i].z );
+            data_buffer.push_back( normals[i].x );
+            data_buffer.push_back( normals[i].y );
+            data_buffer.push_back( normals[i].z );
+            data_buffer.push_back( textures[i].x );
+            data_buffer.push_back( textures[i].y );
+        }
+        uploadStaged( data_buffer, destination );
+    }
+
+    // Runs the updates RepeatNum times, and each run starts with an empty DataBuffer as a new object would have.
+    template<typename Update>
+    [[nodiscard]] Result measure(int update_num, Update update)
+    {
+        Result best{ std::numeric_limits<double>::max(), 0 };
+        for (int i = 0; i < RepeatNum; ++i) {
+            std::vector<GLfloat> data_buffer;
+            const size_t allocation_num = AllocationNum;
+            const auto start = std::chrono::steady_clock::now();
+            for (int u = 0; u < update_num; ++u) update( data_buffer, u );
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            if (elapsed.count() < best.Time) best = { elapsed.count(), AllocationNum - allocation_num };
+        }
+        return best;
+    }
+
+    void report(const std::string& name, int update_num, const Result& staged, const Result& layout)
+    {
+        std::cout << std::fixed << std::setprecision( 2 ) << ">> " << name << " (" << update_num << " updates)\n"
+            << "   staging : " << staged.Time << " ms, " << staged.AllocationNum << " allocations\n"
+            << "   layout  : " << layout.Time << " ms, " << layout.AllocationNum << " allocations (x"
+            << staged.Time / layout.Time << ")\n";
+    }
+
+    [[nodiscard]] bool benchmarkMovingPoint()
+    {
+        std::vector<glm::vec3> curve( 1024 );
+        for (size_t i = 0; i < curve.size(); ++i) {
+            const float t = static_cast<float>(i) / static_cast<float>(curve.size() - 1);
+            curve[i] = glm::vec3( t, t * t, t * t * t );
+        }
+
+        glm::vec3 staged_point, layout_point;
+        const Result staged = measure(
+            MovingPointUpdateNum, [&](std::vector<GLfloat>& data_buffer, int u) {
+                updateStaged( data_buffer, &staged_point, { curve[u % curve.size()] } );
+            }
+        );
+        const Result layout = measure(
+            MovingPointUpdateNum, [&](std::vector<GLfloat>&, int u) {
+                PositionLayout::write( &layout_point, 1, &curve[u % curve.size()] );
+            }
+        );
+        report( "moving point", MovingPointUpdateNum, staged, layout );
+        return staged_point == layout_point;
+    }
+
+    [[nodiscard]] bool benchmarkMesh()
+    {
+        std::vector<glm::vec3> vertices( MeshVertexNum ), normals( MeshVertexNum );
+        std::vector<glm::vec2> textures( MeshVertexNum );
+        for (size_t i = 0; i < MeshVertexNum; ++i) {
+            const auto f = static_cast<float>(i);
+            vertices[i] = glm::vec3( f, f + 0.25f, f + 0.5f );
+            normals[i] = glm::normalize( glm::vec3( 1.0f, f, -f ) );
+            textures[i] = glm::vec2( f * 1e-5f, 1.0f - f * 1e-5f );
+        }
+
+        constexpr size_t size = MeshVertexNum * PositionNormalTextureLayout::Stride;
+        std::vector<uint8_t> staged_buffer( size ), layout_buffer( size );
+        const Result staged = measure(
+            MeshUpdateNum, [&](std::vector<GLfloat>& data_buffer, int) {
+                updateStaged( data_buffer, staged_buffer.data(), vertices, normals, textures );
+            }
+        );
+        const Result layout = measure(
+            MeshUpdateNum, [&](std::vector<GLfloat>&, int) {
+                PositionNormalTextureLayout::write(
+                    layout_buffer.data(), MeshVertexNum, vertices.data(), normals.data(), textures.data()
+                );
+            }
+        );
+        report( std::to_string( MeshVertexNum ) + " position/normal/texture vertices", MeshUpdateNum, staged, layout );
+        return staged_buffer == layout_buffer;
+    }
+}
+
+void* operator new(size_t size)
+{
+    ++AllocationNum;
+    if (void* ptr = std::malloc( size == 0 ? 1 : size )) return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free( ptr ); }
+
+void operator delete(void* ptr, size_t) noexcept { std::free( ptr ); }
+
+int main()
+{
+    bool passed = benchmarkMovingPoint();
+    passed = benchmarkMesh() && passed;
+    if (!passed) std::cerr << ">> The staging path and the layout do not write the same vertices\n";
+    return passed ? 0 : 1;
+}
\ No newline at end of file
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "object.h"
+#include "object_reader.h"
+#include "thread_pool.h"
+
+// Streams the assets in while the render loop keeps running. The CPU side of a request runs on the thread pool,
+// and its GL side is queued for uploadPending(), which the render loop calls once per frame.
+// The uploads run in the request order, so the textures of an object are added in the order they are requested.
+class AssetLoader final
+{
+public:
+    struct Image
+    {
+        // The rows are in the layout of FreeImage, bottom-up and 4-byte aligned, so they can be uploaded as they are.
+        std::vector<uint8_t> Pixels;
+        int Width = 0;
+        int Height = 0;
+        bool IsGrayscale = false;
+    };
+
+    explicit AssetLoader(double upload_budget_in_ms = 2.0, int max_uploads_per_frame = 4);
+    ~AssetLoader();
+
+    AssetLoader(AssetLoader&&) = delete;
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(AssetLoader&&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+    // read runs on a worker thread and must not touch the GL state, and upload runs on the context thread.
+    // The returned future is ready after the upload and holds false if either of them failed.
+    // The context thread must never wait on it, because only uploadPending() can make it ready.
+    [[nodiscard]] std::shared_future<bool> request(std::function<bool()> read, std::function<bool()> upload);
+    [[nodiscard]] std::shared_future<bool> requestMesh(
+        ObjectGL& object,
+        GLenum draw_mode,
+        const std::string& file_path
+    );
+    [[nodiscard]] std::shared_future<bool> requestMorphObject(
+        ObjectGL& object,
+        GLenum draw_mode,
+        const std::vector<std::string>& frame_paths
+    );
+    [[nodiscard]] std::shared_future<bool> requestTexture(
+        ObjectGL& object,
+        const std::string& file_path,
+        bool is_grayscale = false
+    );
+    // The mip chain is filtered and block-compressed on the worker alone unless its cache is valid.
+    [[nodiscard]] std::shared_future<bool> requestTexture(
+        ObjectGL& object,
+        const std::string& file_path,
+        BlockCompressor::FORMAT format
+    );
+
+    // Runs the uploads in order until it meets a request still being read or the budget of this frame runs out.
+    // The first upload always runs, so an upload slower than the budget cannot stall the queue.
+    void uploadPending();
+
+    [[nodiscard]] bool isIdle() const { return Requests.empty(); }
+    [[nodiscard]] int getPendingNum() const { return static_cast<int>(Requests.size()); }
+
+    [[nodiscard]] static bool isReady(const std::shared_future<bool>& loaded)
+    {
+        return loaded.valid() && loaded.wait_for( std::chrono::seconds( 0 ) ) == std::future_status::ready &&
+            loaded.get();
+    }
+
+    // With width and height, the image is rescaled to them if it is of another size.
+    [[nodiscard]] static bool decodeImage(
+        Image& image,
+        const std::string& file_path,
+        bool is_grayscale,
+        int width = 0,
+        int height = 0
+    );
+
+    // Decodes the images at once, one task per image, and returns after all of them are done. It only fails if an
+    // image could not be read. It must not be called from a task of the thread pool, because it waits on the tasks.
+    [[nodiscard]] static bool decodeImages(
+        std::vector<Image>& images,
+        const std::vector<std::string>& file_paths,
+        bool is_grayscale = false,
+        int width = 0,
+        int height = 0
+    );
+
+private:
+    // The requests and the uploads are both made on the context thread, so the queue does not need a lock.
+    struct Request
+    {
+        std::future<bool> Read;
+        std::function<bool()> Upload;
+        std::promise<bool> Uploaded;
+    };
+
+    double UploadBudgetInMs;
+    int MaxUploadsPerFrame;
+    std::deque<Request> Requests;
+};
\ No newline at end of file
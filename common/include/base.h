@@ -7,6 +7,7 @@
 #include <gtc/type_ptr.hpp>
 #include <gtc/matrix_transform.hpp>
 #include <gtc/quaternion.hpp>
+#include <gtc/packing.hpp>
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include <gtx/quaternion.hpp>
@@ -18,14 +19,28 @@
 #include <array>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <charconv>
+#include <cstring>
+#include <bit>
 #include <map>
 #include <unordered_map>
 #include <sstream>
 #include <fstream>
+#include <filesystem>
 #include <chrono>
 #include <memory>
 #include <algorithm>
 #include <stdexcept>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <queue>
+#include <functional>
+#include <deque>
+#include <limits>
+#include <cmath>
 #include <regex>
 
 #include "project_constants.h"
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "base.h"
+
+// Encodes 4x4 blocks of BGRA pixels, as FreeImage decodes them, into the BC formats, which the GPU samples without
+// unpacking, so a texture takes 1/8 (BC1, BC4) or 1/4 (BC3, BC5) of the memory and the bandwidth of RGBA8.
+// BC1 is for opaque colors, BC3 for colors with alpha, BC4 for a single channel and BC5 for two, such as normals.
+class BlockCompressor final
+{
+public:
+    enum FORMAT { BC1 = 0, BC3, BC4, BC5 };
+
+    // Fast fits the endpoints to the bounding box of a block. High fits them to its principal axis, refines them by
+    // least squares and tries both modes of the single channel blocks, which takes a few times longer.
+    enum QUALITY { Fast = 0, High };
+
+    // S3TC is not in the core profile, but EXT_texture_compression_s3tc is supported by every desktop driver.
+    static constexpr GLenum CompressedRGBS3TCDXT1 = 0x83F0;
+    static constexpr GLenum CompressedRGBAS3TCDXT5 = 0x83F3;
+
+    BlockCompressor() = delete;
+
+    [[nodiscard]] static int getBlockBytes(FORMAT format) { return format == BC1 || format == BC4 ? 8 : 16; }
+
+    [[nodiscard]] static size_t getCompressedSize(FORMAT format, int width, int height)
+    {
+        return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * getBlockBytes( format );
+    }
+
+    [[nodiscard]] static GLenum getInternalFormat(FORMAT format);
+    [[nodiscard]] static const char* getFormatName(FORMAT format);
+
+    // pixels are tightly packed BGRA rows, and the blocks are laid out in the same row order.
+    // With thread_num > 1, the block rows are split over the thread pool.
+    static void compress(
+        std::vector<uint8_t>& blocks,
+        const uint8_t* pixels,
+        int width,
+        int height,
+        FORMAT format,
+        QUALITY quality,
+        int thread_num = 1
+    );
+    static void decompress(std::vector<uint8_t>& pixels, const uint8_t* blocks, int width, int height, FORMAT format);
+
+    // The peak signal-to-noise ratio over the channels the format keeps, in dB.
+    [[nodiscard]] static double getPSNR(
+        const uint8_t* original,
+        const uint8_t* decompressed,
+        int width,
+        int height,
+        FORMAT format
+    );
+
+private:
+    using Block = std::array<glm::u8vec4, 16>;
+
+    // The channel offsets in a BGRA pixel.
+    enum CHANNEL { Blue = 0, Green, Red, Alpha };
+
+    [[nodiscard]] static Block getBlock(const uint8_t* pixels, int width, int height, int block_x, int block_y);
+    [[nodiscard]] static uint16_t packColor(const glm::vec3& color);
+    [[nodiscard]] static glm::ivec3 unpackColor(uint16_t color);
+    static void getColorPalette(std::array<glm::ivec3, 4>& palette, uint16_t color0, uint16_t color1);
+    static void getValuePalette(std::array<int, 8>& palette, int value0, int value1);
+    [[nodiscard]] static int fitColorIndices(
+        uint32_t& indices,
+        const Block& block,
+        uint16_t color0,
+        uint16_t color1
+    );
+    [[nodiscard]] static int fitValueIndices(
+        uint64_t& indices,
+        const std::array<uint8_t, 16>& values,
+        int value0,
+        int value1
+    );
+    static void refineColorEndpoints(const Block& block, uint32_t indices, glm::vec3& color0, glm::vec3& color1);
+    static void encodeColorBlock(uint8_t* destination, const Block& block, QUALITY quality);
+    static void encodeValueBlock(uint8_t* destination, const std::array<uint8_t, 16>& values, QUALITY quality);
+    static void encodeBlock(uint8_t* destination, const Block& block, FORMAT format, QUALITY quality);
+    static void decodeColorBlock(std::array<glm::ivec3, 16>& colors, const uint8_t* source);
+    static void decodeValueBlock(std::array<int, 16>& values, const uint8_t* source);
+};
\ No newline at end of file
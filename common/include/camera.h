@@ -57,6 +57,9 @@ public:
     void update2DCamera(int width, int height);
     void update3DCamera(int width, int height);
 
+    // The diameter in pixels that a sphere in the world covers on the screen.
+    [[nodiscard]] float getProjectedSize(const glm::vec3& world_center, float world_radius) const;
+
 private:
     bool IsPerspective;
     bool IsMoving;
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "mipmapped_texture.h"
+#include "block_compressor.h"
+
+// The block-compressed mip chain of an image, which is written next to the source image and mapped on the later
+// loads so that the image does not have to be decoded and encoded again.
+// Loading does not touch the GL state, so textures can be loaded on worker threads and uploaded on the context thread.
+// On a worker of ThreadPool, the mip chain is filtered and encoded on that worker alone, whatever thread_num says.
+class CompressedTexture final
+{
+public:
+    // Enough levels for a 32768x32768 image.
+    static constexpr int MaxLevelNum = 16;
+
+    CompressedTexture() = default;
+    ~CompressedTexture() = default;
+
+    CompressedTexture(CompressedTexture&&) = delete;
+    CompressedTexture(const CompressedTexture&) = delete;
+    CompressedTexture& operator=(CompressedTexture&&) = delete;
+    CompressedTexture& operator=(const CompressedTexture&) = delete;
+
+    [[nodiscard]] bool open(
+        const std::string& source_path,
+        BlockCompressor::FORMAT format,
+        BlockCompressor::QUALITY quality
+    );
+
+    // Maps the cache if it is valid and has the same format and quality. Otherwise, decodes the source, builds its
+    // mip chain by MipmapGenerator, encodes every level, reports the PSNR of the base level and writes the cache.
+    [[nodiscard]] bool load(
+        const std::string& source_path,
+        BlockCompressor::FORMAT format,
+        BlockCompressor::QUALITY quality = BlockCompressor::High,
+        int thread_num = 1
+    );
+
+    void close()
+    {
+        File.close();
+        Blob.clear();
+        CacheHeader = nullptr;
+    }
+
+    [[nodiscard]] static std::string getCachePath(const std::string& source_path) { return source_path + ".glctex"; }
+    [[nodiscard]] bool isMapped() const { return File.isOpen(); }
+    [[nodiscard]] BlockCompressor::FORMAT getFormat() const
+    {
+        return static_cast<BlockCompressor::FORMAT>(CacheHeader->Format);
+    }
+    [[nodiscard]] GLenum getInternalFormat() const { return BlockCompressor::getInternalFormat( getFormat() ); }
+    [[nodiscard]] int getWidth() const { return static_cast<int>(CacheHeader->Width); }
+    [[nodiscard]] int getHeight() const { return static_cast<int>(CacheHeader->Height); }
+    [[nodiscard]] int getLevelNum() const { return static_cast<int>(CacheHeader->LevelNum); }
+    [[nodiscard]] int getLevelWidth(int level) const { return std::max( getWidth() >> level, 1 ); }
+    [[nodiscard]] int getLevelHeight(int level) const { return std::max( getHeight() >> level, 1 ); }
+
+    [[nodiscard]] GLsizei getLevelSize(int level) const
+    {
+        return static_cast<GLsizei>(CacheHeader->LevelSizes[level]);
+    }
+
+    [[nodiscard]] const void* getLevelData(int level) const
+    {
+        const char* data = isMapped() ? File.getData() : reinterpret_cast<const char*>(Blob.data());
+        return data + CacheHeader->LevelOffsets[level];
+    }
+
+private:
+    struct Header
+    {
+        std::array<char, 8> Magic;
+        uint32_t Version;
+        uint32_t Format;
+        uint32_t Quality;
+        uint32_t Width;
+        uint32_t Height;
+        uint32_t LevelNum;
+        uint64_t SourceSize;
+        int64_t SourceModifiedTime;
+        uint64_t SourceHash;
+        std::array<uint64_t, MaxLevelNum> LevelOffsets;
+        std::array<uint64_t, MaxLevelNum> LevelSizes;
+    };
+
+    // Bump the version whenever the layout or the encoder changes, so that the stale caches get rebuilt.
+    // Version 2 filters the levels by the gamma-correct Kaiser filter instead of the box filter.
+    static constexpr uint32_t Version = 2;
+    static constexpr std::array<char, 8> Magic = { 'G', 'L', 'C', 'T', 'E', 'X', '\0', '\0' };
+
+    MappedFile File;
+    const Header* CacheHeader = nullptr;
+
+    // Without a valid cache, the encoded levels are kept in memory as the blob the cache is written from.
+    std::vector<uint8_t> Blob;
+
+    [[nodiscard]] bool isValid(
+        const std::string& source_path,
+        BlockCompressor::FORMAT format,
+        BlockCompressor::QUALITY quality
+    ) const;
+};
\ No newline at end of file
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "object.h"
+
+// Collects the transforms and the materials of the draws of a frame in a shader storage buffer, which the shaders
+// index by gl_BaseInstance. A draw then passes its index as its base instance instead of setting about ten uniforms,
+// and the draws that share a program can go to the GPU in one multi-draw as they are.
+// The entries are written straight into a region of a persistently mapped ring buffer, so a frame costs no upload.
+class DrawDataGL final
+{
+public:
+    // The bindings from 0 to 3 are taken by the compute shaders and the other buffers of the samples.
+    static constexpr GLuint DrawBufferBinding = 4;
+
+    // The std430 layout of MaterialInfo and DrawInfo in the shaders.
+    struct MaterialInfo
+    {
+        glm::vec4 EmissionColor;
+        glm::vec4 AmbientColor;
+        glm::vec4 DiffuseColor;
+        glm::vec4 SpecularColor;
+        float SpecularExponent;
+        std::array<float, 3> Padding;
+    };
+
+    struct DrawInfo
+    {
+        glm::mat4 WorldMatrix;
+        glm::mat4 ViewMatrix;
+        glm::mat4 ModelViewProjectionMatrix;
+        MaterialInfo Material;
+    };
+
+    explicit DrawDataGL(int max_draw_num = 256);
+    ~DrawDataGL() = default;
+
+    DrawDataGL(DrawDataGL&&) = delete;
+    DrawDataGL(const DrawDataGL&) = delete;
+    DrawDataGL& operator=(DrawDataGL&&) = delete;
+    DrawDataGL& operator=(const DrawDataGL&) = delete;
+
+    // Moves on to the next region of the ring buffer, which waits only if the GPU still reads the frame before last,
+    // and binds it to DrawBufferBinding. It has to be called before the first addDraw() of every frame.
+    void beginFrame();
+
+    // Writes the entry of a draw of the object with its material, and returns the index the draw passes as its base
+    // instance. The entries stay until the next beginFrame(), so passes of the same frame can share them.
+    [[nodiscard]] GLuint addDraw(
+        const ObjectGL& object,
+        const glm::mat4& world_matrix,
+        const glm::mat4& view_matrix,
+        const glm::mat4& projection_matrix
+    );
+    [[nodiscard]] GLuint addDraw(const DrawInfo& draw);
+
+    [[nodiscard]] static MaterialInfo getMaterial(const ObjectGL& object)
+    {
+        return {
+            object.getEmissionColor(),
+            object.getAmbientReflectionColor(),
+            object.getDiffuseReflectionColor(),
+            object.getSpecularReflectionColor(),
+            object.getSpecularReflectionExponent(),
+            {}
+        };
+    }
+
+    [[nodiscard]] int getDrawNum() const { return DrawNum; }
+    [[nodiscard]] int getMaxDrawNum() const { return MaxDrawNum; }
+
+private:
+    int MaxDrawNum;
+    int DrawNum = 0;
+    DrawInfo* Draws = nullptr;
+    std::unique_ptr<RingBufferGL> Buffer;
+};
\ No newline at end of file
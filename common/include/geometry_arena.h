@@ -0,0 +1,137 @@
+#pragma once
+
+#include "object.h"
+
+// Sub-allocates the vertices and indices of static meshes from one vertex buffer and one index buffer, which all the
+// meshes of a vertex format see through one vertex array. The draws queued over a frame then go to the GPU in one
+// glMultiDrawElementsIndirect call per vertex format and draw mode, without binding the vertex state of each object.
+// A draw reaches the shader with its base_instance as gl_BaseInstance, which the shader uses to find its data.
+class GeometryArenaGL final
+{
+public:
+    // The layout of DrawElementsIndirectCommand, which glMultiDrawElementsIndirect reads from the indirect buffer.
+    struct DrawCommand
+    {
+        GLuint Count;
+        GLuint InstanceCount;
+        GLuint FirstIndex;
+        GLint BaseVertex;
+        GLuint BaseInstance;
+    };
+
+    // The buffers grow when a mesh does not fit even after defragmenting, so these only have to be a fair guess.
+    GeometryArenaGL(GLsizeiptr vertex_buffer_size, GLsizeiptr index_capacity);
+    ~GeometryArenaGL();
+
+    GeometryArenaGL(GeometryArenaGL&&) = delete;
+    GeometryArenaGL(const GeometryArenaGL&) = delete;
+    GeometryArenaGL& operator=(GeometryArenaGL&&) = delete;
+    GeometryArenaGL& operator=(const GeometryArenaGL&) = delete;
+
+    // Copies the vertices and indices of the object from its buffers on the GPU, and returns the handle of the mesh.
+    // The vertex format is read from the vertex array of the object, and the objects without indices get sequential
+    // ones. The arena does not follow the later vertex updates of the object.
+    [[nodiscard]] int addMesh(const ObjectGL& object);
+
+    // The handles of the other meshes stay valid, and the freed ranges are merged with their free neighbors.
+    void removeMesh(int mesh);
+
+    // Moves the live meshes to the front of new buffers, which joins the free ranges left by the removed meshes.
+    void defragment() { rebuild( VertexBufferSize, IndexCapacity ); }
+
+    // Queues a draw of index_num indices of the mesh from first_index. By default, it draws what glDrawElements would
+    // draw for the object with its getIndexNum(), which is the finest level of detail.
+    void addDraw(int mesh, GLuint base_instance, GLsizei index_num = -1, GLsizei first_index = 0);
+
+    // Issues the queued draws and clears the queue. It returns the number of the API calls it took.
+    int submitDraws();
+
+    // Draws the mesh right away with no indirect buffer, for a draw that has to go out between state changes such as
+    // texture binds. It takes the same arguments as addDraw.
+    void drawMesh(int mesh, GLuint base_instance, GLsizei index_num = -1, GLsizei first_index = 0) const;
+
+    [[nodiscard]] int getFormatNum() const { return static_cast<int>(Formats.size()); }
+    [[nodiscard]] GLsizeiptr getVertexBufferSize() const { return VertexBufferSize; }
+    [[nodiscard]] GLsizeiptr getIndexCapacity() const { return IndexCapacity; }
+
+private:
+    static constexpr int MaxAttributeNum = 8;
+
+    struct Attribute
+    {
+        GLint Enabled;
+        GLint ComponentNum;
+        GLint Type;
+        GLint Normalized;
+        GLint Integer;
+        GLint RelativeOffset;
+
+        bool operator==(const Attribute&) const = default;
+    };
+
+    struct VertexFormat
+    {
+        GLint Stride;
+        std::array<Attribute, MaxAttributeNum> Attributes;
+
+        bool operator==(const VertexFormat&) const = default;
+    };
+
+    struct Mesh
+    {
+        bool IsAlive;
+        int Format;
+        GLenum DrawMode;
+        GLsizeiptr VertexOffset;
+        GLsizeiptr VertexSize;
+        GLsizeiptr FirstIndex;
+        GLsizeiptr IndexNum;
+        GLsizei DrawIndexNum;
+    };
+
+    struct Draw
+    {
+        int Mesh;
+        GLuint BaseInstance;
+        GLsizei IndexNum;
+        GLsizei FirstIndex;
+    };
+
+    // First-fit over the free ranges ordered by their offsets, so that a released range can find its neighbors.
+    class FreeList final
+    {
+    public:
+        void reset(GLsizeiptr offset, GLsizeiptr size)
+        {
+            Ranges.clear();
+            if (size > 0) Ranges[offset] = size;
+        }
+
+        [[nodiscard]] bool allocate(GLsizeiptr& offset, GLsizeiptr size, GLsizeiptr alignment);
+        void release(GLsizeiptr offset, GLsizeiptr size);
+
+    private:
+        std::map<GLsizeiptr, GLsizeiptr> Ranges;
+    };
+
+    // Every submit takes a region of its own, and a frame can submit more than once, such as one per polygon mode.
+    static constexpr int IndirectRegionNum = 8;
+
+    GLuint VertexBuffer = 0;
+    GLuint IndexBuffer = 0;
+    GLsizeiptr VertexBufferSize;
+    GLsizeiptr IndexCapacity;
+    FreeList FreeVertices;
+    FreeList FreeIndices;
+    std::vector<VertexFormat> Formats;
+    std::vector<GLuint> VAOs;
+    std::vector<Mesh> Meshes;
+    std::vector<Draw> Draws;
+    std::vector<DrawCommand> Commands;
+    std::unique_ptr<RingBufferGL> IndirectRing;
+
+    [[nodiscard]] static VertexFormat getVertexFormat(GLuint vao);
+    [[nodiscard]] int findFormat(const VertexFormat& format);
+    [[nodiscard]] bool allocate(Mesh& mesh);
+    void rebuild(GLsizeiptr vertex_buffer_size, GLsizeiptr index_capacity);
+};
\ No newline at end of file
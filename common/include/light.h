@@ -2,11 +2,17 @@
 
 #include "base.h"
 
+// Keeps the lights in a std140 uniform buffer, which the lighting shaders read as their LightBlock.
+// The buffer is repacked only when a light or the view has changed, so an unchanged frame costs one bind.
 class LightGL final
 {
 public:
+    // The length of the light array in the shaders, beyond which the lights are not packed.
+    static constexpr int MaxLightNum = 32;
+    static constexpr GLuint LightBufferBinding = 0;
+
     LightGL() = default;
-    ~LightGL() = default;
+    ~LightGL();
 
     LightGL(LightGL&&) = delete;
     LightGL(const LightGL&) = delete;
@@ -27,10 +33,19 @@ public:
     );
     void activateLight(const int& light_index);
     void deactivateLight(const int& light_index);
-    void setLightPosition(const glm::vec4& light_position, int light_index) { Positions[light_index] = light_position; }
+    void setLightPosition(const glm::vec4& light_position, int light_index)
+    {
+        Positions[light_index] = light_position;
+        IsDirty = true;
+    }
+
+    // Repacks the buffer if anything has changed since the last call, and binds it to LightBufferBinding.
+    // The spotlight directions are packed in the eye coordinates of the view, which saves the shaders from inverting
+    // the view matrix for every fragment. It is called once per frame, or once per view if a frame has several.
+    void updateLightBuffer(const glm::mat4& view_matrix);
     [[nodiscard]] int getTotalLightNum() const { return TotalLightNum; }
     [[nodiscard]] glm::vec4 getGlobalAmbientColor() const { return GlobalAmbientColor; }
-    [[nodiscard]] bool isActivated(int light_index) { return IsActivated[light_index]; }
+    [[nodiscard]] bool isActivated(int light_index) const { return IsActivated[light_index]; }
     [[nodiscard]] glm::vec4 getPosition(int light_index) const { return Positions[light_index]; }
     [[nodiscard]] glm::vec4 getAmbientColors(int light_index) const { return AmbientColors[light_index]; }
     [[nodiscard]] glm::vec4 getDiffuseColors(int light_index) const { return DiffuseColors[light_index]; }
@@ -41,6 +56,35 @@ public:
     [[nodiscard]] float getFallOffRadii(int light_index) const { return FallOffRadii[light_index]; }
 
 private:
+    // Matches the std140 layout of LightInfo in the shaders, whose array stride is 96 bytes.
+    struct LightInfo
+    {
+        glm::vec4 Position;
+        glm::vec4 AmbientColor;
+        glm::vec4 DiffuseColor;
+        glm::vec4 SpecularColor;
+        glm::vec3 SpotlightDirectionInEC;
+        float SpotlightCutoffAngle;
+        int LightSwitch;
+        float SpotlightFeather;
+        float FallOffRadius;
+        float Padding;
+    };
+
+    // Matches the std140 layout of LightBlock in the shaders, where the light array starts at 32 bytes.
+    struct LightBlock
+    {
+        glm::vec4 GlobalAmbient;
+        int LightNum;
+        std::array<int, 3> Padding;
+        std::array<LightInfo, MaxLightNum> Lights;
+    };
+    static_assert( sizeof( LightInfo ) == 96 && offsetof( LightBlock, Lights ) == 32, "The layout must be std140." );
+
+    bool IsDirty = true;
+    GLuint LightBuffer = 0;
+    glm::mat4 PackedViewMatrix{ 1.0f };
+    LightBlock PackedLights{};
     bool TurnLightOn = true;
     int TotalLightNum = 0;
     glm::vec4 GlobalAmbientColor{ 0.2f, 0.2f, 0.2f, 1.0f };
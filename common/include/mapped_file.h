@@ -0,0 +1,41 @@
+#pragma once
+
+#include "base.h"
+
+class MappedFile final
+{
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+
+    MappedFile(MappedFile&&) = delete;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(MappedFile&&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    [[nodiscard]] bool open(const std::string& file_path);
+    void close();
+    [[nodiscard]] bool isOpen() const { return Opened; }
+    [[nodiscard]] const char* getData() const { return Data; }
+    [[nodiscard]] size_t getSize() const { return Size; }
+
+    // The caches built from a file keep these to tell whether the file has changed since.
+    [[nodiscard]] static bool getFileInfo(const std::string& file_path, uint64_t& size, int64_t& modified_time);
+    [[nodiscard]] static uint64_t getFileHash(const std::string& file_path);
+    // Continues the hash from the given one, so that several pieces can be hashed as if they were one.
+    [[nodiscard]] static uint64_t getHash(const void* data, size_t size, uint64_t hash = 14695981039346656037ull);
+
+    // Writes the data aside and renames it, so a crash in the middle never leaves a broken file behind.
+    [[nodiscard]] static bool writeAtomically(const std::string& file_path, const void* data, size_t size);
+
+private:
+    bool Opened = false;
+    const char* Data = nullptr;
+    size_t Size = 0;
+#ifdef _WIN32
+    void* FileHandle = nullptr;
+    void* MappingHandle = nullptr;
+#else
+    int FileDescriptor = -1;
+#endif
+};
\ No newline at end of file
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "mapped_file.h"
+
+// A binary blob of an interleaved vertex buffer and its index buffer, which is written next to the source mesh
+// and mapped on the later loads so that the mesh does not have to be parsed again.
+// The index buffer holds the full detail mesh followed by its coarser levels of detail, which share the vertices.
+// Loading does not touch the GL state, so meshes can be loaded on worker threads and uploaded on the context thread.
+class MeshCache final
+{
+public:
+    // The levels after the full detail one keep these ratios of the triangles.
+    static constexpr std::array<float, 3> LevelRatios = { 0.5f, 0.25f, 0.1f };
+    static constexpr int MaxLevelNum = static_cast<int>(LevelRatios.size()) + 1;
+
+    MeshCache() = default;
+    ~MeshCache() = default;
+
+    MeshCache(MeshCache&&) = delete;
+    MeshCache(const MeshCache&) = delete;
+    MeshCache& operator=(MeshCache&&) = delete;
+    MeshCache& operator=(const MeshCache&) = delete;
+
+    [[nodiscard]] bool open(const std::string& source_path);
+
+    // Maps the cache if it is valid. Otherwise, parses the source into memory, optimizes it for the vertex cache,
+    // simplifies it into the levels of detail and writes its cache for the next time.
+    [[nodiscard]] bool load(const std::string& source_path, int thread_num = 1);
+
+    // Loads the meshes concurrently on the thread pool, one task per mesh.
+    [[nodiscard]] static bool loadAll(
+        std::vector<std::unique_ptr<MeshCache>>& meshes,
+        const std::vector<std::string>& source_paths
+    );
+
+    void close()
+    {
+        File.close();
+        CacheHeader = nullptr;
+        VertexBuffer.clear();
+        Indices.clear();
+    }
+
+    [[nodiscard]] static std::string getCachePath(const std::string& source_path) { return source_path + ".glcmesh"; }
+    [[nodiscard]] static bool write(
+        const std::string& source_path,
+        const std::vector<GLfloat>& vertex_buffer,
+        const std::vector<GLuint>& indices,
+        const std::vector<size_t>& level_index_nums,
+        bool normals_exist,
+        bool textures_exist
+    );
+    [[nodiscard]] bool isMapped() const { return File.isOpen(); }
+    [[nodiscard]] bool normalsExist() const { return (CacheHeader->Flags & NormalsExist) != 0; }
+    [[nodiscard]] bool texturesExist() const { return (CacheHeader->Flags & TexturesExist) != 0; }
+    [[nodiscard]] GLsizei getVertexNum() const { return static_cast<GLsizei>(CacheHeader->VertexNum); }
+    [[nodiscard]] int getLevelNum() const { return static_cast<int>(CacheHeader->LevelNum); }
+
+    // The number of the indices of the level, whose indices follow the ones of all the finer levels.
+    [[nodiscard]] GLsizei getIndexNum(int level = 0) const
+    {
+        return static_cast<GLsizei>(CacheHeader->LevelIndexNums[level]);
+    }
+
+    [[nodiscard]] GLsizei getTotalIndexNum() const { return static_cast<GLsizei>(CacheHeader->IndexNum); }
+
+    [[nodiscard]] int getBytesPerVertex() const
+    {
+        return static_cast<int>(CacheHeader->FloatsPerVertex * sizeof( GLfloat ));
+    }
+
+    [[nodiscard]] const void* getVertexBuffer() const
+    {
+        return isMapped() ? static_cast<const void*>(File.getData() + CacheHeader->VertexOffset) : VertexBuffer.data();
+    }
+
+    [[nodiscard]] const void* getIndices() const
+    {
+        return isMapped() ? static_cast<const void*>(File.getData() + CacheHeader->IndexOffset) : Indices.data();
+    }
+
+private:
+    enum FLAG : uint32_t { NormalsExist = 1, TexturesExist = 2 };
+
+    struct Header
+    {
+        std::array<char, 8> Magic;
+        uint32_t Version;
+        uint32_t Flags;
+        uint64_t SourceSize;
+        int64_t SourceModifiedTime;
+        uint64_t SourceHash;
+        uint32_t VertexNum;
+        uint32_t FloatsPerVertex;
+        uint32_t IndexNum;
+        uint32_t LevelNum;
+        uint64_t VertexOffset;
+        uint64_t IndexOffset;
+        std::array<uint32_t, MaxLevelNum> LevelIndexNums;
+    };
+
+    // Bump the version whenever the layout or the content of the blob changes, so that the stale caches get rebuilt.
+    // Version 2 stores the meshes optimized for the vertex cache, and version 3 adds the levels of detail.
+    static constexpr uint32_t Version = 3;
+    static constexpr std::array<char, 8> Magic = { 'G', 'L', 'C', 'M', 'E', 'S', 'H', '\0' };
+
+    MappedFile File;
+    const Header* CacheHeader = nullptr;
+
+    // Without a valid cache, the parsed mesh is kept in memory and CacheHeader points to ParsedHeader.
+    Header ParsedHeader{};
+    std::vector<GLfloat> VertexBuffer;
+    std::vector<GLuint> Indices;
+
+    [[nodiscard]] static Header getHeader(
+        size_t float_num,
+        const std::vector<size_t>& level_index_nums,
+        bool normals_exist,
+        bool textures_exist
+    );
+    // is_touched tells that the source has only got a new modified time, and the cache is valid for it.
+    [[nodiscard]] bool isValid(const std::string& source_path, bool& is_touched) const;
+    [[nodiscard]] static bool refreshModifiedTime(const std::string& source_path);
+};
\ No newline at end of file
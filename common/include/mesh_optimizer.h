@@ -0,0 +1,47 @@
+#pragma once
+
+#include "base.h"
+
+// Reorders the triangle lists of indexed meshes for the post-transform vertex cache and the vertex fetch.
+// Neither pass changes what is drawn; only the order of the triangles and the numbering of the vertices change.
+class MeshOptimizer final
+{
+public:
+    MeshOptimizer() = delete;
+
+    // Tom Forsyth's linear-speed vertex cache optimization, which greedily emits the triangle whose vertices are
+    // the most recently used or have the fewest triangles left.
+    static void optimizeVertexCache(std::vector<GLuint>& indices, size_t vertex_num);
+
+    // Renumbers the vertices in the order the triangles first use them, so that the fetch walks the buffer forward.
+    // The vertices not referenced by any triangle are dropped.
+    static void optimizeVertexFetch(
+        std::vector<GLfloat>& vertex_buffer,
+        int floats_per_vertex,
+        std::vector<GLuint>& indices
+    );
+
+    // Runs both passes and reports the cache statistics before and after.
+    static void optimize(
+        std::vector<GLfloat>& vertex_buffer,
+        int floats_per_vertex,
+        std::vector<GLuint>& indices,
+        const std::string& name
+    );
+
+    // The average cache miss ratio is the transformed vertices per triangle, which is 0.5 at best on a regular grid
+    // and 3 at worst. The average transformed vertex ratio is the transformed vertices per vertex, which is 1 at best.
+    [[nodiscard]] static float getACMR(const std::vector<GLuint>& indices);
+    [[nodiscard]] static float getATVR(const std::vector<GLuint>& indices, size_t vertex_num);
+
+private:
+    // The cache is simulated as a FIFO of this size when the statistics are measured.
+    static constexpr int CacheSize = 32;
+    static constexpr float CacheDecayPower = 1.5f;
+    static constexpr float LastTriangleScore = 0.75f;
+    static constexpr float ValenceBoostScale = 2.0f;
+    static constexpr float ValenceBoostPower = 0.5f;
+
+    [[nodiscard]] static float getVertexScore(int cache_position, int live_triangle_num);
+    [[nodiscard]] static size_t getCacheMissNum(const std::vector<GLuint>& indices);
+};
\ No newline at end of file
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "base.h"
+
+// Simplifies indexed triangle lists by collapsing edges in the order of the quadric error metric of Garland and
+// Heckbert. A collapse moves a vertex onto one of its neighbors, so a simplified mesh reuses the vertex buffer of
+// the original one and only needs an index buffer of its own.
+class MeshSimplifier final
+{
+public:
+    MeshSimplifier() = delete;
+
+    // The vertices of the same position are simplified together, so that the attribute seams stay closed.
+    // The result has at most target_index_num indices unless no more edges can be collapsed without a flip.
+    [[nodiscard]] static std::vector<GLuint> simplify(
+        const std::vector<GLfloat>& vertex_buffer,
+        int floats_per_vertex,
+        const std::vector<GLuint>& indices,
+        size_t target_index_num
+    );
+
+private:
+    // The boundary edges are kept in place by planes perpendicular to them, weighted this much more than the faces.
+    static constexpr double BoundaryWeight = 10.0;
+
+    // A symmetric 4x4 matrix, which is the sum of the squared distances to the planes of the triangles around.
+    struct Quadric
+    {
+        std::array<double, 10> Values{};
+
+        void add(const glm::dvec3& normal, double distance, double weight);
+        Quadric& operator+=(const Quadric& other);
+        [[nodiscard]] double evaluate(const glm::dvec3& point) const;
+    };
+
+    struct Collapse
+    {
+        double Cost;
+        uint32_t From;
+        uint32_t To;
+        uint32_t FromVersion;
+        uint32_t ToVersion;
+
+        bool operator>(const Collapse& other) const { return Cost > other.Cost; }
+    };
+};
\ No newline at end of file
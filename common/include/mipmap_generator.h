@@ -0,0 +1,63 @@
+#pragma once
+
+#include "base.h"
+
+// Builds mip chains on the CPU, where the filter and the color space are under control unlike glGenerateTextureMipmap.
+// The levels are filtered from one another in floats, so the rounding of a level does not carry over to the next.
+class MipmapGenerator final
+{
+public:
+    // Box averages 2x2 pixels. Kaiser weights 6x6 pixels by a Kaiser-windowed sinc, which keeps the detail sharper.
+    enum FILTER { Box = 0, Kaiser };
+
+    MipmapGenerator() = delete;
+
+    // floor(log2(max(width, height))) + 1, which is every level down to 1x1.
+    [[nodiscard]] static int getLevelNum(int width, int height)
+    {
+        return static_cast<int>(std::bit_width( static_cast<unsigned>(std::max( { width, height, 1 } )) ));
+    }
+
+    // Fills levels with the levels after the base one of the tightly packed 8-bit pixels.
+    // With gamma_correct, the channels except the alpha of 4-channel pixels are decoded from sRGB before filtering,
+    // so that the levels do not get darker. With thread_num > 1, the rows of a level are split over the thread pool.
+    static void generate(
+        std::vector<std::vector<uint8_t>>& levels,
+        const uint8_t* pixels,
+        int width,
+        int height,
+        int channel_num,
+        FILTER filter,
+        bool gamma_correct,
+        int thread_num = 1
+    );
+
+private:
+    struct Kernel
+    {
+        // The taps of a destination pixel x start from the source pixel 2 * x + Offset.
+        int Offset;
+        std::vector<float> Weights;
+    };
+
+    // Levels with fewer rows than this are not worth splitting.
+    static constexpr int MinRowsPerTask = 32;
+
+    [[nodiscard]] static const Kernel& getKernel(FILTER filter);
+    [[nodiscard]] static const std::array<float, 256>& getLinearTable();
+    [[nodiscard]] static uint8_t encodeSRGB(float linear);
+    [[nodiscard]] static bool isGammaChannel(int channel, int channel_num, bool gamma_correct)
+    {
+        return gamma_correct && (channel_num != 4 || channel != 3);
+    }
+    static void downsampleRows(
+        std::vector<float>& destination,
+        const std::vector<float>& source,
+        int width,
+        int height,
+        int channel_num,
+        const Kernel& kernel,
+        int row_begin,
+        int row_end
+    );
+};
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "mapped_file.h"
+#include "mipmap_generator.h"
+
+// The full mip chain of an image built by MipmapGenerator, which is written next to the source image and mapped on
+// the later loads so that the image does not have to be decoded and filtered again.
+// Loading does not touch the GL state, so textures can be loaded on worker threads and uploaded on the context thread.
+class MipmappedTexture final
+{
+public:
+    // Enough levels for a 32768x32768 image.
+    static constexpr int MaxLevelNum = 16;
+
+    MipmappedTexture() = default;
+    ~MipmappedTexture() = default;
+
+    MipmappedTexture(MipmappedTexture&&) = delete;
+    MipmappedTexture(const MipmappedTexture&) = delete;
+    MipmappedTexture& operator=(MipmappedTexture&&) = delete;
+    MipmappedTexture& operator=(const MipmappedTexture&) = delete;
+
+    [[nodiscard]] bool open(const std::string& source_path, bool is_grayscale, MipmapGenerator::FILTER filter);
+
+    // Maps the cache if it is valid and was built the same way. Otherwise, decodes the source, filters its levels
+    // and writes the cache. The colors are filtered in linear space, and the grayscale images are taken as data.
+    [[nodiscard]] bool load(
+        const std::string& source_path,
+        bool is_grayscale = false,
+        MipmapGenerator::FILTER filter = MipmapGenerator::Kaiser,
+        int thread_num = 1
+    );
+
+    void close()
+    {
+        File.close();
+        Blob.clear();
+        CacheHeader = nullptr;
+    }
+
+    // Decodes into tightly packed rows, bottom-up as FreeImage has them, of 1 channel or 4 channels in BGRA.
+    [[nodiscard]] static bool decodeImage(
+        std::vector<uint8_t>& pixels,
+        int& width,
+        int& height,
+        const std::string& file_path,
+        bool is_grayscale
+    );
+
+    [[nodiscard]] static std::string getCachePath(const std::string& source_path) { return source_path + ".glcmip"; }
+    [[nodiscard]] bool isMapped() const { return File.isOpen(); }
+    [[nodiscard]] bool isGrayscale() const { return CacheHeader->ChannelNum == 1; }
+    [[nodiscard]] int getWidth() const { return static_cast<int>(CacheHeader->Width); }
+    [[nodiscard]] int getHeight() const { return static_cast<int>(CacheHeader->Height); }
+    [[nodiscard]] int getLevelNum() const { return static_cast<int>(CacheHeader->LevelNum); }
+    [[nodiscard]] int getLevelWidth(int level) const { return std::max( getWidth() >> level, 1 ); }
+    [[nodiscard]] int getLevelHeight(int level) const { return std::max( getHeight() >> level, 1 ); }
+
+    [[nodiscard]] const void* getLevelData(int level) const
+    {
+        const char* data = isMapped() ? File.getData() : reinterpret_cast<const char*>(Blob.data());
+        return data + CacheHeader->LevelOffsets[level];
+    }
+
+private:
+    struct Header
+    {
+        std::array<char, 8> Magic;
+        uint32_t Version;
+        uint32_t Filter;
+        uint32_t ChannelNum;
+        uint32_t Width;
+        uint32_t Height;
+        uint32_t LevelNum;
+        uint64_t SourceSize;
+        int64_t SourceModifiedTime;
+        uint64_t SourceHash;
+        std::array<uint64_t, MaxLevelNum> LevelOffsets;
+    };
+
+    // Bump the version whenever the layout or the filters change, so that the stale caches get rebuilt.
+    static constexpr uint32_t Version = 1;
+    static constexpr std::array<char, 8> Magic = { 'G', 'L', 'C', 'M', 'I', 'P', '\0', '\0' };
+
+    MappedFile File;
+    const Header* CacheHeader = nullptr;
+
+    // Without a valid cache, the levels are kept in memory as the blob the cache is written from.
+    std::vector<uint8_t> Blob;
+
+    [[nodiscard]] bool isValid(const std::string& source_path, int channel_num, MipmapGenerator::FILTER filter) const;
+};
\ No newline at end of file
@@ -1,11 +1,30 @@
 #pragma once
 
-#include "base.h"
+#include "camera.h"
+#include "mesh_cache.h"
+#include "vertex_quantizer.h"
+#include "vertex_layout.h"
+#include "ring_buffer.h"
+#include "mipmapped_texture.h"
+#include "compressed_texture.h"
+#include "texture_cache.h"
 
 class ObjectGL final
 {
 public:
     enum LayoutLocation { VertexLocation = 0, NormalLocation, TextureLocation };
+    static_assert(
+        PositionAttribute::Location == VertexLocation &&
+        NormalAttribute::Location == NormalLocation &&
+        TextureAttribute::Location == TextureLocation
+    );
+
+    // The compact formats apply to the meshes set from MeshCache. The octahedral normals arrive at the vertex shader
+    // as vec2, which it has to decode like VertexQuantizer::decodeOctahedral.
+    enum VERTEX_FORMAT { FullPrecision = 0, Compact2101010, CompactOctahedral };
+
+    // The index GL_PRIMITIVE_RESTART_FIXED_INDEX restarts a strip at, which no mesh of 32-bit indices reaches.
+    static constexpr GLuint RestartIndex = std::numeric_limits<GLuint>::max();
 
     ObjectGL() = default;
     ~ObjectGL();
@@ -37,6 +56,13 @@ public:
         SpecularReflectionExponent = specular_reflection_exponent;
     }
 
+    // When it is set, the setObject overloads receiving indices reorder the triangles and vertices of GL_TRIANGLES
+    // for the vertex cache. The meshes loaded through MeshCache are always optimized.
+    void setMeshOptimization(bool optimize) { OptimizeMesh = optimize; }
+
+    // It has to be set before the mesh is set.
+    void setVertexFormat(VERTEX_FORMAT format) { VertexFormat = format; }
+
     void setObject(GLenum draw_mode, int vertex_num);
     void setObject(GLenum draw_mode, const std::vector<glm::vec3>& vertices);
     void setObject(
@@ -44,6 +70,12 @@ public:
         const std::vector<glm::vec3>& vertices,
         const std::vector<glm::vec3>& normals
     );
+    void setObject(
+        GLenum draw_mode,
+        const std::vector<glm::vec3>& vertices,
+        const std::vector<glm::vec3>& normals,
+        const std::vector<GLuint>& indices
+    );
     void setObject(
         GLenum draw_mode,
         const std::vector<glm::vec3>& vertices,
@@ -91,7 +123,25 @@ public:
         const std::string& texture_file_path,
         bool is_grayscale = false
     );
+    void setObject(GLenum draw_mode, const MeshCache& mesh);
+
+    // Sets the base mesh of a morph-target sequence from ObjectReader::readMorphTargets, and uploads its deltas to a
+    // shader storage buffer, which the vertex shader indexes by the frame and gl_VertexID to blend two frames.
+    // The vertices keep their order to match the deltas, so only the triangles are reordered for the vertex cache.
+    void setMorphObject(
+        GLenum draw_mode,
+        const std::vector<glm::vec3>& vertices,
+        const std::vector<glm::vec3>& normals,
+        const std::vector<glm::vec2>& textures,
+        const std::vector<GLuint>& indices,
+        const std::vector<glm::vec4>& deltas
+    );
+    [[nodiscard]] bool setObjectFromFile(GLenum draw_mode, const std::string& file_path);
     void setSquareObject(GLenum draw_mode, bool use_texture = true);
+    // The rows of a grid of point_num.x by point_num.y row-major points as GL_TRIANGLE_STRIP indices, each row of
+    // 2 * point_num.x indices followed by RestartIndex but the last. With GL_PRIMITIVE_RESTART_FIXED_INDEX enabled,
+    // one glDrawElements draws the whole grid, and without it, the rows can be drawn by glMultiDrawElements.
+    [[nodiscard]] static std::vector<GLuint> getGridStripIndices(const glm::ivec2& point_num);
     void setSquareObject(
         GLenum draw_mode,
         const std::string& texture_file_path,
@@ -107,8 +157,87 @@ public:
     int addTexture(const std::string& texture_file_path, bool is_grayscale = false);
     void addTexture(int width, int height, bool is_grayscale = false);
     int addTexture(const uint8_t* image_buffer, int width, int height, bool is_grayscale = false);
+    // Uploads the levels filtered on the CPU instead of having the driver generate them.
+    int addTexture(const MipmappedTexture& texture);
+    // Filters the levels on all the hardware threads if the image does not have a valid cache of the filter yet.
+    int addTexture(const std::string& texture_file_path, MipmapGenerator::FILTER filter, bool is_grayscale = false);
+    // Uploads the encoded mip chain level by level, so the texture stays compressed in the video memory.
+    int addTexture(const CompressedTexture& texture);
+    // Encodes the image on all the hardware threads if it does not have a valid cache of the format yet.
+    int addTexture(const std::string& texture_file_path, BlockCompressor::FORMAT format);
+    // These take the texture from TextureCache if another object has added the same image, so it must not be updated.
+    int addSharedTexture(const std::string& texture_file_path, bool is_grayscale = false);
+    int addSharedTexture(const uint8_t* image_buffer, int width, int height, bool is_grayscale = false);
+    int addSharedTexture(const std::string& texture_file_path, BlockCompressor::FORMAT format);
     void addCubeTextures(const std::array<uint8_t*, 6>& textures, int width, int height);
+    // The faces are decoded at once on the thread pool, and then uploaded together on this thread.
     void addCubeTextures(const std::array<std::string, 6>& texture_paths);
+    // Packs the images into the layers of a 2D array texture in the order of the paths, so that all the instances of
+    // one draw can pick their images by a layer index. The images are decoded and rescaled to width x height at once
+    // on the thread pool, and the levels of each layer are filtered on the CPU as addTexture does.
+    int addTextureArray(
+        const std::vector<std::string>& texture_file_paths,
+        int width,
+        int height,
+        MipmapGenerator::FILTER filter
+    );
+    int addTextureArray(int width, int height, int layer_num);
+    // Creates the vertex buffer and the vertex array of the layout, and interleaves the streams, one per attribute,
+    // right into the mapped buffer.
+    template<typename Layout, typename... Streams>
+    void setVertices(GLenum draw_mode, size_t vertex_num, const Streams*... streams)
+    {
+        DrawMode = draw_mode;
+        VerticesCount = static_cast<GLsizei>(vertex_num);
+        glCreateBuffers( 1, &VBO );
+        glNamedBufferStorage(
+            VBO,
+            static_cast<GLsizeiptr>(Layout::Stride * vertex_num),
+            nullptr,
+            GL_DYNAMIC_STORAGE_BIT | GL_MAP_WRITE_BIT
+        );
+        updateVertices<Layout>( vertex_num, streams... );
+
+        glCreateVertexArrays( 1, &VAO );
+        glVertexArrayVertexBuffer( VAO, 0, VBO, 0, Layout::Stride );
+        Layout::setFormat( VAO );
+    }
+
+    // Rewrites the first vertex_num vertices, which makes no allocation on the way. With the vertex streaming on,
+    // they go to the next region of the ring buffer, and the vertex array is rebound to it.
+    template<typename Layout, typename... Streams>
+    void updateVertices(size_t vertex_num, const Streams*... streams)
+    {
+        assert( VBO != 0 );
+
+        VerticesCount = static_cast<GLsizei>(vertex_num);
+        if (vertex_num == 0) return;
+
+        if (VertexRing) {
+            assert( static_cast<GLsizeiptr>(Layout::Stride * vertex_num) <= VertexRing->getRegionSize() );
+
+            Layout::write( VertexRing->nextRegion(), vertex_num, streams... );
+            glVertexArrayVertexBuffer( VAO, 0, VertexRing->getBuffer(), VertexRing->getRegionOffset(), Layout::Stride );
+            return;
+        }
+
+        // The vertices after vertex_num are not drawn anymore, so the whole store is invalidated. This lets the driver
+        // orphan it for a fresh one instead of waiting for the draws still reading it, which a range would not.
+        void* buffer = glMapNamedBufferRange(
+            VBO,
+            0,
+            static_cast<GLsizeiptr>(Layout::Stride * vertex_num),
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT
+        );
+        Layout::write( buffer, vertex_num, streams... );
+        glUnmapNamedBuffer( VBO );
+    }
+
+    // Streams the later vertex updates through a ring buffer as large as the vertex buffer, so that an update does
+    // not have to wait for the draws still reading the previous vertices.
+    void setVertexStreaming(int frames_in_flight = 3);
+    [[nodiscard]] const RingBufferGL* getVertexRingBuffer() const { return VertexRing.get(); }
+
     void updateDataBuffer(const std::vector<glm::vec3>& vertices);
     void updateDataBuffer(const std::vector<glm::vec3>& vertices, const std::vector<glm::vec3>& normals);
     void updateDataBuffer(
@@ -116,12 +245,44 @@ public:
         const std::vector<glm::vec3>& normals,
         const std::vector<glm::vec2>& textures
     );
+    // Both overloads replace the base level and regenerate the lower levels from it.
     void updateTexture(const uint8_t* image_buffer, int index, int width, int height, GLenum format) const;
+
+    // Uploads the pixels written into the current region of the ring buffer, which the GPU then reads on its own time.
+    void updateTexture(RingBufferGL& pixels, int index, int width, int height, GLenum format) const;
     static void updateCubeTextures(const std::array<uint8_t*, 6>& textures, int width, int height);
+
+    // The current region of the ring buffer holds the six faces one after another in the order of the cube map.
+    static void updateCubeTextures(RingBufferGL& pixels, int width, int height);
     void replaceVertices(const std::vector<glm::vec3>& vertices, bool normals_exist, bool textures_exist);
     void replaceVertices(const std::vector<float>& vertices, bool normals_exist, bool textures_exist);
-    [[nodiscard]] static bool readObjectFile(std::vector<glm::vec3>& vertices, const std::string& file_path);
+    // thread_num > 1 parses a large file in parallel chunks, which gives the same result as the single-threaded one.
     [[nodiscard]] static bool readObjectFile(
+        std::vector<glm::vec3>& vertices,
+        const std::string& file_path,
+        int thread_num = 1
+    );
+    [[nodiscard]] static bool readObjectFile(
+        std::vector<glm::vec3>& vertices,
+        std::vector<glm::vec3>& normals,
+        std::vector<glm::vec2>& textures,
+        const std::string& file_path,
+        int thread_num = 1
+    );
+    [[nodiscard]] static bool readObjectFile(
+        std::vector<glm::vec3>& vertices,
+        std::vector<glm::vec3>& normals,
+        std::vector<glm::vec2>& textures,
+        std::vector<GLuint>& indices,
+        const std::string& file_path,
+        int thread_num = 1
+    );
+    [[nodiscard]] static bool readTextFile(
+        std::vector<glm::vec3>& vertices,
+        std::vector<glm::vec3>& normals,
+        const std::string& file_path
+    );
+    [[nodiscard]] static bool readTextFile(
         std::vector<glm::vec3>& vertices,
         std::vector<glm::vec3>& normals,
         std::vector<glm::vec2>& textures,
@@ -130,12 +291,14 @@ public:
     [[nodiscard]] static bool readTextFile(
         std::vector<glm::vec3>& vertices,
         std::vector<glm::vec3>& normals,
+        std::vector<GLuint>& indices,
         const std::string& file_path
     );
     [[nodiscard]] static bool readTextFile(
         std::vector<glm::vec3>& vertices,
         std::vector<glm::vec3>& normals,
         std::vector<glm::vec2>& textures,
+        std::vector<GLuint>& indices,
         const std::string& file_path
     );
     [[nodiscard]] GLuint getVAO() const { return VAO; }
@@ -143,6 +306,35 @@ public:
     [[nodiscard]] GLuint getIBO() const { return IBO; }
     [[nodiscard]] GLenum getDrawMode() const { return DrawMode; }
     [[nodiscard]] GLsizei getVertexNum() const { return VerticesCount; }
+    [[nodiscard]] GLsizei getIndexNum() const { return IndicesCount; }
+    [[nodiscard]] GLuint getMorphTargetBuffer() const { return MorphTargetBuffer; }
+    [[nodiscard]] int getMorphFrameNum() const { return MorphFrameNum; }
+
+    // The compact positions are normalized to the bounds of the mesh, so this has to be multiplied into the world
+    // matrix of the draws. It is the identity for the full precision format.
+    [[nodiscard]] const glm::mat4& getDequantizationMatrix() const { return DequantizationMatrix; }
+    [[nodiscard]] int getLevelNum() const { return static_cast<int>(LevelIndexNums.size()); }
+    [[nodiscard]] GLsizei getIndexNum(int level) const { return LevelIndexNums[level]; }
+
+    // The levels of detail share the index buffer, so it holds more indices than the finest level draws.
+    [[nodiscard]] GLsizei getTotalIndexNum() const
+    {
+        return LevelIndexNums.empty() ? IndicesCount : LevelIndexOffsets.back() + LevelIndexNums.back();
+    }
+
+    // The offset of the level in indices, to be passed to GeometryArenaGL::addDraw.
+    [[nodiscard]] GLsizei getFirstIndex(int level) const { return LevelIndexOffsets[level]; }
+
+    // The byte offset of the level in the index buffer, to be passed to glDrawElements.
+    [[nodiscard]] const void* getIndexOffset(int level) const
+    {
+        return reinterpret_cast<const void*>(static_cast<uintptr_t>(LevelIndexOffsets[level]) * sizeof( GLuint ));
+    }
+
+    // Takes the finest level whose triangles still cover MinPixelsPerTriangle pixels on average when the object
+    // is seen from the camera, or the coarsest one if none of them does. to_world is the world matrix of the draw,
+    // which includes the dequantization matrix.
+    [[nodiscard]] int selectLevelOfDetail(const CameraGL& camera, const glm::mat4& to_world) const;
     [[nodiscard]] GLuint getTextureID(int index) const { return TextureID[index]; }
     [[nodiscard]] int getTextureNum() const { return static_cast<int>(TextureID.size()); }
     [[nodiscard]] glm::vec4 getEmissionColor() const { return EmissionColor; }
@@ -179,16 +371,29 @@ public:
     }
 
 private:
+    static constexpr float MinPixelsPerTriangle = 4.0f;
+
     uint8_t* ImageBuffer = nullptr;
     GLuint VAO = 0;
     GLuint VBO = 0;
     GLuint IBO = 0;
+    GLuint MorphTargetBuffer = 0;
     GLenum DrawMode = 0;
     std::vector<GLfloat> DataBuffer;
     std::vector<GLuint> TextureID;
     std::vector<GLuint> CustomBuffers;
+    std::unique_ptr<RingBufferGL> VertexRing;
     std::map<GLuint, glm::ivec2> TextureIDToSize;
     GLsizei VerticesCount = 0;
+    GLsizei IndicesCount = 0;
+    int MorphFrameNum = 0;
+    bool OptimizeMesh = false;
+    VERTEX_FORMAT VertexFormat = FullPrecision;
+    glm::mat4 DequantizationMatrix{ 1.0f };
+    std::vector<GLsizei> LevelIndexOffsets;
+    std::vector<GLsizei> LevelIndexNums;
+    glm::vec3 BoundingCenter{ 0.0f };
+    float BoundingRadius = 0.0f;
     glm::vec4 EmissionColor{ 0.0f, 0.0f, 0.0f, 1.0f };
 
     // It is usually set to the same color with DiffuseReflectionColor.
@@ -200,10 +405,28 @@ private:
     float SpecularReflectionExponent = 0.0f;
 
     [[nodiscard]] bool prepareTexture2DUsingFreeImage(const std::string& file_path, bool is_grayscale);
+    int addTextureThroughCache(
+        const std::string& key,
+        const std::function<int()>& addNewTexture,
+        double bytes_per_pixel
+    );
     void prepareTexture(bool normals_exist) const;
     void prepareNormal() const;
     void prepareVertexBuffer(int n_bytes_per_vertex);
+    void prepareVertexBuffer(int n_bytes_per_vertex, const void* data, GLsizeiptr size);
     void prepareIndexBuffer(const std::vector<GLuint>& indices);
+    void prepareIndexBuffer(const void* indices, GLsizei index_num);
+    void prepareIndexedBuffers(int floats_per_vertex, const std::vector<GLuint>& indices);
+    void prepareQuantizedVertexBuffer(const std::vector<uint8_t>& quantized, bool normals_exist, bool textures_exist);
+    void prepareIndexedObject(
+        GLenum draw_mode,
+        const void* vertex_buffer,
+        GLsizei vertex_num,
+        const void* indices,
+        GLsizei index_num,
+        bool normals_exist,
+        bool textures_exist
+    );
     static void getSquareObject(
         std::vector<glm::vec3>& vertices,
         std::vector<glm::vec3>& normals,
@@ -0,0 +1,167 @@
+#pragma once
+
+#include "base.h"
+
+class ObjectReader final
+{
+public:
+    struct ObjectData
+    {
+        std::vector<glm::vec3> Vertices;
+        std::vector<glm::vec3> Normals;
+        std::vector<glm::vec2> Textures;
+
+        // zero-based (vertex, texture, normal) indices of each triangle corner, -1 if the corner does not have one.
+        std::vector<glm::ivec3> Corners;
+    };
+
+    ObjectReader() = delete;
+
+    // With thread_num > 1, a large file is split into newline-aligned chunks which are parsed on the thread pool.
+    // The result is identical to the single-threaded one.
+    [[nodiscard]] static bool parseObject(ObjectData& data, const char* begin, const char* end, int thread_num = 1);
+    [[nodiscard]] static bool readObjectFile(ObjectData& data, const std::string& file_path, int thread_num = 1);
+
+    // The text format is the polygon number followed by the polygons, each of which is its vertex number and the
+    // vertices of (position, normal) or (position, normal, texture). Polygons with more vertices are fanned out.
+    [[nodiscard]] static bool readTextFile(
+        std::vector<glm::vec3>& vertices,
+        std::vector<glm::vec3>& normals,
+        const std::string& file_path
+    );
+    [[nodiscard]] static bool readTextFile(
+        std::vector<glm::vec3>& vertices,
+        std::vector<glm::vec3>& normals,
+        std::vector<glm::vec2>& textures,
+        const std::string& file_path
+    );
+
+    // The text format does not say which attributes it has, so the first vertex line tells it.
+    [[nodiscard]] static bool textFileHasTextures(const std::string& file_path);
+
+    // Reads a .txt or .obj file into welded vertices, leaving normals and textures empty if the file has none.
+    [[nodiscard]] static bool readMeshFile(
+        std::vector<glm::vec3>& vertices,
+        std::vector<glm::vec3>& normals,
+        std::vector<glm::vec2>& textures,
+        std::vector<GLuint>& indices,
+        const std::string& file_path,
+        int thread_num = 1
+    );
+
+    // Reads the frames of a vertex-animated text sequence, which share the polygons and differ only in the vertices.
+    // The first frame is welded into the base mesh, and deltas gets the (position, normal) differences of the other
+    // frames from it, a pair per base vertex and frame after frame. Corners are merged only if they agree in every
+    // frame, so that a delta belongs to a single vertex.
+    [[nodiscard]] static bool readMorphTargets(
+        std::vector<glm::vec3>& vertices,
+        std::vector<glm::vec3>& normals,
+        std::vector<glm::vec2>& textures,
+        std::vector<GLuint>& indices,
+        std::vector<glm::vec4>& deltas,
+        const std::vector<std::string>& frame_paths
+    );
+
+    // Merges the corners sharing the same (vertex, normal, texture) into one vertex and builds the index buffer.
+    // normals and textures can be empty if the mesh does not have them.
+    static void weldVertices(
+        std::vector<glm::vec3>& vertices,
+        std::vector<glm::vec3>& normals,
+        std::vector<glm::vec2>& textures,
+        std::vector<GLuint>& indices
+    );
+    static void reportWelding(const std::string& file_path, size_t corner_num, size_t vertex_num);
+
+private:
+    struct ChunkData
+    {
+        ObjectData Data;
+
+        // (corner * 3 + component) of the negative indices, which count from the first elements of this chunk.
+        std::vector<uint32_t> RelativeIndices;
+        const char* ErrorLine = nullptr;
+    };
+
+    // Chunks smaller than this are not worth a task of their own.
+    static constexpr size_t MinChunkSize = 1 << 20;
+
+    struct VertexKey
+    {
+        glm::vec3 Vertex;
+        glm::vec3 Normal;
+        glm::vec2 Texture;
+
+        bool operator==(const VertexKey&) const = default;
+    };
+
+    struct VertexKeyHash
+    {
+        size_t operator()(const VertexKey& key) const
+        {
+            const std::array<float, 8> values = {
+                key.Vertex.x, key.Vertex.y, key.Vertex.z,
+                key.Normal.x, key.Normal.y, key.Normal.z,
+                key.Texture.x, key.Texture.y
+            };
+            size_t hash = 14695981039346656037ull;
+            for (const auto& value : values) {
+                // adding 0 makes -0 and +0 hash the same as they compare equal.
+                hash ^= std::bit_cast<uint32_t>( value + 0.0f );
+                hash *= 1099511628211ull;
+            }
+            return hash;
+        }
+    };
+
+    [[nodiscard]] static bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+    [[nodiscard]] static const char* skipSpaces(const char* ptr, const char* end)
+    {
+        while (ptr < end && isSpace( *ptr )) ++ptr;
+        return ptr;
+    }
+
+    [[nodiscard]] static bool isKeyword(const char* ptr, const char* end, std::string_view keyword)
+    {
+        const auto length = static_cast<std::ptrdiff_t>(keyword.size());
+        return end - ptr > length && std::equal( keyword.begin(), keyword.end(), ptr ) && isSpace( ptr[length] );
+    }
+
+    // Unlike the object format, the values of the text format can be split by any whitespace including newlines.
+    template<typename T>
+    [[nodiscard]] static bool parseValue(const char*& ptr, const char* end, T& value)
+    {
+        while (ptr < end && (isSpace( *ptr ) || *ptr == '\n')) ++ptr;
+        if (ptr < end && *ptr == '+') ++ptr;
+
+        const auto [next, error] = std::from_chars( ptr, end, value );
+        if (error != std::errc()) return false;
+        ptr = next;
+        return true;
+    }
+
+    [[nodiscard]] static bool parseFloat(const char*& ptr, const char* end, float& value);
+    [[nodiscard]] static bool parseIndex(const char*& ptr, const char* end, int count, int& index, bool& relative);
+    [[nodiscard]] static bool parseCorner(
+        const char*& ptr,
+        const char* end,
+        const ObjectData& data,
+        glm::ivec3& corner,
+        glm::bvec3& relative
+    );
+    static void addCorner(ChunkData& chunk, const glm::ivec3& corner, const glm::bvec3& relative);
+    [[nodiscard]] static bool parseFace(const char* ptr, const char* end, ChunkData& chunk);
+    static void parseChunk(ChunkData& chunk, const char* begin, const char* end);
+    [[nodiscard]] static std::vector<const char*> splitIntoChunks(const char* begin, const char* end, int thread_num);
+    static void mergeChunks(ObjectData& data, std::vector<ChunkData>& chunks);
+    [[nodiscard]] static bool hasValidIndices(const ObjectData& data);
+    [[nodiscard]] static bool textHasTextures(const char* begin, const char* end);
+    [[nodiscard]] static bool parseText(
+        std::vector<glm::vec3>& vertices,
+        std::vector<glm::vec3>& normals,
+        std::vector<glm::vec2>& textures,
+        bool textures_exist,
+        const char* begin,
+        const char* end
+    );
+};
\ No newline at end of file
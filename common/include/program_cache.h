@@ -0,0 +1,61 @@
+#pragma once
+
+#include "mapped_file.h"
+
+// Keeps the binaries of the linked programs on disk, so that the later launches skip compiling and linking them.
+// A binary is looked up by a hash of the sources of all its stages, the renderer and the driver version, because
+// a binary is only good for the driver that made it. A driver can still refuse a binary, or a file can be broken,
+// and then the program is just built from the sources again and its binary is written over the old one.
+class ProgramCache final
+{
+public:
+    struct Stage
+    {
+        GLenum Type;
+        std::string Source;
+
+        // The file of each source string number of the #line directives, which the compile logs refer to.
+        // It is not part of the key, as the source already says everything that was compiled.
+        std::vector<std::string> Files;
+    };
+
+    ProgramCache() = delete;
+
+    // The sources should be the final ones given to glShaderSource, so that anything added to them is in the key.
+    [[nodiscard]] static uint64_t getKey(const std::vector<Stage>& stages);
+
+    // Links the program from the binary of the key. If it returns false, the program may be left in a failed state.
+    [[nodiscard]] static bool load(GLuint program, uint64_t key);
+
+    // The program must have been linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set.
+    static void save(GLuint program, uint64_t key);
+
+    // Some drivers expose no binary format at all, and then there is nothing to cache.
+    [[nodiscard]] static bool isSupported();
+
+    [[nodiscard]] static std::string getCacheDirectory() { return std::string( CMAKE_SOURCE_DIR ) + "/shader_cache"; }
+
+    [[nodiscard]] static std::string getCachePath(uint64_t key)
+    {
+        std::ostringstream path;
+        path << getCacheDirectory() << "/" << std::hex << std::setw( 16 ) << std::setfill( '0' ) << key << ".glcprog";
+        return path.str();
+    }
+
+private:
+    struct Header
+    {
+        std::array<char, 8> Magic;
+        uint32_t Version;
+        uint32_t BinaryFormat;
+        uint64_t Key;
+        uint64_t BinarySize;
+        uint64_t BinaryHash;
+    };
+
+    // Bump the version whenever the layout of the file changes.
+    static constexpr uint32_t Version = 1;
+    static constexpr std::array<char, 8> Magic = { 'G', 'L', 'C', 'P', 'R', 'O', 'G', '\0' };
+
+    [[nodiscard]] static bool isFormatSupported(GLenum format);
+};
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "camera.h"
 #include "canvas.h"
 #include "object.h"
+#include "draw_data.h"
 
 class RendererGL
 {
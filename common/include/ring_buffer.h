@@ -0,0 +1,68 @@
+#pragma once
+
+#include "base.h"
+
+// A persistently mapped buffer split into regions, one per frame in flight. The CPU writes one region while the GPU
+// still reads the others, and a fence keeps a region from being handed out again before the GPU is done with it.
+// It can feed vertex data or GL_PIXEL_UNPACK_BUFFER uploads, and with GL_MAP_READ_BIT it can take GL_PIXEL_PACK_BUFFER
+// read-backs, which have to wait for their region before reading it.
+class RingBufferGL final
+{
+public:
+    explicit RingBufferGL(GLsizeiptr region_size, int region_num = 3, GLbitfield access = GL_MAP_WRITE_BIT);
+    ~RingBufferGL();
+
+    RingBufferGL(RingBufferGL&&) = delete;
+    RingBufferGL(const RingBufferGL&) = delete;
+    RingBufferGL& operator=(RingBufferGL&&) = delete;
+    RingBufferGL& operator=(const RingBufferGL&) = delete;
+
+    // Fences the region handed out last, which covers every command issued on it so far, and hands out the next one
+    // after waiting for its own fence if the GPU has not finished it yet.
+    [[nodiscard]] uint8_t* nextRegion();
+
+    // Fences the current region and waits for it, so that what the GPU wrote into it can be read.
+    void waitForCurrentRegion();
+
+    [[nodiscard]] GLuint getBuffer() const { return Buffer; }
+    [[nodiscard]] GLsizeiptr getRegionSize() const { return RegionSize; }
+    [[nodiscard]] GLintptr getRegionOffset() const { return static_cast<GLintptr>(CurrentRegion) * RegionSize; }
+
+    // The offset of the current region as the pointer argument of the pixel transfer calls.
+    [[nodiscard]] const void* getRegionPointer() const
+    {
+        return reinterpret_cast<const void*>(static_cast<uintptr_t>(getRegionOffset()));
+    }
+
+    // Records a transfer out of the regions, and how long it took to issue, for the throughput report.
+    void addTransfer(GLsizeiptr bytes, double issue_time_in_ms)
+    {
+        TransferredBytes += bytes;
+        TransferIssueTime += issue_time_in_ms;
+    }
+
+    [[nodiscard]] int getRegionRequestNum() const { return RegionRequestNum; }
+    [[nodiscard]] int getFenceWaitNum() const { return FenceWaitNum; }
+    [[nodiscard]] double getFenceWaitTime() const { return FenceWaitTime; }
+    void printStatistics(const std::string& name) const;
+
+private:
+    // The offsets of the regions meet the strictest alignment of the buffer bindings.
+    static constexpr GLsizeiptr RegionAlignment = 256;
+
+    GLuint Buffer = 0;
+    GLsizeiptr RegionSize;
+    int CurrentRegion = -1;
+    int RegionRequestNum = 0;
+    int FenceWaitNum = 0;
+    double FenceWaitTime = 0.0;
+    double TransferIssueTime = 0.0;
+    GLsizeiptr TransferredBytes = 0;
+    std::chrono::steady_clock::time_point FirstRequestTime;
+    std::chrono::steady_clock::time_point LastRequestTime;
+    uint8_t* MappedData = nullptr;
+    std::vector<GLsync> Fences;
+
+    void fenceCurrentRegion();
+    void waitForFence(int region);
+};
\ No newline at end of file
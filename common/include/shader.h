@@ -1,24 +1,10 @@
 ﻿#pragma once
 
-#include "base.h"
+#include "program_cache.h"
 
 class ShaderGL
 {
 public:
-    enum LIGHT_UNIFORM
-    {
-        LightSwitch = 0,
-        LightPosition,
-        LightAmbientColor,
-        LightDiffuseColor,
-        LightSpecularColor,
-        SpotlightDirection,
-        SpotlightCutoffAngle,
-        SpotlightFeather,
-        FallOffRadius,
-        UniformNum
-    };
-
     enum MATERIAL_UNIFORM
     {
         EmissionColor = 0,
@@ -45,6 +31,26 @@ public:
     );
     void setComputeShader(const char* compute_shader_path);
 
+    // Adds a #define right after the #version of every stage of the next setShader() or setComputeShader(), so that
+    // the sizes and counts a program is made for are constants to the compiler. A name added again takes the new
+    // value. The defines are part of the sources, so each variant of a file gets its own binary in ProgramCache.
+    void addDefine(const std::string& name, const std::string& value = "");
+    void addDefine(const std::string& name, int value) { addDefine( name, std::to_string( value ) ); }
+
+    // The programs are only submitted by setShader() and setComputeShader(), and the driver compiles and links them
+    // on its own threads where GL_KHR_parallel_shader_compile is supported. Using a program before it is ready is
+    // still correct, as the driver waits for it then. This finishes the programs whose links have completed, which
+    // reports their errors, caches their binaries and frees their shaders. It never waits, and returns true once no
+    // program is pending. Without the extension, asking the status is what waits, so it finishes them all at once.
+    static bool pollPrograms();
+
+    // Waits for the pending programs, and prints how long the programs set so far took to be ready and how many of
+    // them came from ProgramCache, then starts counting again. The samples call it after the rest of their setup,
+    // which then overlaps with the compilation.
+    static void reportProgramSetup();
+
+    [[nodiscard]] static bool isParallelCompileSupported();
+
     void uniform1i(int location, int value) const
     {
         glProgramUniform1i( ShaderProgram, location, value );
@@ -138,10 +144,57 @@ public:
     [[nodiscard]] GLuint getShaderProgram() const { return ShaderProgram; }
 
 protected:
+    struct SetupStatistics
+    {
+        int ProgramNum;
+        int CachedProgramNum;
+        int FailedProgramNum;
+        double SubmitMilliseconds;
+        std::chrono::steady_clock::time_point FirstSubmitTime;
+        std::chrono::steady_clock::time_point LastReadyTime;
+    };
+
+    // A program submitted from the sources, whose shaders stay until the link is done to tell what went wrong.
+    struct PendingProgram
+    {
+        ShaderGL* Shader;
+        uint64_t Key;
+        bool CacheBinary;
+        std::vector<GLenum> ShaderTypes;
+        std::vector<GLuint> Shaders;
+        std::vector<std::vector<std::string>> StageFiles;
+    };
+
+    // The bundled glad only loads the core profile, which does not have this of GL_KHR_parallel_shader_compile.
+    static constexpr GLenum CompletionStatus = 0x91B1;
+
+    inline static SetupStatistics Statistics{};
+    inline static std::vector<PendingProgram> PendingPrograms;
+
+    // The files read so far, so that a file shared by many programs is read only once.
+    inline static std::unordered_map<std::string, std::string> FileContents;
+
     GLuint ShaderProgram = 0;
+    std::vector<std::pair<std::string, std::string>> Defines;
 
     static void readShaderFile(std::string& shader_contents, const char* shader_path);
+    [[nodiscard]] static const std::string& getShaderFile(const std::string& shader_path);
     [[nodiscard]] static std::string getShaderTypeString(GLenum shader_type);
     [[nodiscard]] static bool checkCompileError(GLenum shader_type, const GLuint& shader);
-    [[nodiscard]] static GLuint getCompiledShader(GLenum shader_type, const char* shader_path);
+    [[nodiscard]] static bool checkLinkError(const GLuint& program);
+    [[nodiscard]] static GLuint getCompiledShader(GLenum shader_type, const std::string& shader_source);
+    void addStage(std::vector<ProgramCache::Stage>& stages, GLenum shader_type, const char* shader_path) const;
+
+    // Appends the file to the source of the stage with its #include directives replaced by the included files.
+    // An included file is looked for next to the file including it first, and then in common/shaders. Every file is
+    // included once as if it had #pragma once, and the #line directives keep the compile logs pointing at the files.
+    void preprocess(ProgramCache::Stage& stage, const std::filesystem::path& shader_path) const;
+    static void finishProgram(const PendingProgram& pending);
+
+    // Lets the driver pick its number of compiler threads, once before the first program is compiled.
+    static void enableParallelCompile();
+
+    // Links the program from its cached binary if there is a valid one, or else submits the stages to be compiled
+    // and linked, and pollPrograms() caches the binary for the next time once the link is done.
+    void linkProgram(const std::vector<ProgramCache::Stage>& stages);
 };
\ No newline at end of file
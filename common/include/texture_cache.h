@@ -0,0 +1,59 @@
+#pragma once
+
+#include "base.h"
+
+// Shares the GL textures of the same image between the objects, keyed by the source file or the pixel content.
+// A shared texture is deleted when its last object releases it. It must not be updated in place, because every
+// object holding it would see the change. Only the context thread uses the cache, so it does not need a lock.
+class TextureCache final
+{
+public:
+    struct Entry
+    {
+        GLuint TextureID = 0;
+        glm::ivec2 Size = glm::ivec2( 0 );
+        size_t Bytes = 0;
+        int ReferenceNum = 0;
+    };
+
+    TextureCache() = default;
+    ~TextureCache() = default;
+
+    TextureCache(TextureCache&&) = delete;
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(TextureCache&&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+
+    [[nodiscard]] static TextureCache& getInstance()
+    {
+        static TextureCache cache;
+        return cache;
+    }
+
+    // variant tells apart the textures made differently from the same source, such as the grayscale ones.
+    [[nodiscard]] static std::string getFileKey(const std::string& file_path, const std::string& variant);
+    [[nodiscard]] static std::string getContentKey(const uint8_t* buffer, size_t size, const std::string& variant);
+
+    // Returns the entry with one more reference, or nullptr if the key is not cached yet.
+    [[nodiscard]] const Entry* acquire(const std::string& key);
+
+    // The cache takes the texture over with a single reference.
+    void insert(const std::string& key, GLuint texture_id, const glm::ivec2& size, size_t bytes);
+
+    // Drops a reference and deletes the texture with the last one.
+    // Returns false if the texture is not shared, so the caller still owns it.
+    [[nodiscard]] bool release(GLuint texture_id);
+
+    [[nodiscard]] int getHitNum() const { return HitNum; }
+    [[nodiscard]] int getMissNum() const { return MissNum; }
+    [[nodiscard]] int getTextureNum() const { return static_cast<int>(Entries.size()); }
+    void printStatistics() const;
+
+private:
+    int HitNum = 0;
+    int MissNum = 0;
+    size_t ResidentBytes = 0;
+    size_t SavedBytes = 0;
+    std::unordered_map<std::string, Entry> Entries;
+    std::unordered_map<GLuint, std::string> TextureIDToKey;
+};
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "base.h"
+
+// A fixed set of worker threads for the CPU-side loading work.
+// A task must not wait on another task of the same pool, or all workers can end up waiting.
+class ThreadPool final
+{
+public:
+    explicit ThreadPool(int thread_num = getHardwareThreadNum());
+    ~ThreadPool();
+
+    ThreadPool(ThreadPool&&) = delete;
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(ThreadPool&&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    [[nodiscard]] static ThreadPool& getInstance()
+    {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    [[nodiscard]] static int getHardwareThreadNum()
+    {
+        return std::max( static_cast<int>(std::thread::hardware_concurrency()), 1 );
+    }
+
+    [[nodiscard]] int getThreadNum() const { return static_cast<int>(Workers.size()); }
+
+    // The work that splits itself into tasks checks this and runs in one piece on a worker instead of waiting there.
+    [[nodiscard]] static bool isWorkerThread() { return IsWorker; }
+
+    template<typename F>
+    [[nodiscard]] std::future<std::invoke_result_t<F>> submit(F&& task)
+    {
+        using R = std::invoke_result_t<F>;
+        auto packaged_task = std::make_shared<std::packaged_task<R()>>( std::forward<F>( task ) );
+        std::future<R> result = packaged_task->get_future();
+        {
+            std::lock_guard<std::mutex> lock( Mutex );
+            Tasks.emplace( [packaged_task]() { (*packaged_task)(); } );
+        }
+        Condition.notify_one();
+        return result;
+    }
+
+private:
+    inline static thread_local bool IsWorker = false;
+    bool Stop = false;
+    std::mutex Mutex;
+    std::condition_variable Condition;
+    std::queue<std::function<void()>> Tasks;
+    std::vector<std::thread> Workers;
+
+    void work();
+};
\ No newline at end of file
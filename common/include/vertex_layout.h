@@ -0,0 +1,60 @@
+#pragma once
+
+#include "base.h"
+
+// An attribute of an interleaved vertex, which is a float vector bound to the shader location.
+template<typename T, GLuint location>
+struct VertexAttribute
+{
+    static_assert( std::is_same_v<typename T::value_type, GLfloat>, "The attributes are float vectors." );
+
+    using Type = T;
+    static constexpr GLuint Location = location;
+    static constexpr GLint ComponentNum = T::length();
+};
+
+// The locations follow ObjectGL::LayoutLocation.
+using PositionAttribute = VertexAttribute<glm::vec3, 0>;
+using NormalAttribute = VertexAttribute<glm::vec3, 1>;
+using TextureAttribute = VertexAttribute<glm::vec2, 2>;
+
+// Describes an interleaved vertex at compile time, so that the stride and the VAO format come from the attribute list
+// and the vertices can be written straight into a mapped buffer without a staging copy.
+template<typename... Attributes>
+class VertexLayout final
+{
+public:
+    static constexpr GLsizei Stride = static_cast<GLsizei>((sizeof( typename Attributes::Type ) + ...));
+
+    VertexLayout() = delete;
+
+    static void setFormat(GLuint vao, GLuint binding_index = 0)
+    {
+        GLuint offset = 0;
+        (setAttributeFormat<Attributes>( vao, binding_index, offset ), ...);
+    }
+
+    // Interleaves vertex_num vertices of the streams, one per attribute, into destination.
+    static void write(void* destination, size_t vertex_num, const typename Attributes::Type*... streams)
+    {
+        auto* ptr = static_cast<uint8_t*>(destination);
+        for (size_t i = 0; i < vertex_num; ++i) {
+            ((std::memcpy( ptr, streams + i, sizeof( typename Attributes::Type ) ),
+                ptr += sizeof( typename Attributes::Type )), ...);
+        }
+    }
+
+private:
+    template<typename Attribute>
+    static void setAttributeFormat(GLuint vao, GLuint binding_index, GLuint& offset)
+    {
+        glVertexArrayAttribFormat( vao, Attribute::Location, Attribute::ComponentNum, GL_FLOAT, GL_FALSE, offset );
+        glEnableVertexArrayAttrib( vao, Attribute::Location );
+        glVertexArrayAttribBinding( vao, Attribute::Location, binding_index );
+        offset += sizeof( typename Attribute::Type );
+    }
+};
+
+using PositionLayout = VertexLayout<PositionAttribute>;
+using PositionNormalLayout = VertexLayout<PositionAttribute, NormalAttribute>;
+using PositionNormalTextureLayout = VertexLayout<PositionAttribute, NormalAttribute, TextureAttribute>;
\ No newline at end of file
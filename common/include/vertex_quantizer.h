@@ -0,0 +1,58 @@
+#pragma once
+
+#include "base.h"
+
+// Packs interleaved float vertices into a compact layout of 16 bytes at most, which is
+// position: 4 x 16-bit normalized integers (the last one is padding), relative to the bounds of the mesh
+// normal: GL_INT_2_10_10_10_REV or 2 x 16-bit normalized integers of the octahedral encoding
+// texture: 2 x half floats
+class VertexQuantizer final
+{
+public:
+    enum NORMAL_ENCODING { Int2101010 = 0, Octahedral };
+
+    struct Error
+    {
+        float Position; // the largest distance in the object space
+        float Normal; // the largest angle in degrees
+        float Texture; // the largest difference of a coordinate
+    };
+
+    VertexQuantizer() = delete;
+
+    static constexpr int PositionBytes = 4 * sizeof( int16_t );
+    static constexpr int NormalBytes = sizeof( uint32_t );
+    static constexpr int TextureBytes = sizeof( uint32_t );
+
+    [[nodiscard]] static int getBytesPerVertex(bool normals_exist, bool textures_exist)
+    {
+        return PositionBytes + (normals_exist ? NormalBytes : 0) + (textures_exist ? TextureBytes : 0);
+    }
+
+    // Returns the dequantization matrix, which maps the normalized positions back to the object space.
+    // Its scale is uniform, so that it can be multiplied into the world matrix without skewing the normals.
+    [[nodiscard]] static glm::mat4 quantize(
+        std::vector<uint8_t>& quantized,
+        const GLfloat* vertex_buffer,
+        size_t vertex_num,
+        bool normals_exist,
+        bool textures_exist,
+        NORMAL_ENCODING encoding
+    );
+
+    // Decodes the quantized vertices again and measures how far they are from the original ones.
+    // It is too slow for the load path, so vertex_quantizer_test checks the sample meshes with it instead.
+    [[nodiscard]] static Error measureError(
+        const std::vector<uint8_t>& quantized,
+        const glm::mat4& dequantization,
+        const GLfloat* vertex_buffer,
+        size_t vertex_num,
+        bool normals_exist,
+        bool textures_exist,
+        NORMAL_ENCODING encoding
+    );
+
+    // The vertex shader has to decode the octahedral normal with the same mapping as this.
+    [[nodiscard]] static glm::vec2 encodeOctahedral(const glm::vec3& normal);
+    [[nodiscard]] static glm::vec3 decodeOctahedral(const glm::vec2& encoded);
+};
\ No newline at end of file
@@ -0,0 +1,54 @@
+// The terms of the Blinn-Phong lighting shared by the lighting shaders. The including shader declares Lights and the
+// global Material before this, and keeps the loop over its lights, which is what differs between the samples.
+
+const float zero = 0.0f;
+const float one = 1.0f;
+const float half_pi = 1.57079632679489661923132169163975144f;
+
+bool IsPointLight(in vec4 light_position)
+{
+    return light_position.w != zero;
+}
+
+float getAttenuation(in vec3 light_vector, in int light_index)
+{
+    float squared_distance = dot( light_vector, light_vector );
+    float distance = sqrt( squared_distance );
+    float radius = Lights[light_index].FallOffRadius;
+    if (distance <= radius) return one;
+
+    return clamp( radius * radius / squared_distance, zero, one );
+}
+
+float getSpotlightFactor(in vec3 normalized_light_vector, in vec3 spotlight_direction, in int light_index)
+{
+    if (Lights[light_index].SpotlightCutoffAngle >= 180.0f) return one;
+
+    float factor = dot( -normalized_light_vector, spotlight_direction );
+    float cutoff_angle = radians( clamp( Lights[light_index].SpotlightCutoffAngle, zero, 90.0f ) );
+    if (factor >= cos( cutoff_angle )) {
+        float normalized_angle = acos( factor ) * half_pi / cutoff_angle;
+        float threshold = half_pi * (one - Lights[light_index].SpotlightFeather);
+        return normalized_angle <= threshold ?
+            one :
+            cos( half_pi * (normalized_angle - threshold) / (half_pi - threshold) );
+    }
+    return zero;
+}
+
+// The ambient, diffuse and specular colors of the light on the material. The vectors are normalized, and the light
+// vector and the view vector point away from the surface.
+vec4 getBlinnPhongColor(in vec3 light_vector, in vec3 normal, in vec3 view_vector, in int light_index)
+{
+    vec4 color = Lights[light_index].AmbientColor * Material.AmbientColor;
+
+    float diffuse_intensity = max( dot( normal, light_vector ), zero );
+    color += diffuse_intensity * Lights[light_index].DiffuseColor * Material.DiffuseColor;
+
+    vec3 halfway_vector = normalize( light_vector + view_vector );
+    float specular_intensity = max( dot( normal, halfway_vector ), zero );
+    color +=
+        pow( specular_intensity, Material.SpecularExponent ) *
+        Lights[light_index].SpecularColor * Material.SpecularColor;
+    return color;
+}
\ No newline at end of file
@@ -0,0 +1,18 @@
+// The entries of DrawDataGL, which a draw finds by its base instance.
+
+struct MaterialInfo
+{
+    vec4 EmissionColor;
+    vec4 AmbientColor;
+    vec4 DiffuseColor;
+    vec4 SpecularColor;
+    float SpecularExponent;
+};
+struct DrawInfo
+{
+    mat4 WorldMatrix;
+    mat4 ViewMatrix;
+    mat4 ModelViewProjectionMatrix;
+    MaterialInfo Material;
+};
+layout (binding = 4, std430) readonly buffer DrawBlock { DrawInfo Draws[]; };
\ No newline at end of file
@@ -0,0 +1,24 @@
+// The light buffer of LightGL. MAX_LIGHTS is added by the program as LightGL::MaxLightNum.
+
+#ifndef MAX_LIGHTS
+#error MAX_LIGHTS has to be defined by the program
+#endif
+
+struct LightInfo
+{
+    vec4 Position;
+    vec4 AmbientColor;
+    vec4 DiffuseColor;
+    vec4 SpecularColor;
+    vec3 SpotlightDirectionInEC;
+    float SpotlightCutoffAngle;
+    int LightSwitch;
+    float SpotlightFeather;
+    float FallOffRadius;
+};
+layout (binding = 0, std140) uniform LightBlock
+{
+    vec4 GlobalAmbient;
+    int LightNum;
+    LightInfo Lights[MAX_LIGHTS];
+};
\ No newline at end of file
@@ -0,0 +1,209 @@
+#include "asset_loader.h"
+
+AssetLoader::AssetLoader(double upload_budget_in_ms, int max_uploads_per_frame) :
+    UploadBudgetInMs( upload_budget_in_ms ), MaxUploadsPerFrame( std::max( max_uploads_per_frame, 1 ) )
+{
+}
+
+AssetLoader::~AssetLoader()
+{
+    // The reads can refer to what their requester owns, so they have to finish before it goes away.
+    for (const auto& request : Requests) {
+        if (request.Read.valid()) request.Read.wait();
+    }
+}
+
+std::shared_future<bool> AssetLoader::request(std::function<bool()> read, std::function<bool()> upload)
+{
+    Request& request = Requests.emplace_back();
+    request.Read = ThreadPool::getInstance().submit( std::move( read ) );
+    request.Upload = std::move( upload );
+    return request.Uploaded.get_future().share();
+}
+
+std::shared_future<bool> AssetLoader::requestMesh(ObjectGL& object, GLenum draw_mode, const std::string& file_path)
+{
+    auto mesh = std::make_shared<MeshCache>();
+    return request(
+        [mesh, file_path]() { return mesh->load( file_path ); },
+        [mesh, &object, draw_mode]()
+        {
+            object.setObject( draw_mode, *mesh );
+            return true;
+        }
+    );
+}
+
+std::shared_future<bool> AssetLoader::requestMorphObject(
+    ObjectGL& object,
+    GLenum draw_mode,
+    const std::vector<std::string>& frame_paths
+)
+{
+    struct MorphTargets
+    {
+        std::vector<glm::vec3> Vertices;
+        std::vector<glm::vec3> Normals;
+        std::vector<glm::vec2> Textures;
+        std::vector<GLuint> Indices;
+        std::vector<glm::vec4> Deltas;
+    };
+
+    auto targets = std::make_shared<MorphTargets>();
+    return request(
+        [targets, frame_paths]()
+        {
+            return ObjectReader::readMorphTargets(
+                targets->Vertices, targets->Normals, targets->Textures, targets->Indices, targets->Deltas,
+                frame_paths
+            );
+        },
+        [targets, &object, draw_mode]()
+        {
+            object.setMorphObject(
+                draw_mode,
+                targets->Vertices, targets->Normals, targets->Textures, targets->Indices, targets->Deltas
+            );
+            return true;
+        }
+    );
+}
+
+std::shared_future<bool> AssetLoader::requestTexture(ObjectGL& object, const std::string& file_path, bool is_grayscale)
+{
+    auto image = std::make_shared<Image>();
+    return request(
+        [image, file_path, is_grayscale]() { return decodeImage( *image, file_path, is_grayscale ); },
+        [image, &object]()
+        {
+            object.addTexture( image->Pixels.data(), image->Width, image->Height, image->IsGrayscale );
+            return true;
+        }
+    );
+}
+
+std::shared_future<bool> AssetLoader::requestTexture(
+    ObjectGL& object,
+    const std::string& file_path,
+    BlockCompressor::FORMAT format
+)
+{
+    auto texture = std::make_shared<CompressedTexture>();
+    return request(
+        [texture, file_path, format]() { return texture->load( file_path, format ); },
+        [texture, &object]()
+        {
+            object.addTexture( *texture );
+            return true;
+        }
+    );
+}
+
+void AssetLoader::uploadPending()
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (int uploaded = 0; uploaded < MaxUploadsPerFrame && !Requests.empty(); ++uploaded) {
+        if (uploaded > 0) {
+            const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            if (elapsed.count() >= UploadBudgetInMs) break;
+        }
+
+        Request& request = Requests.front();
+        if (request.Read.wait_for( std::chrono::seconds( 0 ) ) != std::future_status::ready) break;
+
+        bool success = false;
+        try {
+            success = request.Read.get() && request.Upload();
+        }
+        catch (const std::exception& error) {
+            std::cout << error.what() << "\n";
+        }
+        request.Uploaded.set_value( success );
+        Requests.pop_front();
+    }
+}
+
+bool AssetLoader::decodeImage(
+    Image& image,
+    const std::string& file_path,
+    bool is_grayscale,
+    int width,
+    int height
+)
+{
+    const FREE_IMAGE_FORMAT format = FreeImage_GetFileType( file_path.c_str(), 0 );
+    FIBITMAP* texture = FreeImage_Load( format, file_path.c_str() );
+    if (!texture) {
+        std::cout << "Could not read image file " << file_path << "\n";
+        return false;
+    }
+
+    FIBITMAP* texture_converted;
+    const uint n_bits_per_pixel = FreeImage_GetBPP( texture );
+    const uint n_bits = is_grayscale ? 8 : 32;
+    if (is_grayscale) {
+        texture_converted = n_bits_per_pixel == n_bits ? texture : FreeImage_GetChannel( texture, FICC_RED );
+    }
+    else {
+        texture_converted = n_bits_per_pixel == n_bits ? texture : FreeImage_ConvertTo32Bits( texture );
+    }
+    if (!texture_converted) {
+        std::cout << "Could not convert image file " << file_path << "\n";
+        FreeImage_Unload( texture );
+        return false;
+    }
+    if (width > 0 && height > 0 &&
+        (static_cast<int>(FreeImage_GetWidth( texture_converted )) != width ||
+         static_cast<int>(FreeImage_GetHeight( texture_converted )) != height)) {
+        FIBITMAP* texture_rescaled = FreeImage_Rescale( texture_converted, width, height, FILTER_CATMULLROM );
+        if (texture_converted != texture) FreeImage_Unload( texture_converted );
+        if (!texture_rescaled) {
+            std::cout << "Could not rescale image file " << file_path << "\n";
+            FreeImage_Unload( texture );
+            return false;
+        }
+        texture_converted = texture_rescaled;
+    }
+
+    image.Width = static_cast<int>(FreeImage_GetWidth( texture_converted ));
+    image.Height = static_cast<int>(FreeImage_GetHeight( texture_converted ));
+    image.IsGrayscale = is_grayscale;
+    const auto* bits = FreeImage_GetBits( texture_converted );
+    image.Pixels.assign( bits, bits + static_cast<size_t>(FreeImage_GetPitch( texture_converted )) * image.Height );
+
+    if (texture_converted != texture) FreeImage_Unload( texture_converted );
+    FreeImage_Unload( texture );
+    return true;
+}
+
+bool AssetLoader::decodeImages(
+    std::vector<Image>& images,
+    const std::vector<std::string>& file_paths,
+    bool is_grayscale,
+    int width,
+    int height
+)
+{
+    const auto start = std::chrono::steady_clock::now();
+    images.clear();
+    images.resize( file_paths.size() );
+    std::vector<std::future<bool>> tasks;
+    for (size_t i = 0; i < file_paths.size(); ++i) {
+        tasks.emplace_back(
+            ThreadPool::getInstance().submit(
+                [&, i]() { return decodeImage( images[i], file_paths[i], is_grayscale, width, height ); }
+            )
+        );
+    }
+
+    // Every task has to finish before returning, since they all write into images.
+    bool success = true;
+    for (auto& task : tasks) success = task.get() && success;
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::ostringstream report;
+    report << ">> " << file_paths.size() << " images decoded on " << ThreadPool::getInstance().getThreadNum()
+        << " threads in " << std::fixed << std::setprecision( 1 ) << elapsed.count() << " ms\n";
+    std::cout << report.str();
+    return success;
+}
\ No newline at end of file
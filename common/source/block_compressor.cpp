@@ -0,0 +1,476 @@
+#include "block_compressor.h"
+#include "thread_pool.h"
+
+GLenum BlockCompressor::getInternalFormat(FORMAT format)
+{
+    switch (format) {
+        case BC1: return CompressedRGBS3TCDXT1;
+        case BC3: return CompressedRGBAS3TCDXT5;
+        case BC4: return GL_COMPRESSED_RED_RGTC1;
+        case BC5: return GL_COMPRESSED_RG_RGTC2;
+    }
+    return GL_NONE;
+}
+
+const char* BlockCompressor::getFormatName(FORMAT format)
+{
+    switch (format) {
+        case BC1: return "BC1";
+        case BC3: return "BC3";
+        case BC4: return "BC4";
+        case BC5: return "BC5";
+    }
+    return "";
+}
+
+BlockCompressor::Block BlockCompressor::getBlock(
+    const uint8_t* pixels,
+    int width,
+    int height,
+    int block_x,
+    int block_y
+)
+{
+    // The blocks over the edges repeat the last row and column, which keeps them out of the endpoint fitting.
+    Block block;
+    for (int y = 0; y < 4; ++y) {
+        const int row = std::min( block_y * 4 + y, height - 1 );
+        for (int x = 0; x < 4; ++x) {
+            const int column = std::min( block_x * 4 + x, width - 1 );
+            const uint8_t* pixel = pixels + (static_cast<size_t>(row) * width + column) * 4;
+            block[y * 4 + x] = glm::u8vec4( pixel[Red], pixel[Green], pixel[Blue], pixel[Alpha] );
+        }
+    }
+    return block;
+}
+
+uint16_t BlockCompressor::packColor(const glm::vec3& color)
+{
+    const glm::vec3 scaled = glm::clamp( color, 0.0f, 255.0f ) * glm::vec3( 31.0f, 63.0f, 31.0f ) / 255.0f;
+    const glm::ivec3 rounded( glm::round( scaled ) );
+    return static_cast<uint16_t>((rounded.r << 11) | (rounded.g << 5) | rounded.b);
+}
+
+glm::ivec3 BlockCompressor::unpackColor(uint16_t color)
+{
+    const int r = (color >> 11) & 31;
+    const int g = (color >> 5) & 63;
+    const int b = color & 31;
+    return { (r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2) };
+}
+
+void BlockCompressor::getColorPalette(std::array<glm::ivec3, 4>& palette, uint16_t color0, uint16_t color1)
+{
+    // The encoder always writes color0 > color1 or equal endpoints with zero indices, so the three-color mode of BC1
+    // never matters and the palette is the four-color one, which BC3 always uses.
+    palette[0] = unpackColor( color0 );
+    palette[1] = unpackColor( color1 );
+    palette[2] = (palette[0] * 2 + palette[1]) / 3;
+    palette[3] = (palette[0] + palette[1] * 2) / 3;
+}
+
+void BlockCompressor::getValuePalette(std::array<int, 8>& palette, int value0, int value1)
+{
+    palette[0] = value0;
+    palette[1] = value1;
+    if (value0 > value1) {
+        for (int i = 1; i <= 6; ++i) palette[i + 1] = ((7 - i) * value0 + i * value1 + 3) / 7;
+    }
+    else {
+        for (int i = 1; i <= 4; ++i) palette[i + 1] = ((5 - i) * value0 + i * value1 + 2) / 5;
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+int BlockCompressor::fitColorIndices(uint32_t& indices, const Block& block, uint16_t color0, uint16_t color1)
+{
+    std::array<glm::ivec3, 4> palette{};
+    getColorPalette( palette, color0, color1 );
+
+    int error = 0;
+    indices = 0;
+    for (int i = 0; i < 16; ++i) {
+        const glm::ivec3 color( block[i] );
+        int best_index = 0, best_error = std::numeric_limits<int>::max();
+        for (int p = 0; p < 4; ++p) {
+            const glm::ivec3 difference = color - palette[p];
+            const int distance =
+                difference.r * difference.r + difference.g * difference.g + difference.b * difference.b;
+            if (distance < best_error) {
+                best_error = distance;
+                best_index = p;
+            }
+        }
+        indices |= static_cast<uint32_t>(best_index) << (i * 2);
+        error += best_error;
+    }
+    return error;
+}
+
+int BlockCompressor::fitValueIndices(
+    uint64_t& indices,
+    const std::array<uint8_t, 16>& values,
+    int value0,
+    int value1
+)
+{
+    std::array<int, 8> palette{};
+    getValuePalette( palette, value0, value1 );
+
+    int error = 0;
+    indices = 0;
+    for (int i = 0; i < 16; ++i) {
+        int best_index = 0, best_error = std::numeric_limits<int>::max();
+        for (int p = 0; p < 8; ++p) {
+            const int difference = values[i] - palette[p];
+            if (difference * difference < best_error) {
+                best_error = difference * difference;
+                best_index = p;
+            }
+        }
+        indices |= static_cast<uint64_t>(best_index) << (i * 3);
+        error += best_error;
+    }
+    return error;
+}
+
+void BlockCompressor::refineColorEndpoints(
+    const Block& block,
+    uint32_t indices,
+    glm::vec3& color0,
+    glm::vec3& color1
+)
+{
+    // Solves the least squares of (weight * color0 + (1 - weight) * color1 = pixel) with the weights of the indices.
+    constexpr std::array<float, 4> weights = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    glm::vec3 ax( 0.0f ), bx( 0.0f );
+    for (int i = 0; i < 16; ++i) {
+        const float a = weights[(indices >> (i * 2)) & 3];
+        const float b = 1.0f - a;
+        const glm::vec3 color( block[i] );
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        ax += a * color;
+        bx += b * color;
+    }
+
+    const float determinant = aa * bb - ab * ab;
+    if (std::abs( determinant ) < 1e-6f) return;
+
+    color0 = glm::clamp( (bb * ax - ab * bx) / determinant, 0.0f, 255.0f );
+    color1 = glm::clamp( (aa * bx - ab * ax) / determinant, 0.0f, 255.0f );
+}
+
+void BlockCompressor::encodeColorBlock(uint8_t* destination, const Block& block, QUALITY quality)
+{
+    glm::vec3 min_color( 255.0f ), max_color( 0.0f ), mean( 0.0f );
+    for (const auto& pixel : block) {
+        const glm::vec3 color( pixel );
+        min_color = glm::min( min_color, color );
+        max_color = glm::max( max_color, color );
+        mean += color;
+    }
+    mean /= 16.0f;
+
+    glm::vec3 color0, color1;
+    if (quality == Fast) {
+        // The box has four diagonals, and the signs of the covariances pick the one the colors spread along.
+        float red_green = 0.0f, red_blue = 0.0f;
+        for (const auto& pixel : block) {
+            const glm::vec3 difference = glm::vec3( pixel ) - mean;
+            red_green += difference.r * difference.g;
+            red_blue += difference.r * difference.b;
+        }
+        if (red_green < 0.0f) std::swap( min_color.g, max_color.g );
+        if (red_blue < 0.0f) std::swap( min_color.b, max_color.b );
+
+        // Insetting the box keeps the outliers from pulling the endpoints away from the most of the colors.
+        const glm::vec3 inset = (max_color - min_color) / 16.0f;
+        color0 = max_color - inset;
+        color1 = min_color + inset;
+    }
+    else {
+        glm::mat3 covariance( 0.0f );
+        for (const auto& pixel : block) {
+            const glm::vec3 difference = glm::vec3( pixel ) - mean;
+            covariance += glm::outerProduct( difference, difference );
+        }
+
+        // The power iteration converges to the principal axis, starting from the diagonal of the box.
+        glm::vec3 axis = max_color - min_color;
+        if (glm::dot( axis, axis ) > 1e-6f) {
+            axis = glm::normalize( axis );
+            for (int i = 0; i < 8; ++i) {
+                const glm::vec3 next = covariance * axis;
+                if (glm::dot( next, next ) <= 1e-6f) break;
+                axis = glm::normalize( next );
+            }
+
+            float min_t = std::numeric_limits<float>::max(), max_t = std::numeric_limits<float>::lowest();
+            for (const auto& pixel : block) {
+                const float t = glm::dot( glm::vec3( pixel ) - mean, axis );
+                min_t = std::min( min_t, t );
+                max_t = std::max( max_t, t );
+            }
+            color0 = mean + axis * max_t;
+            color1 = mean + axis * min_t;
+        }
+        else color0 = color1 = mean;
+    }
+
+    uint16_t packed0 = packColor( color0 ), packed1 = packColor( color1 );
+    uint32_t indices = 0;
+    int error = fitColorIndices( indices, block, packed0, packed1 );
+    if (quality == High) {
+        for (int i = 0; i < 2 && error > 0; ++i) {
+            refineColorEndpoints( block, indices, color0, color1 );
+            const uint16_t refined0 = packColor( color0 ), refined1 = packColor( color1 );
+            uint32_t refined_indices = 0;
+            const int refined_error = fitColorIndices( refined_indices, block, refined0, refined1 );
+            if (refined_error >= error) break;
+
+            packed0 = refined0;
+            packed1 = refined1;
+            indices = refined_indices;
+            error = refined_error;
+        }
+    }
+
+    // Swapping the endpoints flips the lower bit of every index, and keeps the block out of the three-color mode.
+    if (packed0 < packed1) {
+        std::swap( packed0, packed1 );
+        indices ^= 0x55555555u;
+    }
+    else if (packed0 == packed1) indices = 0;
+
+    std::memcpy( destination, &packed0, 2 );
+    std::memcpy( destination + 2, &packed1, 2 );
+    std::memcpy( destination + 4, &indices, 4 );
+}
+
+void BlockCompressor::encodeValueBlock(uint8_t* destination, const std::array<uint8_t, 16>& values, QUALITY quality)
+{
+    const auto [min_value, max_value] = std::minmax_element( values.begin(), values.end() );
+    int value0 = *max_value, value1 = *min_value;
+    uint64_t indices = 0;
+    int error = fitValueIndices( indices, values, value0, value1 );
+
+    if (quality == High && error > 0) {
+        const auto tryEndpoints = [&](int candidate0, int candidate1)
+        {
+            uint64_t candidate_indices = 0;
+            const int candidate_error = fitValueIndices( candidate_indices, values, candidate0, candidate1 );
+            if (candidate_error < error) {
+                value0 = candidate0;
+                value1 = candidate1;
+                indices = candidate_indices;
+                error = candidate_error;
+            }
+        };
+
+        // Pulling the endpoints in can put the eight steps closer to the values than the range itself does.
+        const int high = *max_value, low = *min_value;
+        for (int inward0 = 0; inward0 < 4; ++inward0) {
+            for (int inward1 = 0; inward1 < 4; ++inward1) {
+                if (high - inward0 > low + inward1) tryEndpoints( high - inward0, low + inward1 );
+            }
+        }
+
+        // The six-step mode has exact 0 and 255, so the range it spans only has to cover the values between them.
+        int inner_min = 255, inner_max = 0;
+        for (const auto& value : values) {
+            if (value == 0 || value == 255) continue;
+            inner_min = std::min( inner_min, static_cast<int>(value) );
+            inner_max = std::max( inner_max, static_cast<int>(value) );
+        }
+        if (inner_min > inner_max) inner_min = inner_max = 0;
+        tryEndpoints( inner_min, inner_max );
+    }
+
+    destination[0] = static_cast<uint8_t>(value0);
+    destination[1] = static_cast<uint8_t>(value1);
+    std::memcpy( destination + 2, &indices, 6 );
+}
+
+void BlockCompressor::encodeBlock(uint8_t* destination, const Block& block, FORMAT format, QUALITY quality)
+{
+    const auto getChannel = [&block](int channel)
+    {
+        std::array<uint8_t, 16> values{};
+        for (int i = 0; i < 16; ++i) values[i] = block[i][channel];
+        return values;
+    };
+
+    switch (format) {
+        case BC1:
+            encodeColorBlock( destination, block, quality );
+            break;
+        case BC3:
+            encodeValueBlock( destination, getChannel( 3 ), quality );
+            encodeColorBlock( destination + 8, block, quality );
+            break;
+        case BC4:
+            encodeValueBlock( destination, getChannel( 0 ), quality );
+            break;
+        case BC5:
+            encodeValueBlock( destination, getChannel( 0 ), quality );
+            encodeValueBlock( destination + 8, getChannel( 1 ), quality );
+            break;
+    }
+}
+
+void BlockCompressor::compress(
+    std::vector<uint8_t>& blocks,
+    const uint8_t* pixels,
+    int width,
+    int height,
+    FORMAT format,
+    QUALITY quality,
+    int thread_num
+)
+{
+    const int block_width = (width + 3) / 4;
+    const int block_height = (height + 3) / 4;
+    const int block_bytes = getBlockBytes( format );
+    blocks.resize( getCompressedSize( format, width, height ) );
+
+    const auto encodeRows = [&](int row_begin, int row_end)
+    {
+        for (int y = row_begin; y < row_end; ++y) {
+            uint8_t* row = blocks.data() + static_cast<size_t>(y) * block_width * block_bytes;
+            for (int x = 0; x < block_width; ++x) {
+                const Block block = getBlock( pixels, width, height, x, y );
+                encodeBlock( row + static_cast<size_t>(x) * block_bytes, block, format, quality );
+            }
+        }
+    };
+
+    // On a worker, the rows are encoded right here, since waiting for other tasks of the pool could deadlock it.
+    const int task_num = ThreadPool::isWorkerThread() ? 1 : std::clamp( thread_num, 1, block_height );
+    if (task_num == 1) {
+        encodeRows( 0, block_height );
+        return;
+    }
+
+    std::vector<std::future<void>> tasks;
+    for (int i = 0; i < task_num; ++i) {
+        const int row_begin = block_height * i / task_num;
+        const int row_end = block_height * (i + 1) / task_num;
+        tasks.emplace_back(
+            ThreadPool::getInstance().submit(
+                [&encodeRows, row_begin, row_end]() { encodeRows( row_begin, row_end ); }
+            )
+        );
+    }
+    for (auto& task : tasks) task.get();
+}
+
+void BlockCompressor::decodeColorBlock(std::array<glm::ivec3, 16>& colors, const uint8_t* source)
+{
+    uint16_t color0, color1;
+    uint32_t indices;
+    std::memcpy( &color0, source, 2 );
+    std::memcpy( &color1, source + 2, 2 );
+    std::memcpy( &indices, source + 4, 4 );
+
+    std::array<glm::ivec3, 4> palette{};
+    getColorPalette( palette, color0, color1 );
+    for (int i = 0; i < 16; ++i) colors[i] = palette[(indices >> (i * 2)) & 3];
+}
+
+void BlockCompressor::decodeValueBlock(std::array<int, 16>& values, const uint8_t* source)
+{
+    uint64_t indices = 0;
+    std::memcpy( &indices, source + 2, 6 );
+
+    std::array<int, 8> palette{};
+    getValuePalette( palette, source[0], source[1] );
+    for (int i = 0; i < 16; ++i) values[i] = palette[(indices >> (i * 3)) & 7];
+}
+
+void BlockCompressor::decompress(
+    std::vector<uint8_t>& pixels,
+    const uint8_t* blocks,
+    int width,
+    int height,
+    FORMAT format
+)
+{
+    const int block_width = (width + 3) / 4;
+    const int block_height = (height + 3) / 4;
+    const int block_bytes = getBlockBytes( format );
+    pixels.assign( static_cast<size_t>(width) * height * 4, 0 );
+
+    std::array<glm::ivec3, 16> colors{};
+    std::array<int, 16> first{}, second{};
+    for (int by = 0; by < block_height; ++by) {
+        for (int bx = 0; bx < block_width; ++bx) {
+            const uint8_t* block = blocks + (static_cast<size_t>(by) * block_width + bx) * block_bytes;
+            switch (format) {
+                case BC1:
+                    decodeColorBlock( colors, block );
+                    first.fill( 255 );
+                    break;
+                case BC3:
+                    decodeValueBlock( first, block );
+                    decodeColorBlock( colors, block + 8 );
+                    break;
+                case BC4:
+                    decodeValueBlock( first, block );
+                    for (int i = 0; i < 16; ++i) colors[i] = glm::ivec3( first[i], 0, 0 );
+                    first.fill( 255 );
+                    break;
+                case BC5:
+                    decodeValueBlock( first, block );
+                    decodeValueBlock( second, block + 8 );
+                    for (int i = 0; i < 16; ++i) colors[i] = glm::ivec3( first[i], second[i], 0 );
+                    first.fill( 255 );
+                    break;
+            }
+
+            for (int i = 0; i < 16; ++i) {
+                const int x = bx * 4 + i % 4, y = by * 4 + i / 4;
+                if (x >= width || y >= height) continue;
+
+                uint8_t* pixel = pixels.data() + (static_cast<size_t>(y) * width + x) * 4;
+                pixel[Red] = static_cast<uint8_t>(colors[i].r);
+                pixel[Green] = static_cast<uint8_t>(colors[i].g);
+                pixel[Blue] = static_cast<uint8_t>(colors[i].b);
+                pixel[Alpha] = static_cast<uint8_t>(first[i]);
+            }
+        }
+    }
+}
+
+double BlockCompressor::getPSNR(
+    const uint8_t* original,
+    const uint8_t* decompressed,
+    int width,
+    int height,
+    FORMAT format
+)
+{
+    std::vector<int> channels;
+    switch (format) {
+        case BC1: channels = { Red, Green, Blue }; break;
+        case BC3: channels = { Red, Green, Blue, Alpha }; break;
+        case BC4: channels = { Red }; break;
+        case BC5: channels = { Red, Green }; break;
+    }
+
+    const size_t pixel_num = static_cast<size_t>(width) * height;
+    double squared_error = 0.0;
+    for (size_t i = 0; i < pixel_num; ++i) {
+        for (const auto& channel : channels) {
+            const double difference = static_cast<double>(original[i * 4 + channel]) - decompressed[i * 4 + channel];
+            squared_error += difference * difference;
+        }
+    }
+
+    const double mean_squared_error = squared_error / static_cast<double>(pixel_num * channels.size());
+    if (mean_squared_error == 0.0) return std::numeric_limits<double>::infinity();
+    return 10.0 * std::log10( 255.0 * 255.0 / mean_squared_error );
+}
\ No newline at end of file
@@ -186,4 +186,16 @@ void CameraGL::update3DCamera(int width, int height)
     IsPerspective = true;
     AspectRatio = static_cast<float>(width) / static_cast<float>(height);
     ProjectionMatrix = glm::perspective( glm::radians( FOV ), AspectRatio, NearPlane, FarPlane );
+}
+
+float CameraGL::getProjectedSize(const glm::vec3& world_center, float world_radius) const
+{
+    // ProjectionMatrix[1][1] scales a height in the view space to the normalized device coordinates, [-1, 1] of
+    // which span the height of the screen.
+    const float pixels_per_unit = ProjectionMatrix[1][1] * static_cast<float>(Height);
+    if (!IsPerspective) return world_radius * pixels_per_unit;
+
+    const float distance = -(ViewMatrix * glm::vec4( world_center, 1.0f )).z;
+    if (distance <= NearPlane) return std::numeric_limits<float>::max();
+    return world_radius * pixels_per_unit / distance;
 }
\ No newline at end of file
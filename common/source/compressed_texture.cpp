@@ -0,0 +1,120 @@
+#include "compressed_texture.h"
+
+bool CompressedTexture::isValid(
+    const std::string& source_path,
+    BlockCompressor::FORMAT format,
+    BlockCompressor::QUALITY quality
+) const
+{
+    if (File.getSize() < sizeof( Header )) return false;
+    if (CacheHeader->Magic != Magic || CacheHeader->Version != Version) return false;
+    if (CacheHeader->Format != static_cast<uint32_t>(format) || CacheHeader->Quality != static_cast<uint32_t>(quality))
+        return false;
+    if (CacheHeader->Width == 0 || CacheHeader->Height == 0) return false;
+    if (CacheHeader->LevelNum < 1 || CacheHeader->LevelNum > MaxLevelNum) return false;
+
+    for (uint32_t i = 0; i < CacheHeader->LevelNum; ++i) {
+        const auto level = static_cast<int>(i);
+        const size_t level_size = BlockCompressor::getCompressedSize(
+            format, getLevelWidth( level ), getLevelHeight( level )
+        );
+        if (CacheHeader->LevelSizes[i] != level_size ||
+            CacheHeader->LevelOffsets[i] + CacheHeader->LevelSizes[i] > File.getSize())
+            return false;
+    }
+
+    uint64_t size;
+    int64_t modified_time;
+    if (!MappedFile::getFileInfo( source_path, size, modified_time ) || size != CacheHeader->SourceSize) return false;
+
+    // A checkout or a copy can touch the source without changing it, so the content decides in that case.
+    return modified_time == CacheHeader->SourceModifiedTime ||
+        MappedFile::getFileHash( source_path ) == CacheHeader->SourceHash;
+}
+
+bool CompressedTexture::open(
+    const std::string& source_path,
+    BlockCompressor::FORMAT format,
+    BlockCompressor::QUALITY quality
+)
+{
+    close();
+    if (!File.open( getCachePath( source_path ) )) return false;
+
+    CacheHeader = reinterpret_cast<const Header*>(File.getData());
+    if (!isValid( source_path, format, quality )) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool CompressedTexture::load(
+    const std::string& source_path,
+    BlockCompressor::FORMAT format,
+    BlockCompressor::QUALITY quality,
+    int thread_num
+)
+{
+    if (open( source_path, format, quality )) return true;
+
+    std::vector<uint8_t> pixels;
+    int width = 0, height = 0;
+    if (!MipmappedTexture::decodeImage( pixels, width, height, source_path, false )) return false;
+
+    const auto start = std::chrono::steady_clock::now();
+    Header header{};
+    header.Magic = Magic;
+    header.Version = Version;
+    header.Format = static_cast<uint32_t>(format);
+    header.Quality = static_cast<uint32_t>(quality);
+    header.Width = static_cast<uint32_t>(width);
+    header.Height = static_cast<uint32_t>(height);
+    if (!MappedFile::getFileInfo( source_path, header.SourceSize, header.SourceModifiedTime )) return false;
+    header.SourceHash = MappedFile::getFileHash( source_path );
+
+    // The channels of BC4 and BC5 are data such as heights or normals, which are not in sRGB.
+    std::vector<std::vector<uint8_t>> levels;
+    const bool is_color = format == BlockCompressor::BC1 || format == BlockCompressor::BC3;
+    MipmapGenerator::generate( levels, pixels.data(), width, height, 4, MipmapGenerator::Kaiser, is_color, thread_num );
+    header.LevelNum = static_cast<uint32_t>(levels.size() + 1);
+    if (header.LevelNum > MaxLevelNum) return false;
+
+    Blob.resize( sizeof( Header ) );
+    double psnr = 0.0;
+    size_t uncompressed_size = 0;
+    std::vector<uint8_t> blocks;
+    for (int level = 0; level < static_cast<int>(header.LevelNum); ++level) {
+        const uint8_t* level_pixels = level == 0 ? pixels.data() : levels[level - 1].data();
+        const int level_width = std::max( width >> level, 1 );
+        const int level_height = std::max( height >> level, 1 );
+        BlockCompressor::compress( blocks, level_pixels, level_width, level_height, format, quality, thread_num );
+        if (level == 0) {
+            std::vector<uint8_t> decompressed;
+            BlockCompressor::decompress( decompressed, blocks.data(), width, height, format );
+            psnr = BlockCompressor::getPSNR( pixels.data(), decompressed.data(), width, height, format );
+        }
+
+        header.LevelOffsets[level] = Blob.size();
+        header.LevelSizes[level] = blocks.size();
+        Blob.insert( Blob.end(), blocks.begin(), blocks.end() );
+        uncompressed_size += static_cast<size_t>(level_width) * level_height * 4;
+    }
+    std::memcpy( Blob.data(), &header, sizeof( Header ) );
+    CacheHeader = reinterpret_cast<const Header*>(Blob.data());
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    const std::string file_name = std::filesystem::path( source_path ).filename().string();
+    std::ostringstream report;
+    report << std::fixed << std::setprecision( 1 ) << ">> " << file_name << ": "
+        << BlockCompressor::getFormatName( format ) << (quality == BlockCompressor::High ? " (high)" : " (fast)")
+        << " " << width << "x" << height << " with " << header.LevelNum << " levels, "
+        << uncompressed_size / 1024 << " KB -> " << (Blob.size() - sizeof( Header )) / 1024 << " KB, PSNR "
+        << std::setprecision( 2 ) << psnr << " dB in " << std::setprecision( 1 ) << elapsed.count() << " ms\n";
+    std::cout << report.str();
+
+    if (!MappedFile::writeAtomically( getCachePath( source_path ), Blob.data(), Blob.size() )) {
+        std::cout << ">> " << file_name << ": could not write the texture cache\n";
+    }
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#include "draw_data.h"
+
+static_assert( sizeof( DrawDataGL::MaterialInfo ) == 80 && sizeof( DrawDataGL::DrawInfo ) == 272 );
+
+DrawDataGL::DrawDataGL(int max_draw_num) :
+    MaxDrawNum( max_draw_num ),
+    Buffer( std::make_unique<RingBufferGL>( static_cast<GLsizeiptr>(sizeof( DrawInfo )) * max_draw_num ) )
+{
+}
+
+void DrawDataGL::beginFrame()
+{
+    Draws = reinterpret_cast<DrawInfo*>(Buffer->nextRegion());
+    DrawNum = 0;
+    glBindBufferRange(
+        GL_SHADER_STORAGE_BUFFER, DrawBufferBinding, Buffer->getBuffer(),
+        Buffer->getRegionOffset(), Buffer->getRegionSize()
+    );
+}
+
+GLuint DrawDataGL::addDraw(
+    const ObjectGL& object,
+    const glm::mat4& world_matrix,
+    const glm::mat4& view_matrix,
+    const glm::mat4& projection_matrix
+)
+{
+    return addDraw(
+        DrawInfo{ world_matrix, view_matrix, projection_matrix * view_matrix * world_matrix, getMaterial( object ) }
+    );
+}
+
+GLuint DrawDataGL::addDraw(const DrawInfo& draw)
+{
+    if (Draws == nullptr) throw std::runtime_error( "DrawDataGL::beginFrame() has to come before the draws" );
+    if (DrawNum == MaxDrawNum) throw std::runtime_error( "More draws in a frame than DrawDataGL was made for" );
+
+    // The region is mapped coherently, so the entry is visible to the draws issued after this.
+    std::memcpy( Draws + DrawNum, &draw, sizeof( DrawInfo ) );
+    return static_cast<GLuint>(DrawNum++);
+}
\ No newline at end of file
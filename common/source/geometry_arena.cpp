@@ -0,0 +1,323 @@
+#include "geometry_arena.h"
+
+bool GeometryArenaGL::FreeList::allocate(GLsizeiptr& offset, GLsizeiptr size, GLsizeiptr alignment)
+{
+    for (auto it = Ranges.begin(); it != Ranges.end(); ++it) {
+        const GLsizeiptr range_offset = it->first;
+        const GLsizeiptr range_end = it->first + it->second;
+        const GLsizeiptr aligned_offset = (range_offset + alignment - 1) / alignment * alignment;
+        if (aligned_offset + size > range_end) continue;
+
+        // The padding in front stays free, so that the release of a neighbor can merge with it.
+        Ranges.erase( it );
+        if (aligned_offset > range_offset) Ranges[range_offset] = aligned_offset - range_offset;
+        if (aligned_offset + size < range_end) Ranges[aligned_offset + size] = range_end - aligned_offset - size;
+        offset = aligned_offset;
+        return true;
+    }
+    return false;
+}
+
+void GeometryArenaGL::FreeList::release(GLsizeiptr offset, GLsizeiptr size)
+{
+    GLsizeiptr begin = offset;
+    GLsizeiptr end = offset + size;
+    const auto next = Ranges.find( end );
+    if (next != Ranges.end()) {
+        end += next->second;
+        Ranges.erase( next );
+    }
+
+    auto previous = Ranges.lower_bound( begin );
+    if (previous != Ranges.begin()) {
+        --previous;
+        if (previous->first + previous->second == begin) {
+            begin = previous->first;
+            Ranges.erase( previous );
+        }
+    }
+    Ranges[begin] = end - begin;
+}
+
+GeometryArenaGL::GeometryArenaGL(GLsizeiptr vertex_buffer_size, GLsizeiptr index_capacity) :
+    VertexBufferSize( vertex_buffer_size ), IndexCapacity( index_capacity )
+{
+    rebuild( vertex_buffer_size, index_capacity );
+}
+
+GeometryArenaGL::~GeometryArenaGL()
+{
+    if (!VAOs.empty())
+        glDeleteVertexArrays( static_cast<GLsizei>(VAOs.size()), VAOs.data() );
+    if (IndexBuffer != 0)
+        glDeleteBuffers( 1, &IndexBuffer );
+    if (VertexBuffer != 0)
+        glDeleteBuffers( 1, &VertexBuffer );
+}
+
+GeometryArenaGL::VertexFormat GeometryArenaGL::getVertexFormat(GLuint vao)
+{
+    // The objects keep their interleaved vertices in the binding 0, whose stride can only be queried while bound.
+    VertexFormat format{};
+    glBindVertexArray( vao );
+    glGetIntegeri_v( GL_VERTEX_BINDING_STRIDE, 0, &format.Stride );
+    glBindVertexArray( 0 );
+
+    for (int i = 0; i < MaxAttributeNum; ++i) {
+        const auto index = static_cast<GLuint>(i);
+        Attribute& attribute = format.Attributes[i];
+        glGetVertexArrayIndexediv( vao, index, GL_VERTEX_ATTRIB_ARRAY_ENABLED, &attribute.Enabled );
+        if (attribute.Enabled == GL_FALSE) continue;
+
+        glGetVertexArrayIndexediv( vao, index, GL_VERTEX_ATTRIB_ARRAY_SIZE, &attribute.ComponentNum );
+        glGetVertexArrayIndexediv( vao, index, GL_VERTEX_ATTRIB_ARRAY_TYPE, &attribute.Type );
+        glGetVertexArrayIndexediv( vao, index, GL_VERTEX_ATTRIB_ARRAY_NORMALIZED, &attribute.Normalized );
+        glGetVertexArrayIndexediv( vao, index, GL_VERTEX_ATTRIB_ARRAY_INTEGER, &attribute.Integer );
+        glGetVertexArrayIndexediv( vao, index, GL_VERTEX_ATTRIB_RELATIVE_OFFSET, &attribute.RelativeOffset );
+    }
+    return format;
+}
+
+int GeometryArenaGL::findFormat(const VertexFormat& format)
+{
+    const auto it = std::ranges::find( Formats, format );
+    if (it != Formats.end()) return static_cast<int>(it - Formats.begin());
+
+    GLuint vao = 0;
+    glCreateVertexArrays( 1, &vao );
+    for (int i = 0; i < MaxAttributeNum; ++i) {
+        const auto index = static_cast<GLuint>(i);
+        const Attribute& attribute = format.Attributes[i];
+        if (attribute.Enabled == GL_FALSE) continue;
+
+        const auto type = static_cast<GLenum>(attribute.Type);
+        const auto offset = static_cast<GLuint>(attribute.RelativeOffset);
+        if (attribute.Integer != GL_FALSE) {
+            glVertexArrayAttribIFormat( vao, index, attribute.ComponentNum, type, offset );
+        }
+        else {
+            const auto normalized = static_cast<GLboolean>(attribute.Normalized != GL_FALSE);
+            glVertexArrayAttribFormat( vao, index, attribute.ComponentNum, type, normalized, offset );
+        }
+        glEnableVertexArrayAttrib( vao, index );
+        glVertexArrayAttribBinding( vao, index, 0 );
+    }
+    glVertexArrayVertexBuffer( vao, 0, VertexBuffer, 0, format.Stride );
+    glVertexArrayElementBuffer( vao, IndexBuffer );
+
+    Formats.emplace_back( format );
+    VAOs.emplace_back( vao );
+    return static_cast<int>(Formats.size() - 1);
+}
+
+bool GeometryArenaGL::allocate(Mesh& mesh)
+{
+    // The base vertex of a draw counts in strides, so the vertices of a mesh have to start at a multiple of it.
+    if (!FreeVertices.allocate( mesh.VertexOffset, mesh.VertexSize, Formats[mesh.Format].Stride )) return false;
+    if (!FreeIndices.allocate( mesh.FirstIndex, mesh.IndexNum, 1 )) {
+        FreeVertices.release( mesh.VertexOffset, mesh.VertexSize );
+        return false;
+    }
+    return true;
+}
+
+void GeometryArenaGL::rebuild(GLsizeiptr vertex_buffer_size, GLsizeiptr index_capacity)
+{
+    GLuint vertex_buffer = 0;
+    glCreateBuffers( 1, &vertex_buffer );
+    glNamedBufferStorage( vertex_buffer, vertex_buffer_size, nullptr, GL_DYNAMIC_STORAGE_BIT );
+
+    GLuint index_buffer = 0;
+    glCreateBuffers( 1, &index_buffer );
+    glNamedBufferStorage(
+        index_buffer,
+        index_capacity * static_cast<GLsizeiptr>(sizeof( GLuint )),
+        nullptr,
+        GL_DYNAMIC_STORAGE_BIT
+    );
+
+    // The meshes are packed in the order of their current offsets, so that none of them moves past where it was,
+    // and the live meshes always fit into buffers of the same size.
+    std::vector<Mesh*> live_meshes;
+    for (auto& mesh : Meshes) {
+        if (mesh.IsAlive) live_meshes.emplace_back( &mesh );
+    }
+
+    GLsizeiptr vertex_end = 0;
+    std::ranges::sort( live_meshes, {}, &Mesh::VertexOffset );
+    for (auto* mesh : live_meshes) {
+        const GLsizeiptr stride = Formats[mesh->Format].Stride;
+        const GLsizeiptr vertex_offset = (vertex_end + stride - 1) / stride * stride;
+        glCopyNamedBufferSubData( VertexBuffer, vertex_buffer, mesh->VertexOffset, vertex_offset, mesh->VertexSize );
+        mesh->VertexOffset = vertex_offset;
+        vertex_end = vertex_offset + mesh->VertexSize;
+    }
+
+    GLsizeiptr index_end = 0;
+    constexpr auto index_size = static_cast<GLsizeiptr>(sizeof( GLuint ));
+    std::ranges::sort( live_meshes, {}, &Mesh::FirstIndex );
+    for (auto* mesh : live_meshes) {
+        glCopyNamedBufferSubData(
+            IndexBuffer, index_buffer,
+            mesh->FirstIndex * index_size, index_end * index_size,
+            mesh->IndexNum * index_size
+        );
+        mesh->FirstIndex = index_end;
+        index_end += mesh->IndexNum;
+    }
+
+    if (VertexBuffer != 0)
+        glDeleteBuffers( 1, &VertexBuffer );
+    if (IndexBuffer != 0)
+        glDeleteBuffers( 1, &IndexBuffer );
+    VertexBuffer = vertex_buffer;
+    IndexBuffer = index_buffer;
+    VertexBufferSize = vertex_buffer_size;
+    IndexCapacity = index_capacity;
+    FreeVertices.reset( vertex_end, vertex_buffer_size - vertex_end );
+    FreeIndices.reset( index_end, index_capacity - index_end );
+
+    for (size_t i = 0; i < VAOs.size(); ++i) {
+        glVertexArrayVertexBuffer( VAOs[i], 0, VertexBuffer, 0, Formats[i].Stride );
+        glVertexArrayElementBuffer( VAOs[i], IndexBuffer );
+    }
+}
+
+int GeometryArenaGL::addMesh(const ObjectGL& object)
+{
+    Mesh mesh{};
+    mesh.IsAlive = true;
+    mesh.Format = findFormat( getVertexFormat( object.getVAO() ) );
+    mesh.DrawMode = object.getDrawMode();
+    mesh.VertexSize = static_cast<GLsizeiptr>(Formats[mesh.Format].Stride) * object.getVertexNum();
+    mesh.IndexNum = object.getIBO() != 0 ? object.getTotalIndexNum() : object.getVertexNum();
+    mesh.DrawIndexNum = object.getIBO() != 0 ? object.getIndexNum() : object.getVertexNum();
+    if (!allocate( mesh )) {
+        defragment();
+        if (!allocate( mesh )) {
+            rebuild(
+                std::max( VertexBufferSize * 2, VertexBufferSize + mesh.VertexSize + Formats[mesh.Format].Stride ),
+                std::max( IndexCapacity * 2, IndexCapacity + mesh.IndexNum )
+            );
+            if (!allocate( mesh )) throw std::runtime_error( "Could not allocate a mesh in the geometry arena" );
+        }
+    }
+
+    constexpr auto index_size = static_cast<GLsizeiptr>(sizeof( GLuint ));
+    glCopyNamedBufferSubData( object.getVBO(), VertexBuffer, 0, mesh.VertexOffset, mesh.VertexSize );
+    if (object.getIBO() != 0) {
+        glCopyNamedBufferSubData(
+            object.getIBO(), IndexBuffer,
+            0, mesh.FirstIndex * index_size,
+            mesh.IndexNum * index_size
+        );
+    }
+    else {
+        std::vector<GLuint> indices( static_cast<size_t>(mesh.IndexNum) );
+        for (size_t i = 0; i < indices.size(); ++i) indices[i] = static_cast<GLuint>(i);
+        glNamedBufferSubData( IndexBuffer, mesh.FirstIndex * index_size, mesh.IndexNum * index_size, indices.data() );
+    }
+
+    Meshes.emplace_back( mesh );
+    return static_cast<int>(Meshes.size() - 1);
+}
+
+void GeometryArenaGL::removeMesh(int mesh)
+{
+    Mesh& removed = Meshes[mesh];
+    if (!removed.IsAlive) return;
+
+    FreeVertices.release( removed.VertexOffset, removed.VertexSize );
+    FreeIndices.release( removed.FirstIndex, removed.IndexNum );
+    removed.IsAlive = false;
+}
+
+void GeometryArenaGL::addDraw(int mesh, GLuint base_instance, GLsizei index_num, GLsizei first_index)
+{
+    assert( Meshes[mesh].IsAlive );
+
+    Draws.emplace_back(
+        Draw{
+            mesh,
+            base_instance,
+            index_num < 0 ? Meshes[mesh].DrawIndexNum : index_num,
+            first_index
+        }
+    );
+}
+
+int GeometryArenaGL::submitDraws()
+{
+    if (Draws.empty()) return 0;
+
+    // The draws are grouped by the vertex array and the draw mode, and keep their order within a group.
+    const auto getGroup = [this](const Draw& draw)
+    {
+        return std::make_pair( Meshes[draw.Mesh].Format, Meshes[draw.Mesh].DrawMode );
+    };
+    std::ranges::stable_sort( Draws, {}, getGroup );
+
+    Commands.clear();
+    for (const auto& draw : Draws) {
+        const Mesh& mesh = Meshes[draw.Mesh];
+        Commands.emplace_back(
+            DrawCommand{
+                static_cast<GLuint>(draw.IndexNum),
+                1,
+                static_cast<GLuint>(mesh.FirstIndex + draw.FirstIndex),
+                static_cast<GLint>(mesh.VertexOffset / Formats[mesh.Format].Stride),
+                draw.BaseInstance
+            }
+        );
+    }
+
+    // The commands go to a region of the ring that no draw still reads, so writing them does not make the driver
+    // wait for the multi-draws of the previous submits. A larger ring replaces the old one, which GL keeps alive
+    // until the draws reading it are done.
+    const auto commands_size = static_cast<GLsizeiptr>(sizeof( DrawCommand ) * Commands.size());
+    if (!IndirectRing || commands_size > IndirectRing->getRegionSize()) {
+        const GLsizeiptr region_size = IndirectRing ? std::max( commands_size, IndirectRing->getRegionSize() * 2 ) :
+            commands_size;
+        IndirectRing = std::make_unique<RingBufferGL>( region_size, IndirectRegionNum );
+    }
+    std::memcpy( IndirectRing->nextRegion(), Commands.data(), static_cast<size_t>(commands_size) );
+    glBindBuffer( GL_DRAW_INDIRECT_BUFFER, IndirectRing->getBuffer() );
+
+    int call_num = 0;
+    size_t begin = 0;
+    while (begin < Draws.size()) {
+        size_t end = begin + 1;
+        while (end < Draws.size() && getGroup( Draws[end] ) == getGroup( Draws[begin] )) ++end;
+
+        const Mesh& mesh = Meshes[Draws[begin].Mesh];
+        glBindVertexArray( VAOs[mesh.Format] );
+        glMultiDrawElementsIndirect(
+            mesh.DrawMode,
+            GL_UNSIGNED_INT,
+            reinterpret_cast<const void*>(IndirectRing->getRegionOffset() + begin * sizeof( DrawCommand )),
+            static_cast<GLsizei>(end - begin),
+            0
+        );
+        ++call_num;
+        begin = end;
+    }
+    Draws.clear();
+    return call_num;
+}
+
+void GeometryArenaGL::drawMesh(int mesh, GLuint base_instance, GLsizei index_num, GLsizei first_index) const
+{
+    assert( Meshes[mesh].IsAlive );
+
+    const Mesh& target = Meshes[mesh];
+    glBindVertexArray( VAOs[target.Format] );
+    glDrawElementsInstancedBaseVertexBaseInstance(
+        target.DrawMode,
+        index_num < 0 ? target.DrawIndexNum : index_num,
+        GL_UNSIGNED_INT,
+        reinterpret_cast<const void*>((target.FirstIndex + first_index) * sizeof( GLuint )),
+        1,
+        static_cast<GLint>(target.VertexOffset / Formats[target.Format].Stride),
+        base_instance
+    );
+}
\ No newline at end of file
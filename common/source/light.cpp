@@ -1,5 +1,11 @@
 #include "light.h"
 
+LightGL::~LightGL()
+{
+    if (LightBuffer != 0)
+        glDeleteBuffers( 1, &LightBuffer );
+}
+
 void LightGL::addLight(
     const glm::vec4& light_position,
     const glm::vec4& ambient_color,
@@ -25,16 +31,53 @@ void LightGL::addLight(
     IsActivated.emplace_back( true );
 
     TotalLightNum = static_cast<int>(Positions.size());
+    IsDirty = true;
 }
 
 void LightGL::activateLight(const int& light_index)
 {
     if (light_index >= TotalLightNum) return;
     IsActivated[light_index] = true;
+    IsDirty = true;
 }
 
 void LightGL::deactivateLight(const int& light_index)
 {
     if (light_index >= TotalLightNum) return;
     IsActivated[light_index] = false;
+    IsDirty = true;
+}
+
+void LightGL::updateLightBuffer(const glm::mat4& view_matrix)
+{
+    if (LightBuffer == 0) {
+        glCreateBuffers( 1, &LightBuffer );
+        glNamedBufferStorage( LightBuffer, sizeof( LightBlock ), nullptr, GL_DYNAMIC_STORAGE_BIT );
+    }
+
+    if (IsDirty || view_matrix != PackedViewMatrix) {
+        const int light_num = std::min( TotalLightNum, MaxLightNum );
+        const glm::mat3 direction_matrix = glm::transpose( glm::inverse( glm::mat3( view_matrix ) ) );
+        PackedLights.GlobalAmbient = GlobalAmbientColor;
+        PackedLights.LightNum = light_num;
+        for (int i = 0; i < light_num; ++i) {
+            LightInfo& light = PackedLights.Lights[i];
+            light.Position = Positions[i];
+            light.AmbientColor = AmbientColors[i];
+            light.DiffuseColor = DiffuseColors[i];
+            light.SpecularColor = SpecularColors[i];
+            light.SpotlightDirectionInEC = glm::normalize( direction_matrix * SpotlightDirections[i] );
+            light.SpotlightCutoffAngle = SpotlightCutoffAngles[i];
+            light.LightSwitch = IsActivated[i] ? 1 : 0;
+            light.SpotlightFeather = SpotlightFeathers[i];
+            light.FallOffRadius = FallOffRadii[i];
+        }
+
+        // Only the lights in use are sent, since the shaders never read past LightNum.
+        const auto size = static_cast<GLsizeiptr>(offsetof( LightBlock, Lights ) + sizeof( LightInfo ) * light_num);
+        glNamedBufferSubData( LightBuffer, 0, size, &PackedLights );
+        PackedViewMatrix = view_matrix;
+        IsDirty = false;
+    }
+    glBindBufferBase( GL_UNIFORM_BUFFER, LightBufferBinding, LightBuffer );
 }
\ No newline at end of file
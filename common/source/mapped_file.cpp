@@ -0,0 +1,143 @@
+#include "mapped_file.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+bool MappedFile::open(const std::string& file_path)
+{
+    close();
+
+#ifdef _WIN32
+    FileHandle = CreateFileA(
+        file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr
+    );
+    if (FileHandle == INVALID_HANDLE_VALUE) {
+        FileHandle = nullptr;
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx( FileHandle, &size )) {
+        close();
+        return false;
+    }
+    Size = static_cast<size_t>(size.QuadPart);
+    if (Size > 0) {
+        MappingHandle = CreateFileMappingA( FileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr );
+        if (MappingHandle == nullptr) {
+            close();
+            return false;
+        }
+        Data = static_cast<const char*>(MapViewOfFile( MappingHandle, FILE_MAP_READ, 0, 0, 0 ));
+        if (Data == nullptr) {
+            close();
+            return false;
+        }
+    }
+#else
+    FileDescriptor = ::open( file_path.c_str(), O_RDONLY );
+    if (FileDescriptor < 0) return false;
+
+    struct stat status{};
+    if (fstat( FileDescriptor, &status ) != 0) {
+        close();
+        return false;
+    }
+    Size = static_cast<size_t>(status.st_size);
+    if (Size > 0) {
+        void* data = mmap( nullptr, Size, PROT_READ, MAP_PRIVATE, FileDescriptor, 0 );
+        if (data == MAP_FAILED) {
+            close();
+            return false;
+        }
+        Data = static_cast<const char*>(data);
+    }
+#endif
+    Opened = true;
+    return true;
+}
+
+void MappedFile::close()
+{
+#ifdef _WIN32
+    if (Data != nullptr) UnmapViewOfFile( Data );
+    if (MappingHandle != nullptr) CloseHandle( MappingHandle );
+    if (FileHandle != nullptr) CloseHandle( FileHandle );
+    MappingHandle = nullptr;
+    FileHandle = nullptr;
+#else
+    if (Data != nullptr) munmap( const_cast<char*>(Data), Size );
+    if (FileDescriptor >= 0) ::close( FileDescriptor );
+    FileDescriptor = -1;
+#endif
+    Opened = false;
+    Data = nullptr;
+    Size = 0;
+}
+
+bool MappedFile::getFileInfo(const std::string& file_path, uint64_t& size, int64_t& modified_time)
+{
+    std::error_code error;
+    size = std::filesystem::file_size( file_path, error );
+    if (error) return false;
+
+    const auto time = std::filesystem::last_write_time( file_path, error );
+    if (error) return false;
+
+    modified_time = static_cast<int64_t>(time.time_since_epoch().count());
+    return true;
+}
+
+uint64_t MappedFile::getFileHash(const std::string& file_path)
+{
+    MappedFile file;
+    if (!file.open( file_path )) return 0;
+    return getHash( file.getData(), file.getSize() );
+}
+
+uint64_t MappedFile::getHash(const void* data, size_t size, uint64_t hash)
+{
+    // FNV-1a
+    const auto* ptr = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= ptr[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool MappedFile::writeAtomically(const std::string& file_path, const void* data, size_t size)
+{
+    const std::string temporary_path = file_path + ".tmp";
+    {
+        std::ofstream file( temporary_path, std::ios::out | std::ios::binary | std::ios::trunc );
+        if (!file.is_open()) return false;
+
+        file.write( static_cast<const char*>(data), static_cast<std::streamsize>(size) );
+        if (!file.good()) {
+            file.close();
+            std::error_code error;
+            std::filesystem::remove( temporary_path, error );
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename( temporary_path, file_path, error );
+    if (error) {
+        // The cleanup has its own error code, so that a successful removal does not hide the failed rename.
+        std::error_code cleanup_error;
+        std::filesystem::remove( temporary_path, cleanup_error );
+        return false;
+    }
+    return true;
+}
\ No newline at end of file
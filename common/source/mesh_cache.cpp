@@ -0,0 +1,214 @@
+#include "mesh_cache.h"
+#include "object_reader.h"
+#include "mesh_optimizer.h"
+#include "mesh_simplifier.h"
+#include "thread_pool.h"
+
+bool MeshCache::isValid(const std::string& source_path, bool& is_touched) const
+{
+    is_touched = false;
+    if (File.getSize() < sizeof( Header )) return false;
+    if (CacheHeader->Magic != Magic || CacheHeader->Version != Version) return false;
+    if ((CacheHeader->Flags & ~static_cast<uint32_t>(NormalsExist | TexturesExist)) != 0) return false;
+    if (CacheHeader->FloatsPerVertex != 3u + (normalsExist() ? 3u : 0u) + (texturesExist() ? 2u : 0u)) return false;
+
+    const uint64_t vertex_bytes =
+        static_cast<uint64_t>(CacheHeader->VertexNum) * CacheHeader->FloatsPerVertex * sizeof( GLfloat );
+    const uint64_t index_bytes = static_cast<uint64_t>(CacheHeader->IndexNum) * sizeof( GLuint );
+    if (CacheHeader->LevelNum < 1 || CacheHeader->LevelNum > MaxLevelNum) return false;
+
+    uint64_t level_index_num = 0;
+    for (uint32_t i = 0; i < CacheHeader->LevelNum; ++i) level_index_num += CacheHeader->LevelIndexNums[i];
+    if (level_index_num != CacheHeader->IndexNum) return false;
+
+    if (CacheHeader->VertexOffset + vertex_bytes > File.getSize() ||
+        CacheHeader->IndexOffset + index_bytes > File.getSize() ||
+        CacheHeader->IndexOffset % sizeof( GLuint ) != 0)
+        return false;
+
+    uint64_t size;
+    int64_t modified_time;
+    if (!MappedFile::getFileInfo( source_path, size, modified_time ) || size != CacheHeader->SourceSize) return false;
+
+    // A checkout or a copy can touch the source without changing it, so the content decides in that case.
+    if (modified_time != CacheHeader->SourceModifiedTime) {
+        if (MappedFile::getFileHash( source_path ) != CacheHeader->SourceHash) return false;
+        is_touched = true;
+    }
+
+    // An index out of the vertices would make the draws read past the vertex buffer.
+    const auto* indices = reinterpret_cast<const GLuint*>(File.getData() + CacheHeader->IndexOffset);
+    return std::none_of(
+        indices, indices + CacheHeader->IndexNum,
+        [vertex_num = CacheHeader->VertexNum](GLuint index) { return index >= vertex_num; }
+    );
+}
+
+bool MeshCache::refreshModifiedTime(const std::string& source_path)
+{
+    uint64_t size;
+    int64_t modified_time;
+    if (!MappedFile::getFileInfo( source_path, size, modified_time )) return false;
+
+    std::fstream file( getCachePath( source_path ), std::ios::in | std::ios::out | std::ios::binary );
+    if (!file.is_open()) return false;
+
+    file.seekp( static_cast<std::streamoff>(offsetof( Header, SourceModifiedTime )) );
+    file.write( reinterpret_cast<const char*>(&modified_time), sizeof( modified_time ) );
+    return file.good();
+}
+
+bool MeshCache::open(const std::string& source_path)
+{
+    close();
+    if (!File.open( getCachePath( source_path ) )) return false;
+
+    CacheHeader = reinterpret_cast<const Header*>(File.getData());
+    bool is_touched = false;
+    if (!isValid( source_path, is_touched )) {
+        close();
+        return false;
+    }
+
+    // The new modified time is written into the cache, so that the later loads do not hash the source again.
+    // The mapping is closed meanwhile since a mapped file cannot be written on Windows.
+    if (is_touched) {
+        File.close();
+        if (!refreshModifiedTime( source_path )) {
+            const std::string file_name = std::filesystem::path( source_path ).filename().string();
+            std::cout << ">> " << file_name << ": could not refresh the mesh cache\n";
+        }
+        if (!File.open( getCachePath( source_path ) )) {
+            close();
+            return false;
+        }
+        CacheHeader = reinterpret_cast<const Header*>(File.getData());
+        if (!isValid( source_path, is_touched )) {
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+bool MeshCache::load(const std::string& source_path, int thread_num)
+{
+    if (open( source_path )) return true;
+
+    std::vector<glm::vec3> vertices, normals;
+    std::vector<glm::vec2> textures;
+    if (!ObjectReader::readMeshFile( vertices, normals, textures, Indices, source_path, thread_num )) return false;
+
+    const bool normals_exist = !normals.empty();
+    const bool textures_exist = !textures.empty();
+    const int floats_per_vertex = 3 + (normals_exist ? 3 : 0) + (textures_exist ? 2 : 0);
+    VertexBuffer.reserve( vertices.size() * floats_per_vertex );
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        VertexBuffer.emplace_back( vertices[i].x );
+        VertexBuffer.emplace_back( vertices[i].y );
+        VertexBuffer.emplace_back( vertices[i].z );
+        if (normals_exist) {
+            VertexBuffer.emplace_back( normals[i].x );
+            VertexBuffer.emplace_back( normals[i].y );
+            VertexBuffer.emplace_back( normals[i].z );
+        }
+        if (textures_exist) {
+            VertexBuffer.emplace_back( textures[i].x );
+            VertexBuffer.emplace_back( textures[i].y );
+        }
+    }
+    const std::string file_name = std::filesystem::path( source_path ).filename().string();
+    MeshOptimizer::optimize( VertexBuffer, floats_per_vertex, Indices, file_name );
+
+    // Each level is simplified from the previous one, which is faster and barely differs from starting over.
+    std::vector<size_t> level_index_nums = { Indices.size() };
+    std::vector<GLuint> level( Indices );
+    for (const auto& ratio : LevelRatios) {
+        const auto target_index_num = static_cast<size_t>(static_cast<float>(level_index_nums[0] / 3) * ratio) * 3;
+        level = MeshSimplifier::simplify( VertexBuffer, floats_per_vertex, level, target_index_num );
+        if (level.empty() || level.size() >= level_index_nums.back()) break;
+
+        MeshOptimizer::optimizeVertexCache( level, VertexBuffer.size() / floats_per_vertex );
+        Indices.insert( Indices.end(), level.begin(), level.end() );
+        level_index_nums.emplace_back( level.size() );
+    }
+
+    std::ostringstream report;
+    report << ">> " << file_name << ": levels of detail with";
+    for (const auto& index_num : level_index_nums) report << " " << index_num / 3;
+    report << " triangles\n";
+    std::cout << report.str();
+
+    ParsedHeader = getHeader( VertexBuffer.size(), level_index_nums, normals_exist, textures_exist );
+    CacheHeader = &ParsedHeader;
+    if (!write( source_path, VertexBuffer, Indices, level_index_nums, normals_exist, textures_exist )) {
+        std::cout << ">> " << file_name << ": could not write the mesh cache\n";
+    }
+    return true;
+}
+
+bool MeshCache::loadAll(
+    std::vector<std::unique_ptr<MeshCache>>& meshes,
+    const std::vector<std::string>& source_paths
+)
+{
+    meshes.clear();
+    std::vector<std::future<bool>> tasks;
+    for (const auto& source_path : source_paths) {
+        meshes.emplace_back( std::make_unique<MeshCache>() );
+        tasks.emplace_back(
+            ThreadPool::getInstance().submit(
+                [&mesh = *meshes.back(), &source_path]() { return mesh.load( source_path ); }
+            )
+        );
+    }
+
+    bool loaded = true;
+    for (auto& task : tasks) loaded = task.get() && loaded;
+    return loaded;
+}
+
+MeshCache::Header MeshCache::getHeader(
+    size_t float_num,
+    const std::vector<size_t>& level_index_nums,
+    bool normals_exist,
+    bool textures_exist
+)
+{
+    Header header{};
+    header.Magic = Magic;
+    header.Version = Version;
+    header.Flags = (normals_exist ? NormalsExist : 0u) | (textures_exist ? TexturesExist : 0u);
+    header.FloatsPerVertex = 3 + (normals_exist ? 3 : 0) + (textures_exist ? 2 : 0);
+    header.VertexNum = static_cast<uint32_t>(float_num / header.FloatsPerVertex);
+    header.LevelNum = static_cast<uint32_t>(level_index_nums.size());
+    for (size_t i = 0; i < level_index_nums.size(); ++i) {
+        header.LevelIndexNums[i] = static_cast<uint32_t>(level_index_nums[i]);
+        header.IndexNum += header.LevelIndexNums[i];
+    }
+    header.VertexOffset = sizeof( Header );
+    header.IndexOffset = header.VertexOffset + float_num * sizeof( GLfloat );
+    return header;
+}
+
+bool MeshCache::write(
+    const std::string& source_path,
+    const std::vector<GLfloat>& vertex_buffer,
+    const std::vector<GLuint>& indices,
+    const std::vector<size_t>& level_index_nums,
+    bool normals_exist,
+    bool textures_exist
+)
+{
+    Header header = getHeader( vertex_buffer.size(), level_index_nums, normals_exist, textures_exist );
+    if (!MappedFile::getFileInfo( source_path, header.SourceSize, header.SourceModifiedTime )) return false;
+    header.SourceHash = MappedFile::getFileHash( source_path );
+
+    const size_t vertex_bytes = vertex_buffer.size() * sizeof( GLfloat );
+    const size_t index_bytes = indices.size() * sizeof( GLuint );
+    std::vector<uint8_t> blob( sizeof( Header ) + vertex_bytes + index_bytes );
+    std::memcpy( blob.data(), &header, sizeof( Header ) );
+    std::memcpy( blob.data() + header.VertexOffset, vertex_buffer.data(), vertex_bytes );
+    std::memcpy( blob.data() + header.IndexOffset, indices.data(), index_bytes );
+    return MappedFile::writeAtomically( getCachePath( source_path ), blob.data(), blob.size() );
+}
\ No newline at end of file
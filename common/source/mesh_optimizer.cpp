@@ -0,0 +1,191 @@
+#include "mesh_optimizer.h"
+
+float MeshOptimizer::getVertexScore(int cache_position, int live_triangle_num)
+{
+    if (live_triangle_num == 0) return -1.0f;
+
+    float score = 0.0f;
+    if (cache_position >= 0) {
+        // The vertices of the last triangle get a fixed score, so that the next triangle does not just reuse them.
+        if (cache_position < 3) score = LastTriangleScore;
+        else {
+            const float scale = 1.0f / static_cast<float>(CacheSize - 3);
+            score = std::pow( 1.0f - static_cast<float>(cache_position - 3) * scale, CacheDecayPower );
+        }
+    }
+
+    // The vertices with a few triangles left are boosted, so that they are finished off instead of left behind.
+    score += ValenceBoostScale * std::pow( static_cast<float>(live_triangle_num), -ValenceBoostPower );
+    return score;
+}
+
+void MeshOptimizer::optimizeVertexCache(std::vector<GLuint>& indices, size_t vertex_num)
+{
+    const size_t triangle_num = indices.size() / 3;
+    if (triangle_num == 0) return;
+
+    // The triangles of each vertex are packed into one array, and the live ones are kept in front of each span.
+    std::vector<int> live_triangle_nums( vertex_num, 0 );
+    for (const auto& index : indices) live_triangle_nums[index]++;
+
+    std::vector<size_t> triangle_offsets( vertex_num + 1, 0 );
+    for (size_t v = 0; v < vertex_num; ++v) triangle_offsets[v + 1] = triangle_offsets[v] + live_triangle_nums[v];
+
+    std::vector<uint32_t> vertex_triangles( indices.size() );
+    std::vector<size_t> filled( triangle_offsets.begin(), triangle_offsets.end() - 1 );
+    for (size_t i = 0; i < indices.size(); ++i) {
+        vertex_triangles[filled[indices[i]]++] = static_cast<uint32_t>(i / 3);
+    }
+
+    std::vector<int> cache_positions( vertex_num, -1 );
+    std::vector<float> vertex_scores( vertex_num );
+    for (size_t v = 0; v < vertex_num; ++v) vertex_scores[v] = getVertexScore( -1, live_triangle_nums[v] );
+
+    std::vector<float> triangle_scores( triangle_num );
+    std::vector<bool> emitted( triangle_num, false );
+    for (size_t t = 0; t < triangle_num; ++t) {
+        triangle_scores[t] =
+            vertex_scores[indices[t * 3]] + vertex_scores[indices[t * 3 + 1]] + vertex_scores[indices[t * 3 + 2]];
+    }
+
+    std::vector<GLuint> cache, next_cache;
+    cache.reserve( CacheSize + 3 );
+    next_cache.reserve( CacheSize + 3 );
+    std::vector<GLuint> reordered;
+    reordered.reserve( indices.size() );
+    auto best_triangle = static_cast<size_t>(
+        std::distance( triangle_scores.begin(), std::max_element( triangle_scores.begin(), triangle_scores.end() ) )
+    );
+    size_t scan_cursor = 0;
+    while (true) {
+        if (best_triangle == triangle_num) {
+            // No triangle around the cache is left, so the next one in the input order starts a new strip.
+            while (scan_cursor < triangle_num && emitted[scan_cursor]) ++scan_cursor;
+            if (scan_cursor == triangle_num) break;
+            best_triangle = scan_cursor;
+        }
+
+        emitted[best_triangle] = true;
+        next_cache.clear();
+        for (size_t c = 0; c < 3; ++c) {
+            const GLuint vertex = indices[best_triangle * 3 + c];
+            reordered.emplace_back( vertex );
+            next_cache.emplace_back( vertex );
+
+            const size_t begin = triangle_offsets[vertex];
+            const size_t end = begin + live_triangle_nums[vertex];
+            const auto it = std::find(
+                vertex_triangles.begin() + static_cast<std::ptrdiff_t>(begin),
+                vertex_triangles.begin() + static_cast<std::ptrdiff_t>(end),
+                static_cast<uint32_t>(best_triangle)
+            );
+            std::iter_swap( it, vertex_triangles.begin() + static_cast<std::ptrdiff_t>(end - 1) );
+            live_triangle_nums[vertex]--;
+        }
+        for (const auto& vertex : cache) {
+            if (std::find( next_cache.begin(), next_cache.begin() + 3, vertex ) == next_cache.begin() + 3) {
+                next_cache.emplace_back( vertex );
+            }
+        }
+
+        // The vertices pushed out of the cache lose their position score, and the rest get the new positions.
+        for (size_t i = CacheSize; i < next_cache.size(); ++i) {
+            cache_positions[next_cache[i]] = -1;
+            vertex_scores[next_cache[i]] = getVertexScore( -1, live_triangle_nums[next_cache[i]] );
+        }
+        if (next_cache.size() > CacheSize) next_cache.resize( CacheSize );
+        for (size_t i = 0; i < next_cache.size(); ++i) {
+            cache_positions[next_cache[i]] = static_cast<int>(i);
+            vertex_scores[next_cache[i]] = getVertexScore( static_cast<int>(i), live_triangle_nums[next_cache[i]] );
+        }
+        std::swap( cache, next_cache );
+
+        // Only the triangles around the cache have changed scores, so the next one is searched among them.
+        best_triangle = triangle_num;
+        float best_score = -1.0f;
+        for (const auto& vertex : cache) {
+            const size_t begin = triangle_offsets[vertex];
+            const size_t end = begin + live_triangle_nums[vertex];
+            for (size_t i = begin; i < end; ++i) {
+                const uint32_t t = vertex_triangles[i];
+                triangle_scores[t] = vertex_scores[indices[t * 3]] +
+                    vertex_scores[indices[t * 3 + 1]] +
+                    vertex_scores[indices[t * 3 + 2]];
+                if (triangle_scores[t] > best_score) {
+                    best_score = triangle_scores[t];
+                    best_triangle = t;
+                }
+            }
+        }
+    }
+    indices = std::move( reordered );
+}
+
+void MeshOptimizer::optimizeVertexFetch(
+    std::vector<GLfloat>& vertex_buffer,
+    int floats_per_vertex,
+    std::vector<GLuint>& indices
+)
+{
+    const auto stride = static_cast<size_t>(floats_per_vertex);
+    constexpr GLuint unused = std::numeric_limits<GLuint>::max();
+    std::vector<GLuint> remap( vertex_buffer.size() / stride, unused );
+    std::vector<GLfloat> reordered;
+    reordered.reserve( vertex_buffer.size() );
+    GLuint vertex_num = 0;
+    for (auto& index : indices) {
+        if (remap[index] == unused) {
+            remap[index] = vertex_num++;
+            const auto vertex = vertex_buffer.begin() + static_cast<std::ptrdiff_t>(index * stride);
+            reordered.insert( reordered.end(), vertex, vertex + static_cast<std::ptrdiff_t>(stride) );
+        }
+        index = remap[index];
+    }
+    vertex_buffer = std::move( reordered );
+}
+
+size_t MeshOptimizer::getCacheMissNum(const std::vector<GLuint>& indices)
+{
+    std::deque<GLuint> cache;
+    size_t miss_num = 0;
+    for (const auto& index : indices) {
+        if (std::find( cache.begin(), cache.end(), index ) != cache.end()) continue;
+
+        miss_num++;
+        cache.emplace_back( index );
+        if (cache.size() > CacheSize) cache.pop_front();
+    }
+    return miss_num;
+}
+
+float MeshOptimizer::getACMR(const std::vector<GLuint>& indices)
+{
+    if (indices.size() < 3) return 0.0f;
+    return static_cast<float>(getCacheMissNum( indices )) / static_cast<float>(indices.size() / 3);
+}
+
+float MeshOptimizer::getATVR(const std::vector<GLuint>& indices, size_t vertex_num)
+{
+    if (vertex_num == 0) return 0.0f;
+    return static_cast<float>(getCacheMissNum( indices )) / static_cast<float>(vertex_num);
+}
+
+void MeshOptimizer::optimize(
+    std::vector<GLfloat>& vertex_buffer,
+    int floats_per_vertex,
+    std::vector<GLuint>& indices,
+    const std::string& name
+)
+{
+    const size_t vertex_num = vertex_buffer.size() / floats_per_vertex;
+    const float acmr = getACMR( indices );
+    const float atvr = getATVR( indices, vertex_num );
+    optimizeVertexCache( indices, vertex_num );
+    optimizeVertexFetch( vertex_buffer, floats_per_vertex, indices );
+
+    std::ostringstream report;
+    report << ">> " << name << ": ACMR " << std::fixed << std::setprecision( 3 ) << acmr << " -> "
+        << getACMR( indices ) << ", ATVR " << atvr << " -> "
+        << getATVR( indices, vertex_buffer.size() / floats_per_vertex ) << "\n";
+    std::cout << report.str();
+}
\ No newline at end of file
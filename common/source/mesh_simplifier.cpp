@@ -0,0 +1,220 @@
+#include "mesh_simplifier.h"
+
+void MeshSimplifier::Quadric::add(const glm::dvec3& normal, double distance, double weight)
+{
+    const std::array<double, 4> plane = { normal.x, normal.y, normal.z, distance };
+    int k = 0;
+    for (int i = 0; i < 4; ++i) {
+        for (int j = i; j < 4; ++j) Values[k++] += weight * plane[i] * plane[j];
+    }
+}
+
+MeshSimplifier::Quadric& MeshSimplifier::Quadric::operator+=(const Quadric& other)
+{
+    for (size_t i = 0; i < Values.size(); ++i) Values[i] += other.Values[i];
+    return *this;
+}
+
+double MeshSimplifier::Quadric::evaluate(const glm::dvec3& point) const
+{
+    const std::array<double, 4> p = { point.x, point.y, point.z, 1.0 };
+    double error = 0.0;
+    int k = 0;
+    for (int i = 0; i < 4; ++i) {
+        for (int j = i; j < 4; ++j) {
+            error += (i == j ? 1.0 : 2.0) * Values[k++] * p[i] * p[j];
+        }
+    }
+    return std::max( error, 0.0 );
+}
+
+std::vector<GLuint> MeshSimplifier::simplify(
+    const std::vector<GLfloat>& vertex_buffer,
+    int floats_per_vertex,
+    const std::vector<GLuint>& indices,
+    size_t target_index_num
+)
+{
+    const auto stride = static_cast<size_t>(floats_per_vertex);
+    const size_t vertex_num = vertex_buffer.size() / stride;
+
+    // The vertices split only by their normals or texture coordinates share one position to be collapsed.
+    std::vector<uint32_t> position_ids( vertex_num );
+    std::vector<glm::dvec3> positions;
+    std::vector<std::vector<uint32_t>> position_vertices;
+    {
+        std::map<std::array<float, 3>, uint32_t> unique_positions;
+        for (size_t v = 0; v < vertex_num; ++v) {
+            const std::array<float, 3> key = {
+                vertex_buffer[v * stride], vertex_buffer[v * stride + 1], vertex_buffer[v * stride + 2]
+            };
+            const auto [it, inserted] = unique_positions.try_emplace( key, static_cast<uint32_t>(positions.size()) );
+            if (inserted) {
+                positions.emplace_back( key[0], key[1], key[2] );
+                position_vertices.emplace_back();
+            }
+            position_ids[v] = it->second;
+            position_vertices[it->second].emplace_back( static_cast<uint32_t>(v) );
+        }
+    }
+
+    std::vector<std::array<uint32_t, 3>> triangles;
+    std::vector<std::array<GLuint, 3>> corners;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        const std::array<uint32_t, 3> triangle = {
+            position_ids[indices[i]], position_ids[indices[i + 1]], position_ids[indices[i + 2]]
+        };
+        if (triangle[0] == triangle[1] || triangle[1] == triangle[2] || triangle[2] == triangle[0]) continue;
+        triangles.emplace_back( triangle );
+        corners.push_back( { indices[i], indices[i + 1], indices[i + 2] } );
+    }
+
+    std::vector<Quadric> quadrics( positions.size() );
+    std::vector<std::vector<uint32_t>> position_triangles( positions.size() );
+    std::map<std::pair<uint32_t, uint32_t>, int> edge_counts;
+    const auto getNormal = [&positions](const std::array<uint32_t, 3>& triangle) {
+        const glm::dvec3& origin = positions[triangle[0]];
+        return cross( positions[triangle[1]] - origin, positions[triangle[2]] - origin );
+    };
+    for (uint32_t t = 0; t < triangles.size(); ++t) {
+        const auto& triangle = triangles[t];
+        const glm::dvec3 normal = getNormal( triangle );
+        const double length = glm::length( normal );
+        for (const auto& p : triangle) position_triangles[p].emplace_back( t );
+        for (int c = 0; c < 3; ++c) {
+            edge_counts[std::minmax( triangle[c], triangle[(c + 1) % 3] )]++;
+        }
+        if (length == 0.0) continue;
+
+        const glm::dvec3 unit_normal = normal / length;
+        Quadric quadric;
+        quadric.add( unit_normal, -dot( unit_normal, positions[triangle[0]] ), length * 0.5 );
+        for (const auto& p : triangle) quadrics[p] += quadric;
+    }
+    for (const auto& triangle : triangles) {
+        const glm::dvec3 normal = getNormal( triangle );
+        for (int c = 0; c < 3; ++c) {
+            const uint32_t a = triangle[c], b = triangle[(c + 1) % 3];
+            if (edge_counts[std::minmax( a, b )] != 1) continue;
+
+            const glm::dvec3 edge = positions[b] - positions[a];
+            const glm::dvec3 boundary_normal = cross( edge, normal );
+            const double length = glm::length( boundary_normal );
+            if (length == 0.0) continue;
+
+            const glm::dvec3 unit_normal = boundary_normal / length;
+            Quadric quadric;
+            quadric.add( unit_normal, -dot( unit_normal, positions[a] ), BoundaryWeight * dot( edge, edge ) );
+            quadrics[a] += quadric;
+            quadrics[b] += quadric;
+        }
+    }
+
+    std::vector<bool> triangle_alive( triangles.size(), true );
+    std::vector<bool> position_alive( positions.size(), true );
+    std::vector<uint32_t> versions( positions.size(), 0 );
+    std::priority_queue<Collapse, std::vector<Collapse>, std::greater<>> collapses;
+    const auto pushEdge = [&](uint32_t a, uint32_t b) {
+        Quadric quadric = quadrics[a];
+        quadric += quadrics[b];
+        const double cost_to_b = quadric.evaluate( positions[b] );
+        const double cost_to_a = quadric.evaluate( positions[a] );
+        if (cost_to_b <= cost_to_a) collapses.push( { cost_to_b, a, b, versions[a], versions[b] } );
+        else collapses.push( { cost_to_a, b, a, versions[b], versions[a] } );
+    };
+    for (const auto& triangle : triangles) {
+        for (int c = 0; c < 3; ++c) {
+            // An inner edge is in two triangles in the opposite directions, so only one of them pushes it.
+            const uint32_t a = triangle[c], b = triangle[(c + 1) % 3];
+            if (a < b || edge_counts[std::minmax( a, b )] == 1) pushEdge( a, b );
+        }
+    }
+
+    // A collapse is rejected if it turns any of the remaining triangles around upside down.
+    const auto flips = [&](uint32_t from, uint32_t to) {
+        for (const auto& t : position_triangles[from]) {
+            if (!triangle_alive[t]) continue;
+
+            const auto& triangle = triangles[t];
+            if (triangle[0] == to || triangle[1] == to || triangle[2] == to) continue;
+
+            std::array<glm::dvec3, 3> moved = {
+                positions[triangle[0]], positions[triangle[1]], positions[triangle[2]]
+            };
+            const glm::dvec3 before = cross( moved[1] - moved[0], moved[2] - moved[0] );
+            for (int c = 0; c < 3; ++c) {
+                if (triangle[c] == from) moved[c] = positions[to];
+            }
+            const glm::dvec3 after = cross( moved[1] - moved[0], moved[2] - moved[0] );
+            if (dot( before, after ) <= 0.0) return true;
+        }
+        return false;
+    };
+
+    size_t alive_num = triangles.size();
+    while (alive_num * 3 > target_index_num && !collapses.empty()) {
+        const Collapse collapse = collapses.top();
+        collapses.pop();
+        if (!position_alive[collapse.From] || !position_alive[collapse.To] ||
+            versions[collapse.From] != collapse.FromVersion || versions[collapse.To] != collapse.ToVersion)
+            continue;
+        if (flips( collapse.From, collapse.To )) continue;
+
+        position_alive[collapse.From] = false;
+        quadrics[collapse.To] += quadrics[collapse.From];
+        versions[collapse.To]++;
+        for (const auto& t : position_triangles[collapse.From]) {
+            if (!triangle_alive[t]) continue;
+
+            auto& triangle = triangles[t];
+            if (triangle[0] == collapse.To || triangle[1] == collapse.To || triangle[2] == collapse.To) {
+                triangle_alive[t] = false;
+                alive_num--;
+                continue;
+            }
+            for (auto& p : triangle) {
+                if (p == collapse.From) p = collapse.To;
+            }
+            position_triangles[collapse.To].emplace_back( t );
+        }
+        position_triangles[collapse.From].clear();
+
+        for (const auto& t : position_triangles[collapse.To]) {
+            if (!triangle_alive[t]) continue;
+
+            for (const auto& p : triangles[t]) {
+                if (p != collapse.To) pushEdge( collapse.To, p );
+            }
+        }
+    }
+
+    // Each corner keeps its own vertex if its position survived, or takes the vertex at the new position whose
+    // normal and texture coordinates are the closest to its own.
+    const auto findVertex = [&](GLuint vertex, uint32_t position) {
+        if (position_ids[vertex] == position) return vertex;
+
+        GLuint closest = position_vertices[position][0];
+        float closest_distance = std::numeric_limits<float>::max();
+        for (const auto& candidate : position_vertices[position]) {
+            float distance = 0.0f;
+            for (size_t i = 3; i < stride; ++i) {
+                const float difference = vertex_buffer[candidate * stride + i] - vertex_buffer[vertex * stride + i];
+                distance += difference * difference;
+            }
+            if (distance < closest_distance) {
+                closest_distance = distance;
+                closest = candidate;
+            }
+        }
+        return closest;
+    };
+
+    std::vector<GLuint> simplified;
+    simplified.reserve( alive_num * 3 );
+    for (size_t t = 0; t < triangles.size(); ++t) {
+        if (!triangle_alive[t]) continue;
+
+        for (int c = 0; c < 3; ++c) simplified.emplace_back( findVertex( corners[t][c], triangles[t][c] ) );
+    }
+    return simplified;
+}
\ No newline at end of file
@@ -0,0 +1,191 @@
+#include "mipmap_generator.h"
+#include "thread_pool.h"
+
+const MipmapGenerator::Kernel& MipmapGenerator::getKernel(FILTER filter)
+{
+    static const Kernel box{ 0, { 0.5f, 0.5f } };
+    static const Kernel kaiser = []()
+    {
+        // The zeroth order modified Bessel function of the first kind, from its power series.
+        const auto besselI0 = [](double x)
+        {
+            double sum = 1.0, term = 1.0;
+            for (int k = 1; k < 32; ++k) {
+                term *= x * x / (4.0 * k * k);
+                sum += term;
+            }
+            return sum;
+        };
+
+        // The sinc is stretched to the destination pixel, and the window spans 3 source pixels on each side.
+        constexpr double alpha = 4.0;
+        constexpr double radius = 3.0;
+        const double pi = std::acos( -1.0 );
+        Kernel kernel{ -2, {} };
+        double sum = 0.0;
+        std::vector<double> weights;
+        for (int tap = 0; tap < 6; ++tap) {
+            const double distance = std::abs( tap + kernel.Offset + 0.5 - 1.0 );
+            const double x = pi * distance / 2.0;
+            const double sinc = std::sin( x ) / x;
+            const double t = distance / radius;
+            const double window = besselI0( alpha * std::sqrt( 1.0 - t * t ) ) / besselI0( alpha );
+            weights.emplace_back( sinc * window );
+            sum += weights.back();
+        }
+        for (const auto& weight : weights) kernel.Weights.emplace_back( static_cast<float>(weight / sum) );
+        return kernel;
+    }();
+    return filter == Kaiser ? kaiser : box;
+}
+
+const std::array<float, 256>& MipmapGenerator::getLinearTable()
+{
+    static const std::array<float, 256> table = []()
+    {
+        std::array<float, 256> linear{};
+        for (int i = 0; i < 256; ++i) {
+            const double c = i / 255.0;
+            linear[i] = static_cast<float>(c <= 0.04045 ? c / 12.92 : std::pow( (c + 0.055) / 1.055, 2.4 ));
+        }
+        return linear;
+    }();
+    return table;
+}
+
+uint8_t MipmapGenerator::encodeSRGB(float linear)
+{
+    // The linear values halfway between two adjacent codes, so that the encoding rounds exactly.
+    static const std::array<float, 255> thresholds = []()
+    {
+        std::array<float, 255> values{};
+        for (int i = 0; i < 255; ++i) {
+            const double c = (i + 0.5) / 255.0;
+            values[i] = static_cast<float>(c <= 0.04045 ? c / 12.92 : std::pow( (c + 0.055) / 1.055, 2.4 ));
+        }
+        return values;
+    }();
+
+    // A coarse table gives a code no larger than the answer, which the thresholds then step up to it.
+    static const std::array<uint8_t, 4097> coarse_codes = []()
+    {
+        std::array<uint8_t, 4097> codes{};
+        for (int i = 0; i <= 4096; ++i) {
+            const float value = static_cast<float>(i) / 4096.0f;
+            codes[i] = static_cast<uint8_t>(std::ranges::upper_bound( thresholds, value ) - thresholds.begin());
+        }
+        return codes;
+    }();
+
+    int code = coarse_codes[static_cast<int>(linear * 4096.0f)];
+    while (code < 255 && linear >= thresholds[code]) ++code;
+    return static_cast<uint8_t>(code);
+}
+
+void MipmapGenerator::downsampleRows(
+    std::vector<float>& destination,
+    const std::vector<float>& source,
+    int width,
+    int height,
+    int channel_num,
+    const Kernel& kernel,
+    int row_begin,
+    int row_end
+)
+{
+    const int next_width = std::max( width / 2, 1 );
+    const auto tap_num = static_cast<int>(kernel.Weights.size());
+    const size_t row_size = static_cast<size_t>(width) * channel_num;
+    std::vector<float> column( row_size );
+    for (int y = row_begin; y < row_end; ++y) {
+        // The vertical pass weights whole rows, which the compiler turns into packed multiply-adds.
+        std::fill( column.begin(), column.end(), 0.0f );
+        for (int tap = 0; tap < tap_num; ++tap) {
+            const int row = std::clamp( y * 2 + kernel.Offset + tap, 0, height - 1 );
+            const float weight = kernel.Weights[tap];
+            const float* src = source.data() + row * row_size;
+            for (size_t i = 0; i < row_size; ++i) column[i] += weight * src[i];
+        }
+
+        float* dst = destination.data() + static_cast<size_t>(y) * next_width * channel_num;
+        for (int x = 0; x < next_width; ++x) {
+            for (int c = 0; c < channel_num; ++c) {
+                float value = 0.0f;
+                for (int tap = 0; tap < tap_num; ++tap) {
+                    const int column_x = std::clamp( x * 2 + kernel.Offset + tap, 0, width - 1 );
+                    value += kernel.Weights[tap] * column[static_cast<size_t>(column_x) * channel_num + c];
+                }
+
+                // The negative lobes of the sinc can overshoot around sharp edges.
+                dst[x * channel_num + c] = std::clamp( value, 0.0f, 1.0f );
+            }
+        }
+    }
+}
+
+void MipmapGenerator::generate(
+    std::vector<std::vector<uint8_t>>& levels,
+    const uint8_t* pixels,
+    int width,
+    int height,
+    int channel_num,
+    FILTER filter,
+    bool gamma_correct,
+    int thread_num
+)
+{
+    const auto& linear_table = getLinearTable();
+    const Kernel& kernel = getKernel( filter );
+
+    std::vector<float> current( static_cast<size_t>(width) * height * channel_num ), next;
+    for (size_t i = 0; i < current.size(); ++i) {
+        const auto channel = static_cast<int>(i % channel_num);
+        current[i] = isGammaChannel( channel, channel_num, gamma_correct ) ?
+            linear_table[pixels[i]] : static_cast<float>(pixels[i]) / 255.0f;
+    }
+
+    levels.clear();
+    int level_width = width, level_height = height;
+    while (level_width > 1 || level_height > 1) {
+        const int next_width = std::max( level_width / 2, 1 );
+        const int next_height = std::max( level_height / 2, 1 );
+        next.resize( static_cast<size_t>(next_width) * next_height * channel_num );
+
+        // On a worker, the rows are filtered right here, since waiting for other tasks of the pool could deadlock it.
+        const int task_num = ThreadPool::isWorkerThread() ?
+            1 : std::clamp( std::min( thread_num, next_height / MinRowsPerTask ), 1, next_height );
+        if (task_num == 1) {
+            downsampleRows( next, current, level_width, level_height, channel_num, kernel, 0, next_height );
+        }
+        else {
+            std::vector<std::future<void>> tasks;
+            for (int i = 0; i < task_num; ++i) {
+                const int row_begin = next_height * i / task_num;
+                const int row_end = next_height * (i + 1) / task_num;
+                tasks.emplace_back(
+                    ThreadPool::getInstance().submit(
+                        [&, row_begin, row_end]()
+                        {
+                            downsampleRows(
+                                next, current, level_width, level_height, channel_num, kernel, row_begin, row_end
+                            );
+                        }
+                    )
+                );
+            }
+            for (auto& task : tasks) task.get();
+        }
+
+        std::vector<uint8_t>& level = levels.emplace_back( next.size() );
+        for (size_t i = 0; i < next.size(); ++i) {
+            const auto channel = static_cast<int>(i % channel_num);
+            level[i] = isGammaChannel( channel, channel_num, gamma_correct ) ?
+                encodeSRGB( next[i] ) :
+                static_cast<uint8_t>(next[i] * 255.0f + 0.5f);
+        }
+
+        current.swap( next );
+        level_width = next_width;
+        level_height = next_height;
+    }
+}
\ No newline at end of file
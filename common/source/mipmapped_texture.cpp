@@ -0,0 +1,135 @@
+#include "mipmapped_texture.h"
+
+bool MipmappedTexture::decodeImage(
+    std::vector<uint8_t>& pixels,
+    int& width,
+    int& height,
+    const std::string& file_path,
+    bool is_grayscale
+)
+{
+    const FREE_IMAGE_FORMAT format = FreeImage_GetFileType( file_path.c_str(), 0 );
+    FIBITMAP* texture = FreeImage_Load( format, file_path.c_str() );
+    if (!texture) {
+        std::cout << "Could not read image file " << file_path << "\n";
+        return false;
+    }
+
+    FIBITMAP* texture_converted;
+    const uint n_bits_per_pixel = FreeImage_GetBPP( texture );
+    const uint n_bits = is_grayscale ? 8 : 32;
+    if (is_grayscale) {
+        texture_converted = n_bits_per_pixel == n_bits ? texture : FreeImage_GetChannel( texture, FICC_RED );
+    }
+    else {
+        texture_converted = n_bits_per_pixel == n_bits ? texture : FreeImage_ConvertTo32Bits( texture );
+    }
+
+    // FreeImage pads the rows to 4 bytes, which the grayscale rows of an odd width need stripped.
+    width = static_cast<int>(FreeImage_GetWidth( texture_converted ));
+    height = static_cast<int>(FreeImage_GetHeight( texture_converted ));
+    const size_t row_size = static_cast<size_t>(width) * (n_bits / 8);
+    pixels.resize( row_size * height );
+    for (int y = 0; y < height; ++y) {
+        const auto* row = FreeImage_GetScanLine( texture_converted, y );
+        std::copy( row, row + row_size, pixels.begin() + static_cast<std::ptrdiff_t>(row_size * y) );
+    }
+
+    FreeImage_Unload( texture_converted );
+    if (n_bits_per_pixel != n_bits) FreeImage_Unload( texture );
+    return true;
+}
+
+bool MipmappedTexture::isValid(const std::string& source_path, int channel_num, MipmapGenerator::FILTER filter) const
+{
+    if (File.getSize() < sizeof( Header )) return false;
+    if (CacheHeader->Magic != Magic || CacheHeader->Version != Version) return false;
+    if (CacheHeader->Filter != static_cast<uint32_t>(filter) ||
+        CacheHeader->ChannelNum != static_cast<uint32_t>(channel_num))
+        return false;
+    if (CacheHeader->Width == 0 || CacheHeader->Height == 0) return false;
+    if (static_cast<int>(CacheHeader->LevelNum) != MipmapGenerator::getLevelNum( getWidth(), getHeight() ) ||
+        CacheHeader->LevelNum > MaxLevelNum)
+        return false;
+
+    for (int level = 0; level < getLevelNum(); ++level) {
+        const size_t level_size = static_cast<size_t>(getLevelWidth( level )) * getLevelHeight( level ) * channel_num;
+        if (CacheHeader->LevelOffsets[level] + level_size > File.getSize()) return false;
+    }
+
+    uint64_t size;
+    int64_t modified_time;
+    if (!MappedFile::getFileInfo( source_path, size, modified_time ) || size != CacheHeader->SourceSize) return false;
+
+    // A checkout or a copy can touch the source without changing it, so the content decides in that case.
+    return modified_time == CacheHeader->SourceModifiedTime ||
+        MappedFile::getFileHash( source_path ) == CacheHeader->SourceHash;
+}
+
+bool MipmappedTexture::open(const std::string& source_path, bool is_grayscale, MipmapGenerator::FILTER filter)
+{
+    close();
+    if (!File.open( getCachePath( source_path ) )) return false;
+
+    CacheHeader = reinterpret_cast<const Header*>(File.getData());
+    if (!isValid( source_path, is_grayscale ? 1 : 4, filter )) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool MipmappedTexture::load(
+    const std::string& source_path,
+    bool is_grayscale,
+    MipmapGenerator::FILTER filter,
+    int thread_num
+)
+{
+    if (open( source_path, is_grayscale, filter )) return true;
+
+    std::vector<uint8_t> pixels;
+    int width = 0, height = 0;
+    if (!decodeImage( pixels, width, height, source_path, is_grayscale )) return false;
+
+    Header header{};
+    header.Magic = Magic;
+    header.Version = Version;
+    header.Filter = static_cast<uint32_t>(filter);
+    header.ChannelNum = is_grayscale ? 1 : 4;
+    header.Width = static_cast<uint32_t>(width);
+    header.Height = static_cast<uint32_t>(height);
+    header.LevelNum = static_cast<uint32_t>(MipmapGenerator::getLevelNum( width, height ));
+    if (header.LevelNum > MaxLevelNum) return false;
+    if (!MappedFile::getFileInfo( source_path, header.SourceSize, header.SourceModifiedTime )) return false;
+    header.SourceHash = MappedFile::getFileHash( source_path );
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::vector<uint8_t>> levels;
+    MipmapGenerator::generate(
+        levels, pixels.data(), width, height, static_cast<int>(header.ChannelNum), filter, !is_grayscale, thread_num
+    );
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+    Blob.assign( sizeof( Header ), 0 );
+    header.LevelOffsets[0] = Blob.size();
+    Blob.insert( Blob.end(), pixels.begin(), pixels.end() );
+    for (size_t i = 0; i < levels.size(); ++i) {
+        header.LevelOffsets[i + 1] = Blob.size();
+        Blob.insert( Blob.end(), levels[i].begin(), levels[i].end() );
+    }
+    std::memcpy( Blob.data(), &header, sizeof( Header ) );
+    CacheHeader = reinterpret_cast<const Header*>(Blob.data());
+
+    const std::string file_name = std::filesystem::path( source_path ).filename().string();
+    std::ostringstream report;
+    report << ">> " << file_name << ": " << header.LevelNum << " levels of " << width << "x" << height << " by the "
+        << (filter == MipmapGenerator::Kaiser ? "Kaiser" : "box") << " filter in " << std::fixed
+        << std::setprecision( 1 ) << elapsed.count() << " ms\n";
+    std::cout << report.str();
+
+    if (!MappedFile::writeAtomically( getCachePath( source_path ), Blob.data(), Blob.size() )) {
+        std::cout << ">> " << file_name << ": could not write the mipmap cache\n";
+    }
+    return true;
+}
\ No newline at end of file
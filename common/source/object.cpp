@@ -1,4 +1,8 @@
 #include "object.h"
+#include "asset_loader.h"
+#include "object_reader.h"
+#include "mesh_optimizer.h"
+#include "thread_pool.h"
 
 ObjectGL::~ObjectGL()
 {
@@ -6,10 +10,12 @@ ObjectGL::~ObjectGL()
         glDeleteBuffers( 1, &IBO );
     if (VBO != 0)
         glDeleteBuffers( 1, &VBO );
+    if (MorphTargetBuffer != 0)
+        glDeleteBuffers( 1, &MorphTargetBuffer );
     if (VAO != 0)
         glDeleteVertexArrays( 1, &VAO );
     for (const auto& texture_id : TextureID) {
-        if (texture_id != 0)
+        if (texture_id != 0 && !TextureCache::getInstance().release( texture_id ))
             glDeleteTextures( 1, &texture_id );
     }
     for (const auto& buffer : CustomBuffers) {
@@ -38,7 +44,13 @@ bool ObjectGL::prepareTexture2DUsingFreeImage(const std::string& file_path, bool
     const auto width = static_cast<GLsizei>(FreeImage_GetWidth( texture_converted ));
     const auto height = static_cast<GLsizei>(FreeImage_GetHeight( texture_converted ));
     const GLvoid* data = FreeImage_GetBits( texture_converted );
-    glTextureStorage2D( TextureID.back(), 1, is_grayscale ? GL_R8 : GL_RGBA8, width, height );
+    glTextureStorage2D(
+        TextureID.back(),
+        MipmapGenerator::getLevelNum( width, height ),
+        is_grayscale ? GL_R8 : GL_RGBA8,
+        width,
+        height
+    );
     glTextureSubImage2D(
         TextureID.back(), 0, 0, 0,
         width, height,
@@ -78,7 +90,7 @@ void ObjectGL::addTexture(int width, int height, bool is_grayscale)
     glCreateTextures( GL_TEXTURE_2D, 1, &texture_id );
     glTextureStorage2D(
         texture_id,
-        1,
+        MipmapGenerator::getLevelNum( width, height ),
         is_grayscale ? GL_R8 : GL_RGBA8,
         width,
         height
@@ -87,7 +99,6 @@ void ObjectGL::addTexture(int width, int height, bool is_grayscale)
     glTextureParameteri( texture_id, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
     glTextureParameteri( texture_id, GL_TEXTURE_WRAP_S, GL_REPEAT );
     glTextureParameteri( texture_id, GL_TEXTURE_WRAP_T, GL_REPEAT );
-    glGenerateTextureMipmap( texture_id );
     TextureID.emplace_back( texture_id );
     TextureIDToSize[TextureID.back()] = glm::ivec2( width, height );
 }
@@ -106,9 +117,190 @@ int ObjectGL::addTexture(const uint8_t* image_buffer, int width, int height, boo
         GL_UNSIGNED_BYTE,
         image_buffer
     );
+    glGenerateTextureMipmap( TextureID.back() );
+    return static_cast<int>(TextureID.size() - 1);
+}
+
+int ObjectGL::addTexture(const MipmappedTexture& texture)
+{
+    const bool is_grayscale = texture.isGrayscale();
+    addTexture( texture.getWidth(), texture.getHeight(), is_grayscale );
+
+    // The levels are tightly packed, so the grayscale rows of an odd width are not 4-byte aligned.
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+    for (int level = 0; level < texture.getLevelNum(); ++level) {
+        glTextureSubImage2D(
+            TextureID.back(),
+            level,
+            0,
+            0,
+            texture.getLevelWidth( level ),
+            texture.getLevelHeight( level ),
+            is_grayscale ? GL_RED : GL_BGRA,
+            GL_UNSIGNED_BYTE,
+            texture.getLevelData( level )
+        );
+    }
+    glPixelStorei( GL_UNPACK_ALIGNMENT, 4 );
+    return static_cast<int>(TextureID.size() - 1);
+}
+
+int ObjectGL::addTexture(const std::string& texture_file_path, MipmapGenerator::FILTER filter, bool is_grayscale)
+{
+    MipmappedTexture texture;
+    if (!texture.load( texture_file_path, is_grayscale, filter, ThreadPool::getHardwareThreadNum() )) {
+        throw std::runtime_error( "Could not read image file " + texture_file_path );
+    }
+    return addTexture( texture );
+}
+
+int ObjectGL::addTexture(const CompressedTexture& texture)
+{
+    GLuint texture_id = 0;
+    glCreateTextures( GL_TEXTURE_2D, 1, &texture_id );
+    glTextureStorage2D(
+        texture_id,
+        texture.getLevelNum(),
+        texture.getInternalFormat(),
+        texture.getWidth(),
+        texture.getHeight()
+    );
+    for (int level = 0; level < texture.getLevelNum(); ++level) {
+        glCompressedTextureSubImage2D(
+            texture_id,
+            level,
+            0,
+            0,
+            texture.getLevelWidth( level ),
+            texture.getLevelHeight( level ),
+            texture.getInternalFormat(),
+            texture.getLevelSize( level ),
+            texture.getLevelData( level )
+        );
+    }
+    glTextureParameteri( texture_id, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR );
+    glTextureParameteri( texture_id, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+    glTextureParameteri( texture_id, GL_TEXTURE_WRAP_S, GL_REPEAT );
+    glTextureParameteri( texture_id, GL_TEXTURE_WRAP_T, GL_REPEAT );
+    TextureID.emplace_back( texture_id );
+    TextureIDToSize[TextureID.back()] = glm::ivec2( texture.getWidth(), texture.getHeight() );
+    return static_cast<int>(TextureID.size() - 1);
+}
+
+int ObjectGL::addTexture(const std::string& texture_file_path, BlockCompressor::FORMAT format)
+{
+    CompressedTexture texture;
+    if (!texture.load( texture_file_path, format, BlockCompressor::High, ThreadPool::getHardwareThreadNum() )) {
+        throw std::runtime_error( "Could not read image file " + texture_file_path );
+    }
+    return addTexture( texture );
+}
+
+int ObjectGL::addTextureThroughCache(
+    const std::string& key,
+    const std::function<int()>& addNewTexture,
+    double bytes_per_pixel
+)
+{
+    TextureCache& cache = TextureCache::getInstance();
+    if (const TextureCache::Entry* entry = cache.acquire( key )) {
+        TextureID.emplace_back( entry->TextureID );
+        TextureIDToSize[entry->TextureID] = entry->Size;
+        return static_cast<int>(TextureID.size() - 1);
+    }
+
+    const int index = addNewTexture();
+    const glm::ivec2 size = TextureIDToSize[TextureID[index]];
+    const auto bytes = static_cast<size_t>(static_cast<double>(size.x) * size.y * bytes_per_pixel);
+    cache.insert( key, TextureID[index], size, bytes );
+    return index;
+}
+
+int ObjectGL::addSharedTexture(const std::string& texture_file_path, bool is_grayscale)
+{
+    return addTextureThroughCache(
+        TextureCache::getFileKey( texture_file_path, is_grayscale ? "R8" : "RGBA8" ),
+        [&]() { return addTexture( texture_file_path, is_grayscale ); },
+        is_grayscale ? 1 : 4
+    );
+}
+
+int ObjectGL::addSharedTexture(const uint8_t* image_buffer, int width, int height, bool is_grayscale)
+{
+    const int bytes_per_pixel = is_grayscale ? 1 : 4;
+    const std::string variant =
+        std::to_string( width ) + "x" + std::to_string( height ) + (is_grayscale ? " R8" : " RGBA8");
+    return addTextureThroughCache(
+        TextureCache::getContentKey(
+            image_buffer, static_cast<size_t>(width) * height * bytes_per_pixel, variant
+        ),
+        [&]() { return addTexture( image_buffer, width, height, is_grayscale ); },
+        bytes_per_pixel
+    );
+}
+
+int ObjectGL::addSharedTexture(const std::string& texture_file_path, BlockCompressor::FORMAT format)
+{
+    return addTextureThroughCache(
+        TextureCache::getFileKey( texture_file_path, BlockCompressor::getFormatName( format ) ),
+        [&]() { return addTexture( texture_file_path, format ); },
+        BlockCompressor::getBlockBytes( format ) / 16.0
+    );
+}
+
+int ObjectGL::addTextureArray(int width, int height, int layer_num)
+{
+    GLuint texture_id = 0;
+    glCreateTextures( GL_TEXTURE_2D_ARRAY, 1, &texture_id );
+    glTextureStorage3D(
+        texture_id,
+        MipmapGenerator::getLevelNum( width, height ),
+        GL_RGBA8,
+        width,
+        height,
+        layer_num
+    );
+    glTextureParameteri( texture_id, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR );
+    glTextureParameteri( texture_id, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+    glTextureParameteri( texture_id, GL_TEXTURE_WRAP_S, GL_REPEAT );
+    glTextureParameteri( texture_id, GL_TEXTURE_WRAP_T, GL_REPEAT );
+    TextureID.emplace_back( texture_id );
+    TextureIDToSize[TextureID.back()] = glm::ivec2( width, height );
     return static_cast<int>(TextureID.size() - 1);
 }
 
+int ObjectGL::addTextureArray(
+    const std::vector<std::string>& texture_file_paths,
+    int width,
+    int height,
+    MipmapGenerator::FILTER filter
+)
+{
+    std::vector<AssetLoader::Image> images;
+    if (!AssetLoader::decodeImages( images, texture_file_paths, false, width, height ))
+        throw std::runtime_error( "Could not read the images of a texture array" );
+
+    const int index = addTextureArray( width, height, static_cast<int>(images.size()) );
+    const GLuint texture_id = TextureID.back();
+    std::vector<std::vector<uint8_t>> levels;
+    for (size_t layer = 0; layer < images.size(); ++layer) {
+        MipmapGenerator::generate(
+            levels, images[layer].Pixels.data(), width, height, 4, filter, true, ThreadPool::getHardwareThreadNum()
+        );
+        for (int level = 0; level <= static_cast<int>(levels.size()); ++level) {
+            glTextureSubImage3D(
+                texture_id, level,
+                0, 0, static_cast<GLint>(layer),
+                std::max( width >> level, 1 ), std::max( height >> level, 1 ), 1,
+                GL_BGRA,
+                GL_UNSIGNED_BYTE,
+                level == 0 ? images[layer].Pixels.data() : levels[level - 1].data()
+            );
+        }
+    }
+    return index;
+}
+
 void ObjectGL::addCubeTextures(const std::array<uint8_t*, 6>& textures, int width, int height)
 {
     GLuint texture_id = 0;
@@ -138,6 +330,10 @@ void ObjectGL::addCubeTextures(const std::array<uint8_t*, 6>& textures, int widt
 
 void ObjectGL::addCubeTextures(const std::array<std::string, 6>& texture_paths)
 {
+    std::vector<AssetLoader::Image> images;
+    if (!AssetLoader::decodeImages( images, { texture_paths.begin(), texture_paths.end() } ))
+        throw std::runtime_error( "Could not read the faces of a cube map" );
+
     GLuint texture_id = 0;
     glCreateTextures( GL_TEXTURE_CUBE_MAP, 1, &texture_id );
     glBindTexture( GL_TEXTURE_CUBE_MAP, texture_id );
@@ -153,21 +349,13 @@ void ObjectGL::addCubeTextures(const std::array<std::string, 6>& texture_paths)
     glGenerateTextureMipmap( texture_id );
 
     for (int i = 0; i < 6; ++i) {
-        const FREE_IMAGE_FORMAT format = FreeImage_GetFileType( texture_paths[i].c_str(), 0 );
-        FIBITMAP* texture = FreeImage_Load( format, texture_paths[i].c_str() );
-        const uint n_bits_per_pixel = FreeImage_GetBPP( texture );
-        FIBITMAP* texture_converted = n_bits_per_pixel == 32 ? texture : FreeImage_ConvertTo32Bits( texture );
-        const auto width = static_cast<GLsizei>(FreeImage_GetWidth( texture_converted ));
-        const auto height = static_cast<GLsizei>(FreeImage_GetHeight( texture_converted ));
         glTexImage2D(
             GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
             0, GL_RGB,
-            width, height, 0,
+            images[i].Width, images[i].Height, 0,
             GL_BGRA, GL_UNSIGNED_BYTE,
-            FreeImage_GetBits( texture_converted )
+            images[i].Pixels.data()
         );
-        FreeImage_Unload( texture_converted );
-        if (n_bits_per_pixel != 32) FreeImage_Unload( texture );
     }
 }
 
@@ -187,9 +375,18 @@ void ObjectGL::prepareNormal() const
 }
 
 void ObjectGL::prepareVertexBuffer(int n_bytes_per_vertex)
+{
+    prepareVertexBuffer(
+        n_bytes_per_vertex,
+        DataBuffer.data(),
+        static_cast<GLsizeiptr>(sizeof( GLfloat ) * DataBuffer.size())
+    );
+}
+
+void ObjectGL::prepareVertexBuffer(int n_bytes_per_vertex, const void* data, GLsizeiptr size)
 {
     glCreateBuffers( 1, &VBO );
-    glNamedBufferStorage( VBO, sizeof( GLfloat ) * DataBuffer.size(), DataBuffer.data(), GL_DYNAMIC_STORAGE_BIT );
+    glNamedBufferStorage( VBO, size, data, GL_DYNAMIC_STORAGE_BIT | GL_MAP_WRITE_BIT );
 
     glCreateVertexArrays( 1, &VAO );
     glVertexArrayVertexBuffer( VAO, 0, VBO, 0, n_bytes_per_vertex );
@@ -199,6 +396,11 @@ void ObjectGL::prepareVertexBuffer(int n_bytes_per_vertex)
 }
 
 void ObjectGL::prepareIndexBuffer(const std::vector<GLuint>& indices)
+{
+    prepareIndexBuffer( indices.data(), static_cast<GLsizei>(indices.size()) );
+}
+
+void ObjectGL::prepareIndexBuffer(const void* indices, GLsizei index_num)
 {
     assert( VAO != 0 );
 
@@ -206,8 +408,95 @@ void ObjectGL::prepareIndexBuffer(const std::vector<GLuint>& indices)
         glDeleteBuffers( 1, &IBO );
 
     glCreateBuffers( 1, &IBO );
-    glNamedBufferStorage( IBO, sizeof( GLuint ) * indices.size(), indices.data(), GL_DYNAMIC_STORAGE_BIT );
+    glNamedBufferStorage( IBO, sizeof( GLuint ) * index_num, indices, GL_DYNAMIC_STORAGE_BIT );
     glVertexArrayElementBuffer( VAO, IBO );
+    IndicesCount = index_num;
+    LevelIndexOffsets = { 0 };
+    LevelIndexNums = { index_num };
+}
+
+void ObjectGL::prepareIndexedBuffers(int floats_per_vertex, const std::vector<GLuint>& indices)
+{
+    const int n_bytes_per_vertex = floats_per_vertex * static_cast<int>(sizeof( GLfloat ));
+    if (OptimizeMesh && DrawMode == GL_TRIANGLES) {
+        std::vector<GLuint> optimized_indices = indices;
+        MeshOptimizer::optimize( DataBuffer, floats_per_vertex, optimized_indices, "indexed object" );
+        VerticesCount = static_cast<GLsizei>(DataBuffer.size() / floats_per_vertex);
+        prepareVertexBuffer( n_bytes_per_vertex );
+        prepareIndexBuffer( optimized_indices );
+    }
+    else {
+        prepareVertexBuffer( n_bytes_per_vertex );
+        prepareIndexBuffer( indices );
+    }
+}
+
+void ObjectGL::prepareQuantizedVertexBuffer(
+    const std::vector<uint8_t>& quantized,
+    bool normals_exist,
+    bool textures_exist
+)
+{
+    using q = VertexQuantizer;
+
+    glCreateBuffers( 1, &VBO );
+    glNamedBufferStorage( VBO, static_cast<GLsizeiptr>(quantized.size()), quantized.data(), GL_DYNAMIC_STORAGE_BIT );
+
+    glCreateVertexArrays( 1, &VAO );
+    glVertexArrayVertexBuffer( VAO, 0, VBO, 0, q::getBytesPerVertex( normals_exist, textures_exist ) );
+    glVertexArrayAttribFormat( VAO, VertexLocation, 3, GL_SHORT, GL_TRUE, 0 );
+    glEnableVertexArrayAttrib( VAO, VertexLocation );
+    glVertexArrayAttribBinding( VAO, VertexLocation, 0 );
+
+    GLuint offset = q::PositionBytes;
+    if (normals_exist) {
+        if (VertexFormat == Compact2101010) {
+            glVertexArrayAttribFormat( VAO, NormalLocation, 4, GL_INT_2_10_10_10_REV, GL_TRUE, offset );
+        }
+        else glVertexArrayAttribFormat( VAO, NormalLocation, 2, GL_SHORT, GL_TRUE, offset );
+        glEnableVertexArrayAttrib( VAO, NormalLocation );
+        glVertexArrayAttribBinding( VAO, NormalLocation, 0 );
+        offset += q::NormalBytes;
+    }
+    if (textures_exist) {
+        glVertexArrayAttribFormat( VAO, TextureLocation, 2, GL_HALF_FLOAT, GL_FALSE, offset );
+        glEnableVertexArrayAttrib( VAO, TextureLocation );
+        glVertexArrayAttribBinding( VAO, TextureLocation, 0 );
+    }
+}
+
+void ObjectGL::prepareIndexedObject(
+    GLenum draw_mode,
+    const void* vertex_buffer,
+    GLsizei vertex_num,
+    const void* indices,
+    GLsizei index_num,
+    bool normals_exist,
+    bool textures_exist
+)
+{
+    DrawMode = draw_mode;
+    VerticesCount = vertex_num;
+    const int n_bytes_per_vertex =
+        static_cast<int>((3 + (normals_exist ? 3 : 0) + (textures_exist ? 2 : 0)) * sizeof( GLfloat ));
+    prepareVertexBuffer( n_bytes_per_vertex, vertex_buffer, static_cast<GLsizeiptr>(n_bytes_per_vertex) * vertex_num );
+    if (normals_exist) prepareNormal();
+    if (textures_exist) prepareTexture( normals_exist );
+    prepareIndexBuffer( indices, index_num );
+}
+
+std::vector<GLuint> ObjectGL::getGridStripIndices(const glm::ivec2& point_num)
+{
+    std::vector<GLuint> indices;
+    indices.reserve( static_cast<size_t>(point_num.y - 1) * (point_num.x * 2 + 1) );
+    for (int j = 0; j < point_num.y - 1; ++j) {
+        if (j > 0) indices.emplace_back( RestartIndex );
+        for (int i = 0; i < point_num.x; ++i) {
+            indices.emplace_back( (j + 1) * point_num.x + i );
+            indices.emplace_back( j * point_num.x + i );
+        }
+    }
+    return indices;
 }
 
 void ObjectGL::getSquareObject(
@@ -256,17 +545,7 @@ void ObjectGL::setObject(GLenum draw_mode, int vertex_num)
 
 void ObjectGL::setObject(GLenum draw_mode, const std::vector<glm::vec3>& vertices)
 {
-    DrawMode = draw_mode;
-    VerticesCount = 0;
-    for (auto& vertex : vertices) {
-        DataBuffer.emplace_back( vertex.x );
-        DataBuffer.emplace_back( vertex.y );
-        DataBuffer.emplace_back( vertex.z );
-        VerticesCount++;
-    }
-    constexpr int n_bytes_per_vertex = 3 * sizeof( GLfloat );
-    prepareVertexBuffer( n_bytes_per_vertex );
-    DataBuffer.clear();
+    setVertices<PositionLayout>( draw_mode, vertices.size(), vertices.data() );
 }
 
 void ObjectGL::setObject(
@@ -274,6 +553,16 @@ void ObjectGL::setObject(
     const std::vector<glm::vec3>& vertices,
     const std::vector<glm::vec3>& normals
 )
+{
+    setVertices<PositionNormalLayout>( draw_mode, vertices.size(), vertices.data(), normals.data() );
+}
+
+void ObjectGL::setObject(
+    GLenum draw_mode,
+    const std::vector<glm::vec3>& vertices,
+    const std::vector<glm::vec3>& normals,
+    const std::vector<GLuint>& indices
+)
 {
     DrawMode = draw_mode;
     VerticesCount = 0;
@@ -286,8 +575,7 @@ void ObjectGL::setObject(
         DataBuffer.emplace_back( normals[i].z );
         VerticesCount++;
     }
-    constexpr int n_bytes_per_vertex = 6 * sizeof( GLfloat );
-    prepareVertexBuffer( n_bytes_per_vertex );
+    prepareIndexedBuffers( 6, indices );
     prepareNormal();
     DataBuffer.clear();
 }
@@ -324,24 +612,13 @@ void ObjectGL::setObject(
     const std::vector<glm::vec2>& textures
 )
 {
-    DrawMode = draw_mode;
-    VerticesCount = 0;
-    for (size_t i = 0; i < vertices.size(); ++i) {
-        DataBuffer.emplace_back( vertices[i].x );
-        DataBuffer.emplace_back( vertices[i].y );
-        DataBuffer.emplace_back( vertices[i].z );
-        DataBuffer.emplace_back( normals[i].x );
-        DataBuffer.emplace_back( normals[i].y );
-        DataBuffer.emplace_back( normals[i].z );
-        DataBuffer.emplace_back( textures[i].x );
-        DataBuffer.emplace_back( textures[i].y );
-        VerticesCount++;
-    }
-    constexpr int n_bytes_per_vertex = 8 * sizeof( GLfloat );
-    prepareVertexBuffer( n_bytes_per_vertex );
-    prepareNormal();
-    prepareTexture( true );
-    DataBuffer.clear();
+    setVertices<PositionNormalTextureLayout>(
+        draw_mode,
+        vertices.size(),
+        vertices.data(),
+        normals.data(),
+        textures.data()
+    );
 }
 
 void ObjectGL::setObject(
@@ -365,11 +642,9 @@ void ObjectGL::setObject(
         DataBuffer.emplace_back( textures[i].y );
         VerticesCount++;
     }
-    constexpr int n_bytes_per_vertex = 8 * sizeof( GLfloat );
-    prepareVertexBuffer( n_bytes_per_vertex );
+    prepareIndexedBuffers( 8, indices );
     prepareNormal();
     prepareTexture( true );
-    prepareIndexBuffer( indices );
     DataBuffer.clear();
 }
 
@@ -415,6 +690,129 @@ void ObjectGL::setObject(
     addTexture( texture_file_path, is_grayscale );
 }
 
+void ObjectGL::setObject(GLenum draw_mode, const MeshCache& mesh)
+{
+    if (VertexFormat == FullPrecision) {
+        DequantizationMatrix = glm::mat4( 1.0f );
+        prepareIndexedObject(
+            draw_mode,
+            mesh.getVertexBuffer(), mesh.getVertexNum(),
+            mesh.getIndices(), mesh.getTotalIndexNum(),
+            mesh.normalsExist(), mesh.texturesExist()
+        );
+    }
+    else {
+        const auto encoding =
+            VertexFormat == Compact2101010 ? VertexQuantizer::Int2101010 : VertexQuantizer::Octahedral;
+        const auto* vertex_buffer = static_cast<const GLfloat*>(mesh.getVertexBuffer());
+        const auto vertex_num = static_cast<size_t>(mesh.getVertexNum());
+        std::vector<uint8_t> quantized;
+        DequantizationMatrix = VertexQuantizer::quantize(
+            quantized, vertex_buffer, vertex_num, mesh.normalsExist(), mesh.texturesExist(), encoding
+        );
+
+        DrawMode = draw_mode;
+        VerticesCount = mesh.getVertexNum();
+        prepareQuantizedVertexBuffer( quantized, mesh.normalsExist(), mesh.texturesExist() );
+        prepareIndexBuffer( mesh.getIndices(), mesh.getTotalIndexNum() );
+    }
+
+    // All the levels are in the one index buffer, and the draws pick theirs by the offset.
+    IndicesCount = mesh.getIndexNum( 0 );
+    LevelIndexOffsets.clear();
+    LevelIndexNums.clear();
+    GLsizei offset = 0;
+    for (int level = 0; level < mesh.getLevelNum(); ++level) {
+        LevelIndexOffsets.emplace_back( offset );
+        LevelIndexNums.emplace_back( mesh.getIndexNum( level ) );
+        offset += mesh.getIndexNum( level );
+    }
+
+    const auto* vertex_buffer = static_cast<const GLfloat*>(mesh.getVertexBuffer());
+    const auto stride = static_cast<size_t>(mesh.getBytesPerVertex() / sizeof( GLfloat ));
+    glm::vec3 min_point( std::numeric_limits<float>::max() ), max_point( std::numeric_limits<float>::lowest() );
+    for (GLsizei i = 0; i < mesh.getVertexNum(); ++i) {
+        const glm::vec3 position = glm::make_vec3( vertex_buffer + i * stride );
+        min_point = glm::min( min_point, position );
+        max_point = glm::max( max_point, position );
+    }
+    BoundingCenter = (min_point + max_point) * 0.5f;
+    BoundingRadius = 0.0f;
+    for (GLsizei i = 0; i < mesh.getVertexNum(); ++i) {
+        const glm::vec3 position = glm::make_vec3( vertex_buffer + i * stride );
+        BoundingRadius = std::max( BoundingRadius, glm::length( position - BoundingCenter ) );
+    }
+
+    // The bounds are kept in the space of the vertex buffer, where the world matrix of the draws starts from.
+    BoundingCenter = glm::vec3( inverse( DequantizationMatrix ) * glm::vec4( BoundingCenter, 1.0f ) );
+    BoundingRadius /= DequantizationMatrix[0][0];
+}
+
+void ObjectGL::setMorphObject(
+    GLenum draw_mode,
+    const std::vector<glm::vec3>& vertices,
+    const std::vector<glm::vec3>& normals,
+    const std::vector<glm::vec2>& textures,
+    const std::vector<GLuint>& indices,
+    const std::vector<glm::vec4>& deltas
+)
+{
+    std::vector<GLuint> ordered_indices = indices;
+    if (draw_mode == GL_TRIANGLES) MeshOptimizer::optimizeVertexCache( ordered_indices, vertices.size() );
+
+    // The vertex fetch optimization would reorder the vertices away from their deltas.
+    const bool optimize_mesh = OptimizeMesh;
+    OptimizeMesh = false;
+    if (textures.empty()) setObject( draw_mode, vertices, normals, ordered_indices );
+    else setObject( draw_mode, vertices, normals, textures, ordered_indices );
+    OptimizeMesh = optimize_mesh;
+
+    MorphFrameNum = static_cast<int>(deltas.size() / (vertices.size() * 2)) + 1;
+    if (!deltas.empty()) {
+        glCreateBuffers( 1, &MorphTargetBuffer );
+        glNamedBufferStorage(
+            MorphTargetBuffer,
+            static_cast<GLsizeiptr>(deltas.size() * sizeof( glm::vec4 )),
+            deltas.data(),
+            0
+        );
+    }
+}
+
+int ObjectGL::selectLevelOfDetail(const CameraGL& camera, const glm::mat4& to_world) const
+{
+    if (LevelIndexNums.size() <= 1) return 0;
+
+    const float scale = std::max(
+        {
+            glm::length( glm::vec3( to_world[0] ) ),
+            glm::length( glm::vec3( to_world[1] ) ),
+            glm::length( glm::vec3( to_world[2] ) )
+        }
+    );
+    const glm::vec3 center( to_world * glm::vec4( BoundingCenter, 1.0f ) );
+    const float size = camera.getProjectedSize( center, BoundingRadius * scale );
+    const float area = glm::pi<float>() * 0.25f * size * size;
+    for (size_t level = 0; level < LevelIndexNums.size(); ++level) {
+        const auto triangle_num = static_cast<float>(LevelIndexNums[level] / 3);
+        if (area >= triangle_num * MinPixelsPerTriangle) return static_cast<int>(level);
+    }
+    return static_cast<int>(LevelIndexNums.size()) - 1;
+}
+
+bool ObjectGL::setObjectFromFile(GLenum draw_mode, const std::string& file_path)
+{
+    const auto start = std::chrono::steady_clock::now();
+    MeshCache mesh;
+    if (!mesh.load( file_path, ThreadPool::getInstance().getThreadNum() )) return false;
+
+    setObject( draw_mode, mesh );
+    std::cout << ">> " << std::filesystem::path( file_path ).filename().string()
+        << (mesh.isMapped() ? ": loaded from the mesh cache in " : ": parsed and cached in ")
+        << std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count() << " ms\n";
+    return true;
+}
+
 void ObjectGL::setSquareObject(GLenum draw_mode, bool use_texture)
 {
     std::vector<glm::vec3> square_vertices, square_normals;
@@ -440,37 +838,23 @@ void ObjectGL::setSquareObject(GLenum draw_mode, const uint8_t* image_buffer, in
     setObject( draw_mode, square_vertices, square_normals, square_textures, image_buffer, width, height, is_grayscale );
 }
 
-void ObjectGL::updateDataBuffer(const std::vector<glm::vec3>& vertices)
+void ObjectGL::setVertexStreaming(int frames_in_flight)
 {
     assert( VBO != 0 );
 
-    VerticesCount = 0;
-    for (const auto& vertex : vertices) {
-        DataBuffer.push_back( vertex.x );
-        DataBuffer.push_back( vertex.y );
-        DataBuffer.push_back( vertex.z );
-        VerticesCount++;
-    }
-    glNamedBufferSubData( VBO, 0, static_cast<GLsizeiptr>(sizeof( GLfloat ) * DataBuffer.size()), DataBuffer.data() );
-    DataBuffer.clear();
+    GLint64 size = 0;
+    glGetNamedBufferParameteri64v( VBO, GL_BUFFER_SIZE, &size );
+    VertexRing = std::make_unique<RingBufferGL>( static_cast<GLsizeiptr>(size), frames_in_flight );
 }
 
-void ObjectGL::updateDataBuffer(const std::vector<glm::vec3>& vertices, const std::vector<glm::vec3>& normals)
+void ObjectGL::updateDataBuffer(const std::vector<glm::vec3>& vertices)
 {
-    assert( VBO != 0 );
+    updateVertices<PositionLayout>( vertices.size(), vertices.data() );
+}
 
-    VerticesCount = 0;
-    for (size_t i = 0; i < vertices.size(); ++i) {
-        DataBuffer.push_back( vertices[i].x );
-        DataBuffer.push_back( vertices[i].y );
-        DataBuffer.push_back( vertices[i].z );
-        DataBuffer.push_back( normals[i].x );
-        DataBuffer.push_back( normals[i].y );
-        DataBuffer.push_back( normals[i].z );
-        VerticesCount++;
-    }
-    glNamedBufferSubData( VBO, 0, static_cast<GLsizeiptr>(sizeof( GLfloat ) * DataBuffer.size()), DataBuffer.data() );
-    DataBuffer.clear();
+void ObjectGL::updateDataBuffer(const std::vector<glm::vec3>& vertices, const std::vector<glm::vec3>& normals)
+{
+    updateVertices<PositionNormalLayout>( vertices.size(), vertices.data(), normals.data() );
 }
 
 void ObjectGL::updateDataBuffer(
@@ -479,22 +863,7 @@ void ObjectGL::updateDataBuffer(
     const std::vector<glm::vec2>& textures
 )
 {
-    assert( VBO != 0 );
-
-    VerticesCount = 0;
-    for (size_t i = 0; i < vertices.size(); ++i) {
-        DataBuffer.push_back( vertices[i].x );
-        DataBuffer.push_back( vertices[i].y );
-        DataBuffer.push_back( vertices[i].z );
-        DataBuffer.push_back( normals[i].x );
-        DataBuffer.push_back( normals[i].y );
-        DataBuffer.push_back( normals[i].z );
-        DataBuffer.push_back( textures[i].x );
-        DataBuffer.push_back( textures[i].y );
-        VerticesCount++;
-    }
-    glNamedBufferSubData( VBO, 0, static_cast<GLsizeiptr>(sizeof( GLfloat ) * DataBuffer.size()), DataBuffer.data() );
-    DataBuffer.clear();
+    updateVertices<PositionNormalTextureLayout>( vertices.size(), vertices.data(), normals.data(), textures.data() );
 }
 
 void ObjectGL::updateTexture(const uint8_t* image_buffer, int index, int width, int height, GLenum format) const
@@ -506,6 +875,27 @@ void ObjectGL::updateTexture(const uint8_t* image_buffer, int index, int width,
         GL_UNSIGNED_BYTE,
         image_buffer
     );
+    glGenerateTextureMipmap( TextureID[index] );
+}
+
+void ObjectGL::updateTexture(RingBufferGL& pixels, int index, int width, int height, GLenum format) const
+{
+    const auto start = std::chrono::steady_clock::now();
+    glBindBuffer( GL_PIXEL_UNPACK_BUFFER, pixels.getBuffer() );
+    glTextureSubImage2D(
+        TextureID[index], 0, 0, 0,
+        width, height,
+        format,
+        GL_UNSIGNED_BYTE,
+        pixels.getRegionPointer()
+    );
+    glBindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+    const GLsizeiptr channel_num = format == GL_RED ? 1 : format == GL_RGB || format == GL_BGR ? 3 : 4;
+    pixels.addTransfer(
+        static_cast<GLsizeiptr>(width) * height * channel_num,
+        std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count()
+    );
+    glGenerateTextureMipmap( TextureID[index] );
 }
 
 void ObjectGL::updateCubeTextures(const std::array<uint8_t*, 6>& textures, int width, int height)
@@ -522,6 +912,28 @@ void ObjectGL::updateCubeTextures(const std::array<uint8_t*, 6>& textures, int w
     }
 }
 
+void ObjectGL::updateCubeTextures(RingBufferGL& pixels, int width, int height)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const GLintptr face_size = static_cast<GLintptr>(width) * height * 4;
+    glBindBuffer( GL_PIXEL_UNPACK_BUFFER, pixels.getBuffer() );
+    for (int i = 0; i < 6; ++i) {
+        glTexSubImage2D(
+            GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
+            0, 0, 0,
+            width, height,
+            GL_BGRA,
+            GL_UNSIGNED_BYTE,
+            reinterpret_cast<const void*>(static_cast<uintptr_t>(pixels.getRegionOffset() + face_size * i))
+        );
+    }
+    glBindBuffer( GL_PIXEL_UNPACK_BUFFER, 0 );
+    pixels.addTransfer(
+        face_size * 6,
+        std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count()
+    );
+}
+
 void ObjectGL::replaceVertices(
     const std::vector<glm::vec3>& vertices,
     bool normals_exist,
@@ -568,44 +980,14 @@ void ObjectGL::replaceVertices(
     );
 }
 
-bool ObjectGL::readObjectFile(std::vector<glm::vec3>& vertices, const std::string& file_path)
+bool ObjectGL::readObjectFile(std::vector<glm::vec3>& vertices, const std::string& file_path, int thread_num)
 {
-    std::ifstream file( file_path );
-    if (!file.is_open()) {
-        std::cout << "The object file is not correct.\n";
-        return false;
-    }
+    ObjectReader::ObjectData data;
+    if (!ObjectReader::readObjectFile( data, file_path, thread_num )) return false;
 
-    std::vector<glm::vec3> vertex_buffer;
-    std::vector<int> vertex_indices;
-    while (!file.eof()) {
-        std::string word;
-        file >> word;
-
-        if (word == "v") {
-            glm::vec3 vertex;
-            file >> vertex.x >> vertex.y >> vertex.z;
-            vertex_buffer.emplace_back( vertex );
-        }
-        else if (word == "f") {
-            std::string line;
-            std::getline( file, line );
-
-            const std::regex delimiter( "[ /]" );
-            const std::sregex_token_iterator it( line.begin() + 1, line.end(), delimiter, -1 );
-            const std::vector<std::string> n( it, std::sregex_token_iterator() );
-
-            assert( n.size() == 3 );
-
-            vertex_indices.emplace_back( std::stof( n[0] ) );
-            vertex_indices.emplace_back( std::stof( n[1] ) );
-            vertex_indices.emplace_back( std::stof( n[2] ) );
-        }
-        else std::getline( file, word );
-    }
-
-    for (const auto i : vertex_indices) {
-        vertices.emplace_back( vertex_buffer[i - 1] );
+    vertices.reserve( vertices.size() + data.Corners.size() );
+    for (const auto& corner : data.Corners) {
+        vertices.emplace_back( data.Vertices[corner.x] );
     }
     return true;
 }
@@ -614,96 +996,73 @@ bool ObjectGL::readObjectFile(
     std::vector<glm::vec3>& vertices,
     std::vector<glm::vec3>& normals,
     std::vector<glm::vec2>& textures,
-    const std::string& file_path
+    const std::string& file_path,
+    int thread_num
 )
 {
-    std::ifstream file( file_path );
-    if (!file.is_open()) {
-        std::cout << "The object file is not correct.\n";
-        return false;
+    ObjectReader::ObjectData data;
+    if (!ObjectReader::readObjectFile( data, file_path, thread_num )) return false;
+
+    vertices.reserve( vertices.size() + data.Corners.size() );
+    normals.reserve( normals.size() + data.Corners.size() );
+    textures.reserve( textures.size() + data.Corners.size() );
+    for (const auto& corner : data.Corners) {
+        vertices.emplace_back( data.Vertices[corner.x] );
+        normals.emplace_back( corner.z >= 0 ? data.Normals[corner.z] : glm::vec3( 0.0f ) );
+        textures.emplace_back( corner.y >= 0 ? data.Textures[corner.y] : glm::vec2( 0.0f ) );
     }
+    return true;
+}
 
-    std::vector<glm::vec3> vertex_buffer, normal_buffer;
-    std::vector<glm::vec2> texture_buffer;
-    std::vector<int> vertex_indices, normal_indices, texture_indices;
-    while (!file.eof()) {
-        std::string word;
-        file >> word;
+bool ObjectGL::readTextFile(
+    std::vector<glm::vec3>& vertices,
+    std::vector<glm::vec3>& normals,
+    const std::string& file_path
+)
+{
+    return ObjectReader::readTextFile( vertices, normals, file_path );
+}
 
-        if (word == "v") {
-            glm::vec3 vertex;
-            file >> vertex.x >> vertex.y >> vertex.z;
-            vertex_buffer.emplace_back( vertex );
-        }
-        else if (word == "vt") {
-            glm::vec2 uv;
-            file >> uv.x >> uv.y;
-            texture_buffer.emplace_back( uv );
-        }
-        else if (word == "vn") {
-            glm::vec3 normal;
-            file >> normal.x >> normal.y >> normal.z;
-            normal_buffer.emplace_back( normal );
-        }
-        else if (word == "f") {
-            std::string line;
-            std::getline( file, line );
-
-            const std::regex delimiter( "[ /]" );
-            const std::sregex_token_iterator it( line.begin() + 1, line.end(), delimiter, -1 );
-            const std::vector<std::string> n( it, std::sregex_token_iterator() );
-
-            assert( n.size() == 9 );
-
-            vertex_indices.emplace_back( std::stof( n[0] ) );
-            texture_indices.emplace_back( std::stof( n[1] ) );
-            normal_indices.emplace_back( std::stof( n[2] ) );
-            vertex_indices.emplace_back( std::stof( n[3] ) );
-            texture_indices.emplace_back( std::stof( n[4] ) );
-            normal_indices.emplace_back( std::stof( n[5] ) );
-            vertex_indices.emplace_back( std::stof( n[6] ) );
-            texture_indices.emplace_back( std::stof( n[7] ) );
-            normal_indices.emplace_back( std::stof( n[8] ) );
-        }
-        else std::getline( file, word );
-    }
+bool ObjectGL::readTextFile(
+    std::vector<glm::vec3>& vertices,
+    std::vector<glm::vec3>& normals,
+    std::vector<glm::vec2>& textures,
+    const std::string& file_path
+)
+{
+    return ObjectReader::readTextFile( vertices, normals, textures, file_path );
+}
 
-    for (uint i = 0; i < vertex_indices.size(); ++i) {
-        vertices.emplace_back( vertex_buffer[vertex_indices[i] - 1] );
-        normals.emplace_back( normal_buffer[normal_indices[i] - 1] );
-        textures.emplace_back( texture_buffer[texture_indices[i] - 1] );
-    }
+bool ObjectGL::readObjectFile(
+    std::vector<glm::vec3>& vertices,
+    std::vector<glm::vec3>& normals,
+    std::vector<glm::vec2>& textures,
+    std::vector<GLuint>& indices,
+    const std::string& file_path,
+    int thread_num
+)
+{
+    if (!readObjectFile( vertices, normals, textures, file_path, thread_num )) return false;
+
+    const size_t corner_num = vertices.size();
+    ObjectReader::weldVertices( vertices, normals, textures, indices );
+    ObjectReader::reportWelding( file_path, corner_num, vertices.size() );
     return true;
 }
 
 bool ObjectGL::readTextFile(
     std::vector<glm::vec3>& vertices,
     std::vector<glm::vec3>& normals,
+    std::vector<GLuint>& indices,
     const std::string& file_path
 )
 {
-    std::ifstream file( file_path );
-    if (!file.is_open()) {
-        std::cout << "The object file is not correct.\n";
-        return false;
-    }
-
-    int polygon_num;
-    file >> polygon_num;
-
-    const int vertex_num = polygon_num * 3;
-    vertices.resize( vertex_num );
-    normals.resize( vertex_num );
-    for (int i = 0; i < polygon_num; ++i) {
-        int triangle_vertex_num;
-        file >> triangle_vertex_num;
-        for (int v = 0; v < triangle_vertex_num; ++v) {
-            const int index = i * triangle_vertex_num + v;
-            file >> vertices[index].x >> vertices[index].y >> vertices[index].z;
-            file >> normals[index].x >> normals[index].y >> normals[index].z;
-        }
-    }
-    file.close();
+    if (!readTextFile( vertices, normals, file_path )) return false;
+
+    std::vector<glm::vec2> textures;
+    const size_t corner_num = vertices.size();
+    ObjectReader::weldVertices( vertices, normals, textures, indices );
+    ObjectReader::reportWelding( file_path, corner_num, vertices.size() );
     return true;
 }
 
@@ -711,33 +1070,15 @@ bool ObjectGL::readTextFile(
     std::vector<glm::vec3>& vertices,
     std::vector<glm::vec3>& normals,
     std::vector<glm::vec2>& textures,
+    std::vector<GLuint>& indices,
     const std::string& file_path
 )
 {
-    std::ifstream file( file_path );
-    if (!file.is_open()) {
-        std::cout << "The object file is not correct.\n";
-        return false;
-    }
-
-    int polygon_num;
-    file >> polygon_num;
-
-    const int vertex_num = polygon_num * 3;
-    vertices.resize( vertex_num );
-    normals.resize( vertex_num );
-    textures.resize( vertex_num );
-    for (int i = 0; i < polygon_num; ++i) {
-        int triangle_vertex_num;
-        file >> triangle_vertex_num;
-        for (int v = 0; v < triangle_vertex_num; ++v) {
-            const int index = i * triangle_vertex_num + v;
-            file >> vertices[index].x >> vertices[index].y >> vertices[index].z;
-            file >> normals[index].x >> normals[index].y >> normals[index].z;
-            file >> textures[index].x >> textures[index].y;
-        }
-    }
-    file.close();
+    if (!readTextFile( vertices, normals, textures, file_path )) return false;
+
+    const size_t corner_num = vertices.size();
+    ObjectReader::weldVertices( vertices, normals, textures, indices );
+    ObjectReader::reportWelding( file_path, corner_num, vertices.size() );
     return true;
 }
 
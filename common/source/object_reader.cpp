@@ -0,0 +1,543 @@
+#include "object_reader.h"
+#include "mapped_file.h"
+#include "thread_pool.h"
+
+bool ObjectReader::parseFloat(const char*& ptr, const char* end, float& value)
+{
+    ptr = skipSpaces( ptr, end );
+    if (ptr < end && *ptr == '+') ++ptr;
+
+    const auto [next, error] = std::from_chars( ptr, end, value );
+    if (error != std::errc()) return false;
+    ptr = next;
+    return true;
+}
+
+bool ObjectReader::parseIndex(const char*& ptr, const char* end, int count, int& index, bool& relative)
+{
+    int value = 0;
+    const auto [next, error] = std::from_chars( ptr, end, value );
+    if (error != std::errc() || value == 0) return false;
+
+    // A negative index refers to the elements defined so far, counting backwards from the last one.
+    relative = value < 0;
+    index = relative ? count + value : value - 1;
+    ptr = next;
+    return true;
+}
+
+bool ObjectReader::parseCorner(
+    const char*& ptr,
+    const char* end,
+    const ObjectData& data,
+    glm::ivec3& corner,
+    glm::bvec3& relative
+)
+{
+    corner = glm::ivec3( -1 );
+    relative = glm::bvec3( false );
+    if (!parseIndex( ptr, end, static_cast<int>(data.Vertices.size()), corner.x, relative.x )) return false;
+    if (ptr == end || *ptr != '/') return true;
+
+    ++ptr;
+    if (ptr < end && *ptr != '/') {
+        if (!parseIndex( ptr, end, static_cast<int>(data.Textures.size()), corner.y, relative.y )) return false;
+    }
+    if (ptr == end || *ptr != '/') return true;
+
+    ++ptr;
+    return parseIndex( ptr, end, static_cast<int>(data.Normals.size()), corner.z, relative.z );
+}
+
+void ObjectReader::addCorner(ChunkData& chunk, const glm::ivec3& corner, const glm::bvec3& relative)
+{
+    const auto index = static_cast<uint32_t>(chunk.Data.Corners.size() * 3);
+    for (int c = 0; c < 3; ++c) {
+        if (relative[c]) chunk.RelativeIndices.emplace_back( index + c );
+    }
+    chunk.Data.Corners.emplace_back( corner );
+}
+
+bool ObjectReader::parseFace(const char* ptr, const char* end, ChunkData& chunk)
+{
+    // Polygons are triangulated as a fan around the first corner, so no corner list has to be kept.
+    int corner_num = 0;
+    glm::ivec3 first, previous, current;
+    glm::bvec3 first_relative, previous_relative, current_relative;
+    while (true) {
+        ptr = skipSpaces( ptr, end );
+        if (ptr == end || *ptr == '#') break;
+        if (!parseCorner( ptr, end, chunk.Data, current, current_relative )) return false;
+
+        if (corner_num == 0) {
+            first = current;
+            first_relative = current_relative;
+        }
+        else if (corner_num >= 2) {
+            addCorner( chunk, first, first_relative );
+            addCorner( chunk, previous, previous_relative );
+            addCorner( chunk, current, current_relative );
+        }
+        previous = current;
+        previous_relative = current_relative;
+        corner_num++;
+    }
+    return corner_num >= 3;
+}
+
+void ObjectReader::parseChunk(ChunkData& chunk, const char* begin, const char* end)
+{
+    ObjectData& data = chunk.Data;
+    const char* ptr = begin;
+    while (ptr < end) {
+        ptr = skipSpaces( ptr, end );
+        const char* line_begin = ptr;
+        const auto* line_end = static_cast<const char*>(std::memchr( ptr, '\n', end - ptr ));
+        if (line_end == nullptr) line_end = end;
+
+        bool parsed = true;
+        if (isKeyword( ptr, line_end, "v" )) {
+            glm::vec3 vertex;
+            ptr += 1;
+            parsed = parseFloat( ptr, line_end, vertex.x ) &&
+                parseFloat( ptr, line_end, vertex.y ) &&
+                parseFloat( ptr, line_end, vertex.z );
+            data.Vertices.emplace_back( vertex );
+        }
+        else if (isKeyword( ptr, line_end, "vt" )) {
+            glm::vec2 uv;
+            ptr += 2;
+            parsed = parseFloat( ptr, line_end, uv.x ) && parseFloat( ptr, line_end, uv.y );
+            data.Textures.emplace_back( uv );
+        }
+        else if (isKeyword( ptr, line_end, "vn" )) {
+            glm::vec3 normal;
+            ptr += 2;
+            parsed = parseFloat( ptr, line_end, normal.x ) &&
+                parseFloat( ptr, line_end, normal.y ) &&
+                parseFloat( ptr, line_end, normal.z );
+            data.Normals.emplace_back( normal );
+        }
+        else if (isKeyword( ptr, line_end, "f" )) parsed = parseFace( ptr + 1, line_end, chunk );
+
+        if (!parsed) {
+            chunk.ErrorLine = line_begin;
+            return;
+        }
+        ptr = line_end == end ? end : line_end + 1;
+    }
+}
+
+std::vector<const char*> ObjectReader::splitIntoChunks(const char* begin, const char* end, int thread_num)
+{
+    const auto size = static_cast<size_t>(end - begin);
+    // A single thread parses the whole file by itself, so that it never waits on the thread pool.
+    const size_t chunk_num = thread_num > 1 ? std::clamp<size_t>( size / MinChunkSize, 1, thread_num * 4 ) : 1;
+    std::vector<const char*> bounds = { begin };
+    for (size_t i = 1; i < chunk_num; ++i) {
+        const char* ptr = begin + size * i / chunk_num;
+        if (ptr <= bounds.back()) continue;
+
+        const auto* line_end = static_cast<const char*>(std::memchr( ptr, '\n', end - ptr ));
+        if (line_end == nullptr || line_end + 1 >= end) break;
+        bounds.emplace_back( line_end + 1 );
+    }
+    bounds.emplace_back( end );
+    return bounds;
+}
+
+void ObjectReader::mergeChunks(ObjectData& data, std::vector<ChunkData>& chunks)
+{
+    // The prefix sums of the element counts are where each chunk lands, and also what its relative indices add.
+    std::vector<glm::ivec3> bases( chunks.size() );
+    std::vector<size_t> corner_offsets( chunks.size() );
+    glm::ivec3 counts(
+        static_cast<int>(data.Vertices.size()),
+        static_cast<int>(data.Textures.size()),
+        static_cast<int>(data.Normals.size())
+    );
+    size_t corner_num = data.Corners.size();
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        bases[i] = counts;
+        corner_offsets[i] = corner_num;
+        counts += glm::ivec3(
+            static_cast<int>(chunks[i].Data.Vertices.size()),
+            static_cast<int>(chunks[i].Data.Textures.size()),
+            static_cast<int>(chunks[i].Data.Normals.size())
+        );
+        corner_num += chunks[i].Data.Corners.size();
+    }
+    data.Vertices.resize( counts.x );
+    data.Textures.resize( counts.y );
+    data.Normals.resize( counts.z );
+    data.Corners.resize( corner_num );
+
+    const auto mergeChunk = [&data, &chunks, &bases, &corner_offsets](size_t i)
+    {
+        ChunkData& chunk = chunks[i];
+        const glm::ivec3& base = bases[i];
+        for (const auto& index : chunk.RelativeIndices) {
+            const auto component = static_cast<int>(index % 3);
+            chunk.Data.Corners[index / 3][component] += base[component];
+        }
+        std::copy( chunk.Data.Vertices.begin(), chunk.Data.Vertices.end(), data.Vertices.begin() + base.x );
+        std::copy( chunk.Data.Textures.begin(), chunk.Data.Textures.end(), data.Textures.begin() + base.y );
+        std::copy( chunk.Data.Normals.begin(), chunk.Data.Normals.end(), data.Normals.begin() + base.z );
+        std::copy(
+            chunk.Data.Corners.begin(), chunk.Data.Corners.end(),
+            data.Corners.begin() + static_cast<std::ptrdiff_t>(corner_offsets[i])
+        );
+    };
+
+    // A single chunk is merged in place, so that a single-threaded parse never waits on the thread pool either.
+    if (chunks.size() == 1) {
+        mergeChunk( 0 );
+        return;
+    }
+
+    std::vector<std::future<void>> tasks;
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        tasks.emplace_back( ThreadPool::getInstance().submit( [&mergeChunk, i]() { mergeChunk( i ); } ) );
+    }
+    for (auto& task : tasks) task.get();
+}
+
+bool ObjectReader::hasValidIndices(const ObjectData& data)
+{
+    const glm::ivec3 counts(
+        static_cast<int>(data.Vertices.size()),
+        static_cast<int>(data.Textures.size()),
+        static_cast<int>(data.Normals.size())
+    );
+    return std::all_of(
+        data.Corners.begin(), data.Corners.end(), [&counts](const glm::ivec3& corner) {
+            return corner.x >= 0 && corner.x < counts.x && corner.y < counts.y && corner.z < counts.z &&
+                corner.y >= -1 && corner.z >= -1;
+        }
+    );
+}
+
+bool ObjectReader::parseObject(ObjectData& data, const char* begin, const char* end, int thread_num)
+{
+    const std::vector<const char*> bounds = splitIntoChunks( begin, end, thread_num );
+    std::vector<ChunkData> chunks( bounds.size() - 1 );
+    if (chunks.size() == 1) parseChunk( chunks[0], begin, end );
+    else {
+        std::vector<std::future<void>> tasks;
+        for (size_t i = 0; i < chunks.size(); ++i) {
+            tasks.emplace_back(
+                ThreadPool::getInstance().submit(
+                    [&chunk = chunks[i], chunk_begin = bounds[i], chunk_end = bounds[i + 1]]() {
+                        parseChunk( chunk, chunk_begin, chunk_end );
+                    }
+                )
+            );
+        }
+        for (auto& task : tasks) task.get();
+    }
+
+    for (const auto& chunk : chunks) {
+        if (chunk.ErrorLine != nullptr) {
+            const auto line_number = std::count( begin, chunk.ErrorLine, '\n' ) + 1;
+            std::cout << "The object file is not correct at line " << line_number << ".\n";
+            return false;
+        }
+    }
+
+    const bool data_empty =
+        data.Vertices.empty() && data.Textures.empty() && data.Normals.empty() && data.Corners.empty();
+    if (chunks.size() == 1 && data_empty) data = std::move( chunks[0].Data );
+    else mergeChunks( data, chunks );
+
+    if (!hasValidIndices( data )) {
+        std::cout << "The object file has out-of-range indices.\n";
+        return false;
+    }
+    return true;
+}
+
+bool ObjectReader::readObjectFile(ObjectData& data, const std::string& file_path, int thread_num)
+{
+    MappedFile file;
+    if (!file.open( file_path )) {
+        std::cout << "The object file is not correct.\n";
+        return false;
+    }
+    return parseObject( data, file.getData(), file.getData() + file.getSize(), thread_num );
+}
+
+bool ObjectReader::textHasTextures(const char* begin, const char* end)
+{
+    const char* ptr = begin;
+    for (int i = 0; i < 2 && ptr < end; ++i) {
+        const auto* line_end = static_cast<const char*>(std::memchr( ptr, '\n', end - ptr ));
+        ptr = line_end == nullptr ? end : line_end + 1;
+    }
+    const auto* line_end = static_cast<const char*>(std::memchr( ptr, '\n', end - ptr ));
+    if (line_end == nullptr) line_end = end;
+
+    int value_num = 0;
+    float value;
+    while (parseFloat( ptr, line_end, value )) value_num++;
+    return value_num >= 8;
+}
+
+bool ObjectReader::textFileHasTextures(const std::string& file_path)
+{
+    MappedFile file;
+    return file.open( file_path ) && textHasTextures( file.getData(), file.getData() + file.getSize() );
+}
+
+bool ObjectReader::parseText(
+    std::vector<glm::vec3>& vertices,
+    std::vector<glm::vec3>& normals,
+    std::vector<glm::vec2>& textures,
+    bool textures_exist,
+    const char* begin,
+    const char* end
+)
+{
+    const char* ptr = begin;
+    const auto reportError = [begin, &ptr]() {
+        std::cout << "The object file is not correct at line " << std::count( begin, ptr, '\n' ) + 1 << ".\n";
+        return false;
+    };
+
+    int polygon_num = 0;
+    if (!parseValue( ptr, end, polygon_num ) || polygon_num < 0) return reportError();
+
+    // The polygons are triangles in the usual case, so these are exact.
+    const auto corner_num = static_cast<size_t>(polygon_num) * 3;
+    vertices.reserve( vertices.size() + corner_num );
+    normals.reserve( normals.size() + corner_num );
+    if (textures_exist) textures.reserve( textures.size() + corner_num );
+
+    const int values_per_vertex = textures_exist ? 8 : 6;
+    const auto addVertex = [&](const float* values) {
+        vertices.emplace_back( values[0], values[1], values[2] );
+        normals.emplace_back( values[3], values[4], values[5] );
+        if (textures_exist) textures.emplace_back( values[6], values[7] );
+    };
+
+    std::vector<float> polygon;
+    for (int i = 0; i < polygon_num; ++i) {
+        int vertex_num = 0;
+        if (!parseValue( ptr, end, vertex_num ) || vertex_num < 3) return reportError();
+
+        polygon.resize( static_cast<size_t>(vertex_num) * values_per_vertex );
+        for (auto& value : polygon) {
+            if (!parseValue( ptr, end, value )) return reportError();
+        }
+        for (int v = 2; v < vertex_num; ++v) {
+            addVertex( polygon.data() );
+            addVertex( polygon.data() + (v - 1) * values_per_vertex );
+            addVertex( polygon.data() + v * values_per_vertex );
+        }
+    }
+    return true;
+}
+
+bool ObjectReader::readTextFile(
+    std::vector<glm::vec3>& vertices,
+    std::vector<glm::vec3>& normals,
+    const std::string& file_path
+)
+{
+    MappedFile file;
+    if (!file.open( file_path )) {
+        std::cout << "The object file is not correct.\n";
+        return false;
+    }
+
+    std::vector<glm::vec2> textures;
+    return parseText( vertices, normals, textures, false, file.getData(), file.getData() + file.getSize() );
+}
+
+bool ObjectReader::readTextFile(
+    std::vector<glm::vec3>& vertices,
+    std::vector<glm::vec3>& normals,
+    std::vector<glm::vec2>& textures,
+    const std::string& file_path
+)
+{
+    MappedFile file;
+    if (!file.open( file_path )) {
+        std::cout << "The object file is not correct.\n";
+        return false;
+    }
+    return parseText( vertices, normals, textures, true, file.getData(), file.getData() + file.getSize() );
+}
+
+bool ObjectReader::readMeshFile(
+    std::vector<glm::vec3>& vertices,
+    std::vector<glm::vec3>& normals,
+    std::vector<glm::vec2>& textures,
+    std::vector<GLuint>& indices,
+    const std::string& file_path,
+    int thread_num
+)
+{
+    if (std::filesystem::path( file_path ).extension() == ".txt") {
+        MappedFile file;
+        if (!file.open( file_path )) {
+            std::cout << "The object file is not correct.\n";
+            return false;
+        }
+
+        const char* begin = file.getData();
+        const char* end = begin + file.getSize();
+        if (!parseText( vertices, normals, textures, textHasTextures( begin, end ), begin, end )) return false;
+    }
+    else {
+        ObjectData data;
+        if (!readObjectFile( data, file_path, thread_num )) return false;
+
+        const bool normals_exist = !data.Normals.empty();
+        const bool textures_exist = !data.Textures.empty();
+        for (const auto& corner : data.Corners) {
+            vertices.emplace_back( data.Vertices[corner.x] );
+            if (normals_exist) normals.emplace_back( corner.z >= 0 ? data.Normals[corner.z] : glm::vec3( 0.0f ) );
+            if (textures_exist) textures.emplace_back( corner.y >= 0 ? data.Textures[corner.y] : glm::vec2( 0.0f ) );
+        }
+    }
+    const size_t corner_num = vertices.size();
+    weldVertices( vertices, normals, textures, indices );
+    reportWelding( file_path, corner_num, vertices.size() );
+    return true;
+}
+
+bool ObjectReader::readMorphTargets(
+    std::vector<glm::vec3>& vertices,
+    std::vector<glm::vec3>& normals,
+    std::vector<glm::vec2>& textures,
+    std::vector<GLuint>& indices,
+    std::vector<glm::vec4>& deltas,
+    const std::vector<std::string>& frame_paths
+)
+{
+    if (frame_paths.empty()) return false;
+
+    const bool textures_exist = textFileHasTextures( frame_paths[0] );
+    std::vector<ObjectData> frames( frame_paths.size() );
+    for (size_t f = 0; f < frames.size(); ++f) {
+        MappedFile file;
+        if (!file.open( frame_paths[f] )) {
+            std::cout << "The object file is not correct.\n";
+            return false;
+        }
+
+        const char* begin = file.getData();
+        const char* end = begin + file.getSize();
+        if (!parseText( frames[f].Vertices, frames[f].Normals, frames[f].Textures, textures_exist, begin, end )) {
+            return false;
+        }
+        if (frames[f].Vertices.size() != frames[0].Vertices.size()) {
+            std::cout << "The frame " << frame_paths[f] << " does not have the polygons of the first frame.\n";
+            return false;
+        }
+    }
+
+    const auto agreesInEveryFrame = [&frames](size_t a, size_t b) {
+        return std::all_of(
+            frames.begin() + 1, frames.end(),
+            [a, b](const ObjectData& frame)
+            {
+                return frame.Vertices[a] == frame.Vertices[b] && frame.Normals[a] == frame.Normals[b];
+            }
+        );
+    };
+
+    // The first frame decides the candidates, and the other frames split them further if they do not agree.
+    const ObjectData& base = frames[0];
+    const size_t corner_num = base.Vertices.size();
+    std::unordered_map<VertexKey, std::vector<GLuint>, VertexKeyHash> unique_vertices;
+    std::vector<size_t> first_corners;
+    unique_vertices.reserve( corner_num );
+    indices.clear();
+    indices.reserve( corner_num );
+    for (size_t i = 0; i < corner_num; ++i) {
+        const VertexKey key{
+            base.Vertices[i],
+            base.Normals[i],
+            textures_exist ? base.Textures[i] : glm::vec2( 0.0f )
+        };
+        auto& candidates = unique_vertices[key];
+        const auto it = std::find_if(
+            candidates.begin(), candidates.end(),
+            [&](GLuint vertex) { return agreesInEveryFrame( first_corners[vertex], i ); }
+        );
+        if (it != candidates.end()) indices.emplace_back( *it );
+        else {
+            const auto vertex = static_cast<GLuint>(first_corners.size());
+            candidates.emplace_back( vertex );
+            indices.emplace_back( vertex );
+            first_corners.emplace_back( i );
+        }
+    }
+
+    vertices.clear();
+    normals.clear();
+    textures.clear();
+    for (const auto& corner : first_corners) {
+        vertices.emplace_back( base.Vertices[corner] );
+        normals.emplace_back( base.Normals[corner] );
+        if (textures_exist) textures.emplace_back( base.Textures[corner] );
+    }
+
+    deltas.clear();
+    deltas.reserve( (frames.size() - 1) * first_corners.size() * 2 );
+    for (size_t f = 1; f < frames.size(); ++f) {
+        for (size_t v = 0; v < first_corners.size(); ++v) {
+            deltas.emplace_back( frames[f].Vertices[first_corners[v]] - vertices[v], 0.0f );
+            deltas.emplace_back( frames[f].Normals[first_corners[v]] - normals[v], 0.0f );
+        }
+    }
+    reportWelding( frame_paths[0], corner_num, vertices.size() );
+    return true;
+}
+
+void ObjectReader::reportWelding(const std::string& file_path, size_t corner_num, size_t vertex_num)
+{
+    // The report is put together first, since meshes can be loaded on several threads at once.
+    std::ostringstream report;
+    report << ">> " << std::filesystem::path( file_path ).filename().string() << ": " << corner_num
+        << " vertices welded into " << vertex_num << " unique vertices (x" << std::fixed << std::setprecision( 2 )
+        << static_cast<double>(corner_num) / static_cast<double>(std::max<size_t>( vertex_num, 1 )) << ")\n";
+    std::cout << report.str();
+}
+
+void ObjectReader::weldVertices(
+    std::vector<glm::vec3>& vertices,
+    std::vector<glm::vec3>& normals,
+    std::vector<glm::vec2>& textures,
+    std::vector<GLuint>& indices
+)
+{
+    const bool normals_exist = !normals.empty();
+    const bool textures_exist = !textures.empty();
+    std::unordered_map<VertexKey, GLuint, VertexKeyHash> unique_vertices;
+    unique_vertices.reserve( vertices.size() );
+    indices.clear();
+    indices.reserve( vertices.size() );
+
+    // The unique vertices are compacted in place since a new vertex never lands after the one being read.
+    GLuint unique_num = 0;
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        const VertexKey key{
+            vertices[i],
+            normals_exist ? normals[i] : glm::vec3( 0.0f ),
+            textures_exist ? textures[i] : glm::vec2( 0.0f )
+        };
+        const auto [it, inserted] = unique_vertices.try_emplace( key, unique_num );
+        if (inserted) {
+            vertices[unique_num] = vertices[i];
+            if (normals_exist) normals[unique_num] = normals[i];
+            if (textures_exist) textures[unique_num] = textures[i];
+            unique_num++;
+        }
+        indices.emplace_back( it->second );
+    }
+    vertices.resize( unique_num );
+    if (normals_exist) normals.resize( unique_num );
+    if (textures_exist) textures.resize( unique_num );
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include "program_cache.h"
+
+uint64_t ProgramCache::getKey(const std::vector<Stage>& stages)
+{
+    // The strings are hashed with their terminators, so that the boundaries between them count as well.
+    const auto* renderer = reinterpret_cast<const char*>(glGetString( GL_RENDERER ));
+    const auto* version = reinterpret_cast<const char*>(glGetString( GL_VERSION ));
+    uint64_t key = MappedFile::getHash( &Version, sizeof( Version ) );
+    if (renderer != nullptr) key = MappedFile::getHash( renderer, std::strlen( renderer ) + 1, key );
+    if (version != nullptr) key = MappedFile::getHash( version, std::strlen( version ) + 1, key );
+    for (const auto& stage : stages) {
+        key = MappedFile::getHash( &stage.Type, sizeof( stage.Type ), key );
+        key = MappedFile::getHash( stage.Source.c_str(), stage.Source.size() + 1, key );
+    }
+    return key;
+}
+
+bool ProgramCache::isSupported()
+{
+    GLint format_num = 0;
+    glGetIntegerv( GL_NUM_PROGRAM_BINARY_FORMATS, &format_num );
+    return format_num > 0;
+}
+
+bool ProgramCache::isFormatSupported(GLenum format)
+{
+    GLint format_num = 0;
+    glGetIntegerv( GL_NUM_PROGRAM_BINARY_FORMATS, &format_num );
+    if (format_num <= 0) return false;
+
+    std::vector<GLint> formats( format_num );
+    glGetIntegerv( GL_PROGRAM_BINARY_FORMATS, formats.data() );
+    return std::ranges::find( formats, static_cast<GLint>(format) ) != formats.end();
+}
+
+bool ProgramCache::load(GLuint program, uint64_t key)
+{
+    MappedFile file;
+    if (!file.open( getCachePath( key ) ) || file.getSize() < sizeof( Header )) return false;
+
+    const auto* header = reinterpret_cast<const Header*>(file.getData());
+    if (header->Magic != Magic || header->Version != Version || header->Key != key) return false;
+    if (header->BinarySize == 0 || sizeof( Header ) + header->BinarySize != file.getSize()) return false;
+
+    // The driver does not have to check the binary, so a broken one is caught here before it reaches the driver.
+    const char* binary = file.getData() + sizeof( Header );
+    if (MappedFile::getHash( binary, header->BinarySize ) != header->BinaryHash) return false;
+    if (!isFormatSupported( header->BinaryFormat )) return false;
+
+    glProgramBinary( program, header->BinaryFormat, binary, static_cast<GLsizei>(header->BinarySize) );
+    GLint linked = GL_FALSE;
+    glGetProgramiv( program, GL_LINK_STATUS, &linked );
+    return linked == GL_TRUE;
+}
+
+void ProgramCache::save(GLuint program, uint64_t key)
+{
+    GLint binary_size = 0;
+    glGetProgramiv( program, GL_PROGRAM_BINARY_LENGTH, &binary_size );
+    if (binary_size <= 0) return;
+
+    std::vector<char> blob( sizeof( Header ) + binary_size );
+    GLenum format = 0;
+    GLsizei length = 0;
+    glGetProgramBinary( program, binary_size, &length, &format, blob.data() + sizeof( Header ) );
+    if (length <= 0) return;
+
+    blob.resize( sizeof( Header ) + length );
+    Header header{};
+    header.Magic = Magic;
+    header.Version = Version;
+    header.BinaryFormat = format;
+    header.Key = key;
+    header.BinarySize = static_cast<uint64_t>(length);
+    header.BinaryHash = MappedFile::getHash( blob.data() + sizeof( Header ), header.BinarySize );
+    std::memcpy( blob.data(), &header, sizeof( Header ) );
+
+    std::error_code error;
+    std::filesystem::create_directories( getCacheDirectory(), error );
+    if (!MappedFile::writeAtomically( getCachePath( key ), blob.data(), blob.size() )) {
+        std::cout << ">> Could not write the program cache " << getCachePath( key ) << "\n";
+    }
+}
\ No newline at end of file
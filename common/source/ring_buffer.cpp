@@ -0,0 +1,89 @@
+#include "ring_buffer.h"
+
+RingBufferGL::RingBufferGL(GLsizeiptr region_size, int region_num, GLbitfield access) :
+    RegionSize( (region_size + RegionAlignment - 1) / RegionAlignment * RegionAlignment ),
+    Fences( std::max( region_num, 1 ), nullptr )
+{
+    const GLbitfield flags = access | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glCreateBuffers( 1, &Buffer );
+    glNamedBufferStorage( Buffer, RegionSize * static_cast<GLsizeiptr>(Fences.size()), nullptr, flags );
+    MappedData = static_cast<uint8_t*>(
+        glMapNamedBufferRange( Buffer, 0, RegionSize * static_cast<GLsizeiptr>(Fences.size()), flags )
+    );
+}
+
+RingBufferGL::~RingBufferGL()
+{
+    for (const auto& fence : Fences) {
+        if (fence != nullptr) glDeleteSync( fence );
+    }
+    if (Buffer != 0) {
+        glUnmapNamedBuffer( Buffer );
+        glDeleteBuffers( 1, &Buffer );
+    }
+}
+
+void RingBufferGL::fenceCurrentRegion()
+{
+    if (CurrentRegion < 0) return;
+
+    if (Fences[CurrentRegion] != nullptr) glDeleteSync( Fences[CurrentRegion] );
+    Fences[CurrentRegion] = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+}
+
+void RingBufferGL::waitForFence(int region)
+{
+    GLsync& fence = Fences[region];
+    if (fence == nullptr) return;
+
+    // The first check does not wait, so that only the real stalls are counted.
+    GLenum result = glClientWaitSync( fence, 0, 0 );
+    if (result == GL_TIMEOUT_EXPIRED) {
+        const auto start = std::chrono::steady_clock::now();
+        constexpr GLuint64 timeout_in_ns = 1'000'000;
+        do {
+            result = glClientWaitSync( fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout_in_ns );
+        } while (result == GL_TIMEOUT_EXPIRED);
+        FenceWaitNum++;
+        FenceWaitTime += std::chrono::duration<double, std::milli>( std::chrono::steady_clock::now() - start ).count();
+    }
+    glDeleteSync( fence );
+    fence = nullptr;
+}
+
+uint8_t* RingBufferGL::nextRegion()
+{
+    fenceCurrentRegion();
+    CurrentRegion = (CurrentRegion + 1) % static_cast<int>(Fences.size());
+    waitForFence( CurrentRegion );
+
+    LastRequestTime = std::chrono::steady_clock::now();
+    if (RegionRequestNum == 0) FirstRequestTime = LastRequestTime;
+    RegionRequestNum++;
+    return MappedData + getRegionOffset();
+}
+
+void RingBufferGL::waitForCurrentRegion()
+{
+    if (CurrentRegion < 0) return;
+
+    fenceCurrentRegion();
+    waitForFence( CurrentRegion );
+}
+
+void RingBufferGL::printStatistics(const std::string& name) const
+{
+    std::ostringstream report;
+    report << ">> " << name << ": waited on " << FenceWaitNum << " of " << RegionRequestNum
+        << " region fences for " << std::fixed << std::setprecision( 2 ) << FenceWaitTime << " ms in total\n";
+    if (TransferredBytes > 0) {
+        // The streaming rate is bound by the frame rate, while the issue rate tells how little the uploads block.
+        constexpr double megabyte = 1024.0 * 1024.0;
+        const double megabytes = static_cast<double>(TransferredBytes) / megabyte;
+        const double seconds = std::chrono::duration<double>( LastRequestTime - FirstRequestTime ).count();
+        report << ">> " << name << ": " << megabytes << " MB streamed at "
+            << (seconds > 0.0 ? megabytes / seconds : 0.0) << " MB/s, issued at "
+            << (TransferIssueTime > 0.0 ? megabytes * 1000.0 / TransferIssueTime : 0.0) << " MB/s\n";
+    }
+    std::cout << report.str();
+}
\ No newline at end of file
@@ -2,6 +2,15 @@
 
 ShaderGL::~ShaderGL()
 {
+    std::erase_if(
+        PendingPrograms,
+        [this](const PendingProgram& pending)
+        {
+            if (pending.Shader != this) return false;
+            for (const auto& shader : pending.Shaders) glDeleteShader( shader );
+            return true;
+        }
+    );
     if (ShaderProgram != 0)
         glDeleteProgram( ShaderProgram );
 }
@@ -22,6 +31,60 @@ void ShaderGL::readShaderFile(std::string& shader_contents, const char* shader_p
     file.close();
 }
 
+const std::string& ShaderGL::getShaderFile(const std::string& shader_path)
+{
+    const auto it = FileContents.find( shader_path );
+    if (it != FileContents.end()) return it->second;
+
+    std::string& contents = FileContents[shader_path];
+    readShaderFile( contents, shader_path.c_str() );
+    return contents;
+}
+
+void ShaderGL::addDefine(const std::string& name, const std::string& value)
+{
+    const auto it = std::ranges::find( Defines, name, &std::pair<std::string, std::string>::first );
+    if (it != Defines.end()) it->second = value;
+    else Defines.emplace_back( name, value );
+}
+
+void ShaderGL::preprocess(ProgramCache::Stage& stage, const std::filesystem::path& shader_path) const
+{
+    const std::string path = shader_path.lexically_normal().string();
+    if (std::ranges::find( stage.Files, path ) != stage.Files.end()) return;
+
+    const auto file_index = std::to_string( stage.Files.size() );
+    const bool is_main_file = stage.Files.empty();
+    stage.Files.emplace_back( path );
+    if (!is_main_file) stage.Source += "#line 1 " + file_index + "\n";
+
+    std::istringstream file( getShaderFile( path ) );
+    std::string line;
+    int line_number = 0;
+    while (std::getline( file, line )) {
+        line_number++;
+        const size_t start = line.find_first_not_of( " \t" );
+        const std::string_view directive =
+            start == std::string::npos ? std::string_view{} : std::string_view( line ).substr( start );
+        const size_t open = line.find( '"' );
+        const size_t close = open == std::string::npos ? std::string::npos : line.find( '"', open + 1 );
+        if (directive.starts_with( "#include" ) && close != std::string::npos) {
+            const std::string name = line.substr( open + 1, close - open - 1 );
+            std::filesystem::path include_path = shader_path.parent_path() / name;
+            if (!std::filesystem::exists( include_path ))
+                include_path = std::filesystem::path( CMAKE_SOURCE_DIR ) / "common" / "shaders" / name;
+            preprocess( stage, include_path );
+            stage.Source += "#line " + std::to_string( line_number + 1 ) + " " + file_index + "\n";
+        }
+        else if (directive.starts_with( "#version" ) && is_main_file && !Defines.empty()) {
+            stage.Source += line + "\n";
+            for (const auto& [name, value] : Defines) stage.Source += "#define " + name + " " + value + "\n";
+            stage.Source += "#line " + std::to_string( line_number + 1 ) + " " + file_index + "\n";
+        }
+        else stage.Source += line + "\n";
+    }
+}
+
 std::string ShaderGL::getShaderTypeString(GLenum shader_type)
 {
     switch (shader_type) {
@@ -49,29 +112,160 @@ bool ShaderGL::checkCompileError(GLenum shader_type, const GLuint& shader)
         glGetShaderInfoLog( shader, max_length, &max_length, &error_log[0] );
         for (const auto& c : error_log) std::cerr << c;
         std::cerr << "\n";
-        glDeleteShader( shader );
     }
     return compiled == GL_TRUE;
 }
 
-GLuint ShaderGL::getCompiledShader(GLenum shader_type, const char* shader_path)
+bool ShaderGL::checkLinkError(const GLuint& program)
 {
-    if (shader_path == nullptr) return 0;
+    GLint linked = 0;
+    glGetProgramiv( program, GL_LINK_STATUS, &linked );
+
+    if (linked == GL_FALSE) {
+        GLint max_length = 0;
+        glGetProgramiv( program, GL_INFO_LOG_LENGTH, &max_length );
 
-    std::string shader_contents;
-    readShaderFile( shader_contents, shader_path );
+        std::cerr << " ======= Program log ======= \n";
+        std::vector<GLchar> error_log( std::max( max_length, 1 ) );
+        glGetProgramInfoLog( program, max_length, &max_length, &error_log[0] );
+        for (const auto& c : error_log) std::cerr << c;
+        std::cerr << "\n";
+    }
+    return linked == GL_TRUE;
+}
 
+GLuint ShaderGL::getCompiledShader(GLenum shader_type, const std::string& shader_source)
+{
+    // The status is not asked here, which would make a driver compiling in parallel finish the shader first.
     const GLuint shader = glCreateShader( shader_type );
-    const char* shader_source = shader_contents.c_str();
-    glShaderSource( shader, 1, &shader_source, nullptr );
+    const char* source = shader_source.c_str();
+    glShaderSource( shader, 1, &source, nullptr );
     glCompileShader( shader );
-    if (!checkCompileError( shader_type, shader )) {
-        std::cerr << "Could not compile shader\n";
-        return 0;
-    }
     return shader;
 }
 
+void ShaderGL::addStage(std::vector<ProgramCache::Stage>& stages, GLenum shader_type, const char* shader_path) const
+{
+    if (shader_path == nullptr) return;
+
+    ProgramCache::Stage& stage = stages.emplace_back();
+    stage.Type = shader_type;
+    preprocess( stage, shader_path );
+}
+
+bool ShaderGL::isParallelCompileSupported()
+{
+    static const bool supported =
+        glfwExtensionSupported( "GL_KHR_parallel_shader_compile" ) == GLFW_TRUE ||
+        glfwExtensionSupported( "GL_ARB_parallel_shader_compile" ) == GLFW_TRUE;
+    return supported;
+}
+
+void ShaderGL::enableParallelCompile()
+{
+    static const bool enabled = []()
+    {
+        if (!isParallelCompileSupported()) return false;
+
+        using MaxShaderCompilerThreadsProc = void (APIENTRY *)(GLuint);
+        auto max_shader_compiler_threads = reinterpret_cast<MaxShaderCompilerThreadsProc>(
+            glfwGetProcAddress( "glMaxShaderCompilerThreadsKHR" )
+        );
+        if (max_shader_compiler_threads == nullptr) {
+            max_shader_compiler_threads = reinterpret_cast<MaxShaderCompilerThreadsProc>(
+                glfwGetProcAddress( "glMaxShaderCompilerThreadsARB" )
+            );
+        }
+
+        // The driver picks its own number of threads, which some drivers only start with this call.
+        if (max_shader_compiler_threads != nullptr) max_shader_compiler_threads( 0xFFFFFFFF );
+        return true;
+    }();
+    std::ignore = enabled;
+}
+
+void ShaderGL::linkProgram(const std::vector<ProgramCache::Stage>& stages)
+{
+    const auto start = std::chrono::steady_clock::now();
+    if (Statistics.ProgramNum == 0) Statistics.FirstSubmitTime = start;
+    Statistics.ProgramNum++;
+
+    const bool cache_supported = ProgramCache::isSupported();
+    const uint64_t key = ProgramCache::getKey( stages );
+    ShaderProgram = glCreateProgram();
+    if (cache_supported && ProgramCache::load( ShaderProgram, key )) {
+        Statistics.CachedProgramNum++;
+        Statistics.LastReadyTime = std::chrono::steady_clock::now();
+    }
+    else {
+        // A program that refused its binary is not reused, so that nothing of the failed attempt stays with it.
+        glDeleteProgram( ShaderProgram );
+        ShaderProgram = glCreateProgram();
+
+        enableParallelCompile();
+        PendingProgram& pending = PendingPrograms.emplace_back();
+        pending.Shader = this;
+        pending.Key = key;
+        pending.CacheBinary = cache_supported;
+        for (const auto& stage : stages) {
+            const GLuint shader = getCompiledShader( stage.Type, stage.Source );
+            glAttachShader( ShaderProgram, shader );
+            pending.ShaderTypes.emplace_back( stage.Type );
+            pending.Shaders.emplace_back( shader );
+            pending.StageFiles.emplace_back( stage.Files );
+        }
+        if (cache_supported) glProgramParameteri( ShaderProgram, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE );
+        glLinkProgram( ShaderProgram );
+    }
+
+    const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    Statistics.SubmitMilliseconds += elapsed.count();
+}
+
+void ShaderGL::finishProgram(const PendingProgram& pending)
+{
+    const GLuint program = pending.Shader->ShaderProgram;
+    if (checkLinkError( program )) {
+        if (pending.CacheBinary) ProgramCache::save( program, pending.Key );
+    }
+    else {
+        for (size_t i = 0; i < pending.Shaders.size(); ++i) {
+            if (checkCompileError( pending.ShaderTypes[i], pending.Shaders[i] )) continue;
+
+            // The logs tell the files by the source string numbers of the #line directives.
+            std::cerr << "Could not compile shader\n";
+            for (size_t f = 0; f < pending.StageFiles[i].size(); ++f)
+                std::cerr << " " << f << ": " << pending.StageFiles[i][f] << "\n";
+        }
+        Statistics.FailedProgramNum++;
+    }
+
+    for (const auto& shader : pending.Shaders) {
+        glDetachShader( program, shader );
+        glDeleteShader( shader );
+    }
+    Statistics.LastReadyTime = std::chrono::steady_clock::now();
+}
+
+bool ShaderGL::pollPrograms()
+{
+    const bool parallel = isParallelCompileSupported();
+    std::erase_if(
+        PendingPrograms,
+        [parallel](const PendingProgram& pending)
+        {
+            if (parallel) {
+                GLint completed = GL_FALSE;
+                glGetProgramiv( pending.Shader->ShaderProgram, CompletionStatus, &completed );
+                if (completed == GL_FALSE) return false;
+            }
+            finishProgram( pending );
+            return true;
+        }
+    );
+    return PendingPrograms.empty();
+}
+
 void ShaderGL::setShader(
     const char* vertex_shader_path,
     const char* fragment_shader_path,
@@ -80,40 +274,38 @@ void ShaderGL::setShader(
     const char* tessellation_evaluation_shader_path
 )
 {
-    const GLuint vertex_shader = getCompiledShader( GL_VERTEX_SHADER, vertex_shader_path );
-    const GLuint fragment_shader = getCompiledShader( GL_FRAGMENT_SHADER, fragment_shader_path );
-    const GLuint geometry_shader = getCompiledShader( GL_GEOMETRY_SHADER, geometry_shader_path );
-    const GLuint tessellation_control_shader = getCompiledShader(
-        GL_TESS_CONTROL_SHADER, tessellation_control_shader_path
-    );
-    const GLuint tessellation_evaluation_shader = getCompiledShader(
-        GL_TESS_EVALUATION_SHADER, tessellation_evaluation_shader_path
-    );
-    ShaderProgram = glCreateProgram();
-    glAttachShader( ShaderProgram, vertex_shader );
-    glAttachShader( ShaderProgram, fragment_shader );
-    if (geometry_shader != 0)
-        glAttachShader( ShaderProgram, geometry_shader );
-    if (tessellation_control_shader != 0)
-        glAttachShader( ShaderProgram, tessellation_control_shader );
-    if (tessellation_evaluation_shader != 0)
-        glAttachShader( ShaderProgram, tessellation_evaluation_shader );
-    glLinkProgram( ShaderProgram );
-    glDeleteShader( vertex_shader );
-    glDeleteShader( fragment_shader );
-    if (geometry_shader != 0)
-        glDeleteShader( geometry_shader );
-    if (tessellation_control_shader != 0)
-        glDeleteShader( tessellation_control_shader );
-    if (tessellation_evaluation_shader != 0)
-        glDeleteShader( tessellation_evaluation_shader );
+    std::vector<ProgramCache::Stage> stages;
+    addStage( stages, GL_VERTEX_SHADER, vertex_shader_path );
+    addStage( stages, GL_FRAGMENT_SHADER, fragment_shader_path );
+    addStage( stages, GL_GEOMETRY_SHADER, geometry_shader_path );
+    addStage( stages, GL_TESS_CONTROL_SHADER, tessellation_control_shader_path );
+    addStage( stages, GL_TESS_EVALUATION_SHADER, tessellation_evaluation_shader_path );
+    linkProgram( stages );
 }
 
 void ShaderGL::setComputeShader(const char* compute_shader_path)
 {
-    const GLuint compute_shader = getCompiledShader( GL_COMPUTE_SHADER, compute_shader_path );
-    ShaderProgram = glCreateProgram();
-    glAttachShader( ShaderProgram, compute_shader );
-    glLinkProgram( ShaderProgram );
-    glDeleteShader( compute_shader );
+    std::vector<ProgramCache::Stage> stages;
+    addStage( stages, GL_COMPUTE_SHADER, compute_shader_path );
+    linkProgram( stages );
+}
+
+void ShaderGL::reportProgramSetup()
+{
+    // The driver threads keep working while this sleeps, so the polls only decide how exact the time is.
+    while (!pollPrograms()) std::this_thread::sleep_for( std::chrono::microseconds( 100 ) );
+
+    // The time spans from the first submission to the last program ready, with the setup in between.
+    // Without any program from the cache, this is a cold start, which the next launch can be compared against.
+    const std::chrono::duration<double, std::milli> elapsed = Statistics.LastReadyTime - Statistics.FirstSubmitTime;
+    std::ostringstream report;
+    report << ">> " << Statistics.ProgramNum << " programs set up in " << std::fixed << std::setprecision( 1 )
+        << (Statistics.ProgramNum > 0 ? elapsed.count() : 0.0) << " ms with " << Statistics.SubmitMilliseconds
+        << " ms to submit them, " << Statistics.CachedProgramNum << " from the binary cache ("
+        << (Statistics.CachedProgramNum == 0 ? "cold" : "warm") << " start), "
+        << (isParallelCompileSupported() ? "compiled in parallel by the driver" : "compiled one by one");
+    if (Statistics.FailedProgramNum > 0) report << ", " << Statistics.FailedProgramNum << " failed";
+    report << "\n";
+    std::cout << report.str();
+    Statistics = {};
 }
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include "texture_cache.h"
+#include "mapped_file.h"
+
+std::string TextureCache::getFileKey(const std::string& file_path, const std::string& variant)
+{
+    // Different spellings of the same file, such as "a/../b.png" and "b.png", have to meet at the same key.
+    std::error_code error;
+    const std::filesystem::path path = std::filesystem::weakly_canonical( file_path, error );
+    return "file:" + (error ? file_path : path.string()) + "|" + variant;
+}
+
+std::string TextureCache::getContentKey(const uint8_t* buffer, size_t size, const std::string& variant)
+{
+    // A hit hands out the cached texture without looking at the pixels, so the key carries two byte-wise FNV-1a
+    // hashes, the second seeded by the first, along with the size. Two images then have to collide in both to meet.
+    const uint64_t hash = MappedFile::getHash( buffer, size );
+    const uint64_t check = MappedFile::getHash( buffer, size, hash ^ 0x9E3779B97F4A7C15ull );
+
+    std::ostringstream key;
+    key << "content:" << std::hex << hash << "-" << check << std::dec << ":" << size << "|" << variant;
+    return key.str();
+}
+
+const TextureCache::Entry* TextureCache::acquire(const std::string& key)
+{
+    const auto it = Entries.find( key );
+    if (it == Entries.end()) {
+        ++MissNum;
+        return nullptr;
+    }
+
+    ++HitNum;
+    ++it->second.ReferenceNum;
+    SavedBytes += it->second.Bytes;
+    return &it->second;
+}
+
+void TextureCache::insert(const std::string& key, GLuint texture_id, const glm::ivec2& size, size_t bytes)
+{
+    Entry& entry = Entries[key];
+    entry.TextureID = texture_id;
+    entry.Size = size;
+    entry.Bytes = bytes;
+    entry.ReferenceNum = 1;
+    TextureIDToKey[texture_id] = key;
+    ResidentBytes += bytes;
+}
+
+bool TextureCache::release(GLuint texture_id)
+{
+    const auto key = TextureIDToKey.find( texture_id );
+    if (key == TextureIDToKey.end()) return false;
+
+    const auto entry = Entries.find( key->second );
+    if (--entry->second.ReferenceNum == 0) {
+        glDeleteTextures( 1, &texture_id );
+        ResidentBytes -= entry->second.Bytes;
+        Entries.erase( entry );
+        TextureIDToKey.erase( key );
+    }
+    return true;
+}
+
+void TextureCache::printStatistics() const
+{
+    constexpr double megabyte = 1024.0 * 1024.0;
+    const int request_num = HitNum + MissNum;
+    std::ostringstream report;
+    report << ">> Texture cache: " << HitNum << " hits of " << request_num << " requests ("
+        << std::fixed << std::setprecision( 1 )
+        << (request_num > 0 ? 100.0 * HitNum / request_num : 0.0) << "%), "
+        << Entries.size() << " textures in " << static_cast<double>(ResidentBytes) / megabyte << " MB, "
+        << static_cast<double>(SavedBytes) / megabyte << " MB of uploads saved\n";
+    std::cout << report.str();
+}
\ No newline at end of file
@@ -0,0 +1,35 @@
+#include "thread_pool.h"
+
+ThreadPool::ThreadPool(int thread_num)
+{
+    for (int i = 0; i < std::max( thread_num, 1 ); ++i) {
+        Workers.emplace_back( &ThreadPool::work, this );
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock( Mutex );
+        Stop = true;
+    }
+    Condition.notify_all();
+    for (auto& worker : Workers) worker.join();
+}
+
+void ThreadPool::work()
+{
+    IsWorker = true;
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock( Mutex );
+            Condition.wait( lock, [this]() { return Stop || !Tasks.empty(); } );
+            if (Stop && Tasks.empty()) return;
+
+            task = std::move( Tasks.front() );
+            Tasks.pop();
+        }
+        task();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include "vertex_quantizer.h"
+
+glm::vec2 VertexQuantizer::encodeOctahedral(const glm::vec3& normal)
+{
+    // The unit sphere is projected onto the octahedron, whose lower half is folded over the upper one.
+    const glm::vec3 n = normal / (std::abs( normal.x ) + std::abs( normal.y ) + std::abs( normal.z ));
+    if (n.z >= 0.0f) return { n.x, n.y };
+    return {
+        (1.0f - std::abs( n.y )) * (n.x >= 0.0f ? 1.0f : -1.0f),
+        (1.0f - std::abs( n.x )) * (n.y >= 0.0f ? 1.0f : -1.0f)
+    };
+}
+
+glm::vec3 VertexQuantizer::decodeOctahedral(const glm::vec2& encoded)
+{
+    glm::vec3 n( encoded.x, encoded.y, 1.0f - std::abs( encoded.x ) - std::abs( encoded.y ) );
+    const float t = std::max( -n.z, 0.0f );
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+    return normalize( n );
+}
+
+glm::mat4 VertexQuantizer::quantize(
+    std::vector<uint8_t>& quantized,
+    const GLfloat* vertex_buffer,
+    size_t vertex_num,
+    bool normals_exist,
+    bool textures_exist,
+    NORMAL_ENCODING encoding
+)
+{
+    const size_t stride = 3 + (normals_exist ? 3 : 0) + (textures_exist ? 2 : 0);
+    glm::vec3 min_point( std::numeric_limits<float>::max() ), max_point( std::numeric_limits<float>::lowest() );
+    for (size_t i = 0; i < vertex_num; ++i) {
+        const glm::vec3 position = glm::make_vec3( vertex_buffer + i * stride );
+        min_point = glm::min( min_point, position );
+        max_point = glm::max( max_point, position );
+    }
+    const glm::vec3 center = vertex_num > 0 ? (min_point + max_point) * 0.5f : glm::vec3( 0.0f );
+    const glm::vec3 half_size = vertex_num > 0 ? (max_point - min_point) * 0.5f : glm::vec3( 0.0f );
+    float extent = std::max( { half_size.x, half_size.y, half_size.z } );
+    if (extent <= 0.0f) extent = 1.0f;
+
+    const size_t bytes_per_vertex = getBytesPerVertex( normals_exist, textures_exist );
+    quantized.resize( vertex_num * bytes_per_vertex );
+    for (size_t i = 0; i < vertex_num; ++i) {
+        const GLfloat* vertex = vertex_buffer + i * stride;
+        uint8_t* ptr = quantized.data() + i * bytes_per_vertex;
+        const uint64_t position = glm::packSnorm4x16( glm::vec4( (glm::make_vec3( vertex ) - center) / extent, 0.0f ) );
+        std::memcpy( ptr, &position, PositionBytes );
+        ptr += PositionBytes;
+
+        if (normals_exist) {
+            const glm::vec3 normal = normalize( glm::make_vec3( vertex + 3 ) );
+            const uint32_t packed = encoding == Int2101010 ?
+                glm::packSnorm3x10_1x2( glm::vec4( normal, 0.0f ) ) :
+                glm::packSnorm2x16( encodeOctahedral( normal ) );
+            std::memcpy( ptr, &packed, NormalBytes );
+            ptr += NormalBytes;
+        }
+        if (textures_exist) {
+            const uint32_t packed = glm::packHalf2x16( glm::make_vec2( vertex + (normals_exist ? 6 : 3) ) );
+            std::memcpy( ptr, &packed, TextureBytes );
+        }
+    }
+    return translate( glm::mat4( 1.0f ), center ) * scale( glm::mat4( 1.0f ), glm::vec3( extent ) );
+}
+
+VertexQuantizer::Error VertexQuantizer::measureError(
+    const std::vector<uint8_t>& quantized,
+    const glm::mat4& dequantization,
+    const GLfloat* vertex_buffer,
+    size_t vertex_num,
+    bool normals_exist,
+    bool textures_exist,
+    NORMAL_ENCODING encoding
+)
+{
+    Error error{ 0.0f, 0.0f, 0.0f };
+    const size_t stride = 3 + (normals_exist ? 3 : 0) + (textures_exist ? 2 : 0);
+    const size_t bytes_per_vertex = getBytesPerVertex( normals_exist, textures_exist );
+    for (size_t i = 0; i < vertex_num; ++i) {
+        const GLfloat* vertex = vertex_buffer + i * stride;
+        const uint8_t* ptr = quantized.data() + i * bytes_per_vertex;
+        uint64_t position = 0;
+        std::memcpy( &position, ptr, PositionBytes );
+        const glm::vec4 normalized_position( glm::vec3( glm::unpackSnorm4x16( position ) ), 1.0f );
+        const glm::vec3 decoded_position( dequantization * normalized_position );
+        error.Position = std::max( error.Position, glm::length( decoded_position - glm::make_vec3( vertex ) ) );
+        ptr += PositionBytes;
+
+        if (normals_exist) {
+            uint32_t packed = 0;
+            std::memcpy( &packed, ptr, NormalBytes );
+            const glm::vec3 decoded_normal = encoding == Int2101010 ?
+                normalize( glm::vec3( glm::unpackSnorm3x10_1x2( packed ) ) ) :
+                decodeOctahedral( glm::unpackSnorm2x16( packed ) );
+            const float cosine =
+                glm::clamp( dot( decoded_normal, normalize( glm::make_vec3( vertex + 3 ) ) ), -1.0f, 1.0f );
+            error.Normal = std::max( error.Normal, glm::degrees( std::acos( cosine ) ) );
+            ptr += NormalBytes;
+        }
+        if (textures_exist) {
+            uint32_t packed = 0;
+            std::memcpy( &packed, ptr, TextureBytes );
+            const glm::vec2 texture = glm::make_vec2( vertex + (normals_exist ? 6 : 3) );
+            const glm::vec2 difference = glm::abs( glm::unpackHalf2x16( packed ) - texture );
+            error.Texture = std::max( { error.Texture, difference.x, difference.y } );
+        }
+    }
+    return error;
+}
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include "object_reader.h"
+#include "thread_pool.h"
+
+// The chunked parse has to give exactly what the single-threaded parse gives, which this checks on panda.obj and on
+// copies of it replicated past the chunk boundaries, the odd copies rewritten with relative indices.
+namespace
+{
+    constexpr int CopyNum = 8;
+
+    template<typename T>
+    [[nodiscard]] bool isBitwiseEqual(const std::vector<T>& a, const std::vector<T>& b)
+    {
+        return a.size() == b.size() && (a.empty() || std::memcmp( a.data(), b.data(), a.size() * sizeof( T ) ) == 0);
+    }
+
+    [[nodiscard]] bool isBitwiseEqual(const ObjectReader::ObjectData& a, const ObjectReader::ObjectData& b)
+    {
+        return isBitwiseEqual( a.Vertices, b.Vertices ) && isBitwiseEqual( a.Normals, b.Normals ) &&
+            isBitwiseEqual( a.Textures, b.Textures ) && isBitwiseEqual( a.Corners, b.Corners );
+    }
+
+    // Rewrites a face corner such as "12/3/-1" of one copy, whose absolute indices are shifted past the elements of
+    // the copies before it, or turned into the relative ones counted back from the elements declared so far.
+    [[nodiscard]] std::string rewriteCorner(
+        const std::string& corner,
+        const std::array<int, 3>& counts,
+        const std::array<int, 3>& offsets,
+        bool relative
+    )
+    {
+        std::string rewritten;
+        size_t begin = 0;
+        for (int i = 0; i < 3 && begin <= corner.size(); ++i) {
+            const size_t end = std::min( corner.find( '/', begin ), corner.size() );
+            const std::string token = corner.substr( begin, end - begin );
+            if (i > 0) rewritten += '/';
+            if (!token.empty()) {
+                const int index = std::stoi( token );
+                const int absolute = index > 0 ? index + offsets[i] : counts[i] + index + 1;
+                rewritten += std::to_string( relative ? absolute - counts[i] - 1 : absolute );
+            }
+            if (end == corner.size()) break;
+            begin = end + 1;
+        }
+        return rewritten;
+    }
+
+    [[nodiscard]] std::string replicate(const std::string& source, int copy_num)
+    {
+        std::ostringstream text;
+        std::array<int, 3> counts{};
+        for (int copy = 0; copy < copy_num; ++copy) {
+            const std::array<int, 3> offsets = counts;
+            std::istringstream lines( source );
+            std::string line;
+            while (std::getline( lines, line )) {
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+
+                if (line.starts_with( "v " )) ++counts[0];
+                else if (line.starts_with( "vt " )) ++counts[1];
+                else if (line.starts_with( "vn " )) ++counts[2];
+                else if (line.starts_with( "f " )) {
+                    std::istringstream corners( line.substr( 2 ) );
+                    std::string corner;
+                    text << "f";
+                    while (corners >> corner) text << " " << rewriteCorner( corner, counts, offsets, copy % 2 == 1 );
+                    text << "\n";
+                    continue;
+                }
+                text << line << "\n";
+            }
+        }
+        return text.str();
+    }
+
+    [[nodiscard]] bool checkFile(const std::string& file_path, int thread_num)
+    {
+        ObjectReader::ObjectData single, chunked;
+        if (!ObjectReader::readObjectFile( single, file_path, 1 ) ||
+            !ObjectReader::readObjectFile( chunked, file_path, thread_num )) {
+            std::cerr << ">> " << file_path << ": could not be parsed\n";
+            return false;
+        }
+        if (!isBitwiseEqual( single, chunked )) {
+            std::cerr << ">> " << file_path << ": " << thread_num << " threads differ from a single thread\n";
+            return false;
+        }
+        std::cout << ">> " << file_path << ": " << single.Corners.size() / 3 << " triangles match on "
+            << thread_num << " threads\n";
+        return true;
+    }
+}
+
+int main()
+{
+    const std::string source_path = std::string( CMAKE_SOURCE_DIR ) + "/10_shadow_mapping/samples/panda.obj";
+    std::ifstream file( source_path, std::ios::in | std::ios::binary );
+    if (!file.is_open()) {
+        std::cerr << ">> Could not open " << source_path << "\n";
+        return 1;
+    }
+    const std::string source( (std::istreambuf_iterator<char>( file )), std::istreambuf_iterator<char>() );
+
+    const std::string replicated_path =
+        (std::filesystem::temp_directory_path() / "glcollection_replicated_panda.obj").string();
+    {
+        std::ofstream replicated( replicated_path, std::ios::out | std::ios::binary | std::ios::trunc );
+        replicated << replicate( source, CopyNum );
+        if (!replicated.good()) {
+            std::cerr << ">> Could not write " << replicated_path << "\n";
+            return 1;
+        }
+    }
+
+    // The copies declare the same elements, so every copy has to parse into the first one shifted by its offsets.
+    ObjectReader::ObjectData original, replicated;
+    bool passed = ObjectReader::readObjectFile( original, source_path ) &&
+        ObjectReader::readObjectFile( replicated, replicated_path ) &&
+        replicated.Corners.size() == original.Corners.size() * CopyNum;
+    for (size_t i = 0; passed && i < replicated.Corners.size(); ++i) {
+        const auto copy = static_cast<int>(i / original.Corners.size());
+        const glm::ivec3& corner = original.Corners[i % original.Corners.size()];
+        const glm::ivec3 offsets(
+            static_cast<int>(original.Vertices.size()) * copy,
+            static_cast<int>(original.Textures.size()) * copy,
+            static_cast<int>(original.Normals.size()) * copy
+        );
+        for (int c = 0; c < 3; ++c) {
+            const int expected = corner[c] < 0 ? corner[c] : corner[c] + offsets[c];
+            passed = passed && replicated.Corners[i][c] == expected;
+        }
+    }
+    if (!passed) std::cerr << ">> The relative indices of the replicated copies do not match the absolute ones\n";
+
+    const int thread_num = std::max( ThreadPool::getHardwareThreadNum(), 4 );
+    passed = checkFile( source_path, thread_num ) && passed;
+    passed = checkFile( replicated_path, thread_num ) && passed;
+
+    std::error_code error;
+    std::filesystem::remove( replicated_path, error );
+    return passed ? 0 : 1;
+}
\ No newline at end of file
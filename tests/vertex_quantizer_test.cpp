@@ -0,0 +1,94 @@
+#include "vertex_quantizer.h"
+#include "object_reader.h"
+
+// Quantizes the sample meshes in both normal encodings and fails if a decoded vertex is off by more than the
+// tolerances below, which leave some headroom over the rounding of the packed formats.
+namespace
+{
+    struct Tolerance
+    {
+        float Position; // relative to the half extent of the mesh, which the positions are normalized by
+        float Normal; // in degrees
+        float Texture; // relative to the largest magnitude of the coordinates
+    };
+
+    // A 16-bit normalized position rounds by half a step on each axis, which is sqrt(3) / 65534 of the half extent.
+    // A 10-bit normal is off by 0.1 degrees at most. A 16-bit octahedral one is finer than the 0.03 degrees that acos
+    // can tell apart in floats. A half float keeps 11 bits of a coordinate.
+    constexpr float PositionTolerance = 4e-5f;
+    constexpr Tolerance Int2101010Tolerance{ PositionTolerance, 0.2f, 1.0f / 1024.0f };
+    constexpr Tolerance OctahedralTolerance{ PositionTolerance, 0.05f, 1.0f / 1024.0f };
+
+    [[nodiscard]] bool checkMesh(const std::string& file_path)
+    {
+        std::vector<glm::vec3> vertices, normals;
+        std::vector<glm::vec2> textures;
+        std::vector<GLuint> indices;
+        if (!ObjectReader::readMeshFile( vertices, normals, textures, indices, file_path )) {
+            std::cerr << ">> " << file_path << ": could not be read\n";
+            return false;
+        }
+
+        const bool normals_exist = !normals.empty();
+        const bool textures_exist = !textures.empty();
+        std::vector<GLfloat> vertex_buffer;
+        glm::vec3 min_point( std::numeric_limits<float>::max() ), max_point( std::numeric_limits<float>::lowest() );
+        float max_texture = 0.0f;
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            vertex_buffer.insert( vertex_buffer.end(), { vertices[i].x, vertices[i].y, vertices[i].z } );
+            if (normals_exist) {
+                vertex_buffer.insert( vertex_buffer.end(), { normals[i].x, normals[i].y, normals[i].z } );
+            }
+            if (textures_exist) {
+                vertex_buffer.insert( vertex_buffer.end(), { textures[i].x, textures[i].y } );
+                max_texture = std::max( { max_texture, std::abs( textures[i].x ), std::abs( textures[i].y ) } );
+            }
+            min_point = glm::min( min_point, vertices[i] );
+            max_point = glm::max( max_point, vertices[i] );
+        }
+        const glm::vec3 half_size = (max_point - min_point) * 0.5f;
+        const float extent = std::max( { half_size.x, half_size.y, half_size.z, std::numeric_limits<float>::min() } );
+
+        bool passed = true;
+        const std::string file_name = std::filesystem::path( file_path ).filename().string();
+        for (const auto encoding : { VertexQuantizer::Int2101010, VertexQuantizer::Octahedral }) {
+            const Tolerance& tolerance =
+                encoding == VertexQuantizer::Int2101010 ? Int2101010Tolerance : OctahedralTolerance;
+            std::vector<uint8_t> quantized;
+            const glm::mat4 dequantization = VertexQuantizer::quantize(
+                quantized, vertex_buffer.data(), vertices.size(), normals_exist, textures_exist, encoding
+            );
+            const VertexQuantizer::Error error = VertexQuantizer::measureError(
+                quantized, dequantization, vertex_buffer.data(), vertices.size(), normals_exist, textures_exist,
+                encoding
+            );
+
+            const bool within =
+                error.Position <= tolerance.Position * extent &&
+                error.Normal <= tolerance.Normal &&
+                error.Texture <= tolerance.Texture * std::max( max_texture, 1.0f );
+            std::ostringstream report;
+            report << ">> " << file_name << (encoding == VertexQuantizer::Int2101010 ? " 2_10_10_10" : " octahedral")
+                << ": max errors of position " << error.Position / extent << " of the half extent, normal "
+                << error.Normal << " degrees, texture " << error.Texture << (within ? "\n" : " over the tolerance\n");
+            (within ? std::cout : std::cerr) << report.str();
+            passed = passed && within;
+        }
+        return passed;
+    }
+}
+
+int main()
+{
+    const std::string root = std::string( CMAKE_SOURCE_DIR );
+    const std::array<std::string, 4> file_paths = {
+        root + "/10_shadow_mapping/samples/panda.obj",
+        root + "/10_shadow_mapping/samples/tiger.txt",
+        root + "/13_environment_mapping/samples/objects/cow.txt",
+        root + "/03_gimbal_lock/teapot.obj"
+    };
+
+    bool passed = true;
+    for (const auto& file_path : file_paths) passed = checkMesh( file_path ) && passed;
+    return passed ? 0 : 1;
+}
\ No newline at end of file